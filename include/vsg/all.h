@@ -24,6 +24,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/Export.h>
 #include <vsg/core/External.h>
 #include <vsg/core/Inherit.h>
+#include <vsg/core/Mask.h>
 #include <vsg/core/Object.h>
 #include <vsg/core/Objects.h>
 #include <vsg/core/ScratchMemory.h>
@@ -77,6 +78,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/commands/PushConstants.h>
 
 // State header files
+#include <vsg/state/BindlessTextures.h>
 #include <vsg/state/Buffer.h>
 #include <vsg/state/BufferInfo.h>
 #include <vsg/state/BufferView.h>
@@ -108,7 +110,13 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/traversals/Intersector.h>
 #include <vsg/traversals/LineSegmentIntersector.h>
 #include <vsg/traversals/LoadPagedLOD.h>
+#include <vsg/traversals/MultiLineSegmentIntersector.h>
+#include <vsg/traversals/ParallelTraversal.h>
+#include <vsg/traversals/PolytopeIntersector.h>
+#include <vsg/traversals/RecordStatistics.h>
 #include <vsg/traversals/RecordTraversal.h>
+#include <vsg/traversals/TraversalStack.h>
+#include <vsg/traversals/TriangleBVH.h>
 
 // Threading header files
 #include <vsg/threading/ActivityStatus.h>
@@ -153,17 +161,22 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/vk/CommandPool.h>
 #include <vsg/vk/Context.h>
 #include <vsg/vk/DescriptorPool.h>
+#include <vsg/vk/DescriptorPools.h>
 #include <vsg/vk/Device.h>
 #include <vsg/vk/DeviceMemory.h>
+#include <vsg/vk/DynamicUniformRing.h>
 #include <vsg/vk/Extensions.h>
 #include <vsg/vk/Fence.h>
 #include <vsg/vk/Framebuffer.h>
+#include <vsg/vk/GeometryHeap.h>
 #include <vsg/vk/Instance.h>
 #include <vsg/vk/MemoryBufferPools.h>
 #include <vsg/vk/PhysicalDevice.h>
+#include <vsg/vk/PipelineCache.h>
 #include <vsg/vk/Queue.h>
 #include <vsg/vk/RenderPass.h>
 #include <vsg/vk/Semaphore.h>
+#include <vsg/vk/StagingRing.h>
 #include <vsg/vk/State.h>
 #include <vsg/vk/SubmitCommands.h>
 #include <vsg/vk/Surface.h>
@@ -184,6 +197,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Output.h>
 #include <vsg/io/ReaderWriter.h>
 #include <vsg/io/ReaderWriter_vsg.h>
+#include <vsg/io/SharedObjects.h>
 #include <vsg/io/read.h>
 #include <vsg/io/stream.h>
 #include <vsg/io/write.h>
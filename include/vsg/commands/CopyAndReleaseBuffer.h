@@ -30,20 +30,33 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 namespace vsg
 {
 
+    /// CopyAndReleaseBuffer copies data from staging buffers to destination buffers, releasing each staging range when the command is deleted.
+    /// Copies between the same pair of source and destination buffers are recorded as a single vkCmdCopyBuffer with a region per copy, merging contiguous regions.
     class VSG_DECLSPEC CopyAndReleaseBuffer : public Inherit<Command, CopyAndReleaseBuffer>
     {
     public:
-        CopyAndReleaseBuffer(BufferInfo src, BufferInfo dest) :
-            source(src),
-            destination(dest) {}
+        CopyAndReleaseBuffer() {}
+        CopyAndReleaseBuffer(BufferInfo src, BufferInfo dest);
 
-        BufferInfo source;
-        BufferInfo destination;
+        /// add a copy, releaseSource false for sources that are released by their owner such as the regions of a StagingRing.
+        void add(BufferInfo src, BufferInfo dest, bool releaseSource = true);
+
+        /// number of copies added
+        size_t size() const { return copies.size(); }
 
         void record(CommandBuffer& commandBuffer) const override;
 
     protected:
         virtual ~CopyAndReleaseBuffer();
+
+        struct CopyData
+        {
+            BufferInfo source;
+            BufferInfo destination;
+            bool releaseSource = true;
+        };
+
+        std::vector<CopyData> copies;
     };
 
 } // namespace vsg
@@ -31,6 +31,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 namespace vsg
 {
 
+    /// CopyAndReleaseImage copies data from staging buffers to images, releasing each staging range once the copies have been recorded again or the command is deleted.
+    /// All the pending copies are recorded as a batch, with the layout transitions of all the images consolidated into single vkCmdPipelineBarrier calls,
+    /// each image's mip levels copied with a single vkCmdCopyBufferToImage, and mipmaps generated a level at a time across all the images that require them.
     class VSG_DECLSPEC CopyAndReleaseImage : public Inherit<Command, CopyAndReleaseImage>
     {
     public:
@@ -39,7 +42,11 @@ namespace vsg
         CopyAndReleaseImage(BufferInfo src, ImageInfo dest, uint32_t numMipMapLevels);
 
         void add(BufferInfo src, ImageInfo dest);
-        void add(BufferInfo src, ImageInfo dest, uint32_t numMipMapLevels);
+        /// add a copy, releaseSource false for sources that are released by their owner such as the regions of a StagingRing.
+        void add(BufferInfo src, ImageInfo dest, uint32_t numMipMapLevels, bool releaseSource = true);
+
+        /// number of copies pending
+        size_t size() const { return pending.size(); }
 
         void record(CommandBuffer& commandBuffer) const override;
 
@@ -51,8 +58,7 @@ namespace vsg
             BufferInfo source;
             ImageInfo destination;
             uint32_t mipLevels = 1;
-
-            void record(CommandBuffer& commandBuffer) const;
+            bool releaseSource = true;
         };
 
         mutable std::vector<CopyData> pending;
@@ -15,6 +15,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/Array.h>
 #include <vsg/core/Array2D.h>
 #include <vsg/core/Array3D.h>
+#include <vsg/core/Mask.h>
 #include <vsg/core/Value.h>
 
 namespace vsg
@@ -100,6 +101,9 @@ namespace vsg
     public:
         ConstVisitor();
 
+        /// only traverse nodes where (node.mask & traversalMask) != 0
+        Mask traversalMask = MASK_ALL;
+
         virtual void apply(const Object&);
         virtual void apply(const Objects&);
         virtual void apply(const External&);
@@ -152,10 +152,50 @@ namespace vsg
         MipmapOffsets computeMipmapOffsets() const;
         static std::size_t computeValueCountIncludingMipmaps(std::size_t w, std::size_t h, std::size_t d, uint32_t maxNumMipmaps);
 
+        /// increment the ModifiedCount to signify that the data has been modified and any cached results derived from it need updating
+        void dirty()
+        {
+            ++_modifiedCount;
+            _wholeModifiedCount = _modifiedCount;
+            _dirtyRanges.clear();
+        }
+
+        /// byte range of the data, relative to dataPointer(), that was modified at a specified ModifiedCount
+        struct DirtyRange
+        {
+            uint32_t modifiedCount = 0;
+            std::size_t offset = 0;
+            std::size_t size = 0;
+        };
+        using DirtyRanges = std::vector<DirtyRange>;
+
+        /// maximum number of dirty ranges retained, when exceeded the oldest ranges are discarded and copies taken before them fall back to copying the whole data
+        static constexpr std::size_t maxNumDirtyRanges = 64;
+
+        /// increment the ModifiedCount to signify that the specified byte range of the data has been modified, allowing uploads to copy just the modified bytes.
+        /// Not thread safe, like dirty() it should only be called during the update phase of the frame, not while the Data is being copied by the record traversal.
+        void dirty(std::size_t offset, std::size_t size);
+
+        /// increment the ModifiedCount to signify that count values starting from the value at index have been modified
+        void dirtyValues(std::size_t index, std::size_t count) { dirty(index * stride(), count * stride()); }
+
+        /// get the number of times dirty() has been called
+        uint32_t getModifiedCount() const { return _modifiedCount; }
+
+        /// return true if the Data has been modified since the specified ModifiedCount was taken
+        bool differentModifiedCount(uint32_t modifiedCount) const { return _modifiedCount != modifiedCount; }
+
+        /// get the merged, offset sorted, byte ranges modified since the specified ModifiedCount was taken.
+        /// return false if the modifications since then aren't all covered by dirty ranges so the whole data has to be treated as modified.
+        bool getDirtyRanges(uint32_t modifiedCount, DirtyRanges& ranges) const;
+
     protected:
         virtual ~Data() {}
 
         Layout _layout;
+        uint32_t _modifiedCount = 0;
+        uint32_t _wholeModifiedCount = 0;
+        DirtyRanges _dirtyRanges;
     };
     VSG_type_name(vsg::Data);
 
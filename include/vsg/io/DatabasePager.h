@@ -25,6 +25,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <condition_variable>
 #include <list>
+#include <map>
 #include <thread>
 
 namespace vsg
@@ -105,6 +106,10 @@ namespace vsg
         using Semaphores = std::set<ref_ptr<Semaphore>>;
         Semaphores& getSemaphores() { return _semaphores; }
 
+        /// timeline semaphores, and the values to wait on, that the next frame's submission must wait on before using the merged subgraphs
+        using TimelineSemaphores = std::map<ref_ptr<Semaphore>, uint64_t>;
+        TimelineSemaphores& getTimelineSemaphores() { return _timelineSemaphores; }
+
         ref_ptr<const Options> options;
 
         ref_ptr<CompileTraversal> compileTraversal;
@@ -114,8 +119,26 @@ namespace vsg
 
         ref_ptr<CulledPagedLODs> culledPagedLODs;
 
+        /// maximum number of CompileTraversal, each with its own submission in flight, used by the compile thread. When all are in use tiles are left in the compile queue until one completes.
+        uint32_t maxNumCompileTraversals = 16;
+
         uint32_t targetMaxNumPagedLODWithHighResSubgraphs = 10000;
 
+        /// maximum device memory used by the high res subgraphs of PagedLOD, when 0 the limit is computed from the Device's device local memory budget every deviceMemoryBudgetQueryInterval frames.
+        VkDeviceSize deviceMemoryBudget = 0;
+
+        /// proportion of the Device's device local memory budget that may be used when deviceMemoryBudget is 0, a value of 0.0 disables device memory based expiry.
+        double deviceMemoryBudgetRatio = 0.8;
+
+        /// number of frames between queries of the Device's device local memory budget.
+        uint32_t deviceMemoryBudgetQueryInterval = 30;
+
+        /// device memory used by the high res subgraphs merged into the scene graph, updated by updateSceneGraph(..)
+        VkDeviceSize pagedDeviceMemory = 0;
+
+        /// return the device memory that the merged high res subgraphs should be kept within.
+        VkDeviceSize computeTargetPagedDeviceMemory() const;
+
         std::mutex pendingPagedLODMutex;
 
         ref_ptr<PagedLODContainer> pagedLODContainer;
@@ -131,10 +154,14 @@ namespace vsg
         ref_ptr<DatabaseQueue> _compileQueue;
         ref_ptr<DatabaseQueue> _toMergeQueue;
 
+        VkDeviceSize _targetPagedDeviceMemory = 0;
+        uint64_t _nextDeviceMemoryBudgetQueryFrame = 0;
+
         std::list<std::thread> _readThreads;
         std::list<std::thread> _compileThreads;
 
         Semaphores _semaphores;
+        TimelineSemaphores _timelineSemaphores;
     };
     VSG_type_name(vsg::DatabasePager);
 
@@ -23,6 +23,7 @@ namespace vsg
     class ObjectCache;
     class ReaderWriter;
     class OperationThreads;
+    class SharedObjects;
     class CommandLine;
 
     class VSG_DECLSPEC Options : public Inherit<Object, Options>
@@ -43,6 +44,12 @@ namespace vsg
         ref_ptr<OperationThreads> operationThreads;
         Paths paths;
 
+        /// when assigned vsg::read(..) replaces duplicate state objects in loaded subgraphs with instances shared across all reads
+        ref_ptr<SharedObjects> sharedObjects;
+
+        /// file used to load and save the VkPipelineCache between runs, with each Device's details inserted before the extension, see Viewer::compile(..) and PipelineCache::deviceFilename(..)
+        Path pipelineCacheFilename;
+
     protected:
         virtual ~Options();
     };
@@ -0,0 +1,77 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Inherit.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace vsg
+{
+
+    /// SharedObjects is a registry of state objects keyed by their serialized contents, used to replace duplicate GraphicsPipeline, ComputePipeline, ShaderStage, ShaderModule,
+    /// PipelineLayout, DescriptorSetLayout and Sampler instances, such as those loaded with each paged tile, by a single shared instance so only one Vulkan object is compiled for them.
+    /// Assign to Options::sharedObjects to have vsg::read(..) share the state of all loaded subgraphs.
+    class VSG_DECLSPEC SharedObjects : public Inherit<Object, SharedObjects>
+    {
+    public:
+        SharedObjects();
+
+        /// return the shared instance with the same contents as object, object itself becomes the shared instance if no match exists
+        ref_ptr<Object> shareObject(ref_ptr<Object> object);
+
+        /// replace object with the shared instance with the same contents
+        template<class T>
+        void share(ref_ptr<T>& object)
+        {
+            if (object) object = ref_ptr<T>(static_cast<T*>(shareObject(object).get()));
+        }
+
+        /// return true if object is a shared instance held by this registry
+        bool contains(const Object* object) const;
+
+        /// replace the state objects referenced by the StateCommands within subgraph with shared instances
+        void shareState(Object& subgraph);
+
+        struct Statistics
+        {
+            uint64_t hits = 0;   // duplicate objects replaced by a shared instance
+            uint64_t misses = 0; // objects that became shared instances
+        };
+
+        Statistics getStatistics() const;
+
+        /// number of shared instances
+        size_t size() const;
+
+        /// remove shared instances that are no longer referenced outside the registry, such as those of expired paged tiles
+        void removeUnreferencedObjects();
+
+        /// remove all shared instances and reset statistics
+        void clear();
+
+    protected:
+        virtual ~SharedObjects();
+
+        std::string _key(const Object* object) const;
+
+        mutable std::mutex _mutex;
+        std::unordered_map<std::string, ref_ptr<Object>> _objects;
+        std::unordered_set<const Object*> _sharedObjects;
+        Statistics _statistics;
+    };
+    VSG_type_name(vsg::SharedObjects);
+
+} // namespace vsg
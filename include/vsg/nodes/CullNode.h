@@ -27,9 +27,18 @@ namespace vsg
 
         CullNode(const dsphere& bound, Node* child, Allocator* allocator = nullptr);
 
-        void traverse(Visitor& visitor) override { _child->accept(visitor); }
-        void traverse(ConstVisitor& visitor) const override { _child->accept(visitor); }
-        void traverse(RecordTraversal& visitor) const override { _child->accept(visitor); }
+        void traverse(Visitor& visitor) override
+        {
+            if (_child->validMask(visitor.traversalMask)) _child->accept(visitor);
+        }
+        void traverse(ConstVisitor& visitor) const override
+        {
+            if (_child->validMask(visitor.traversalMask)) _child->accept(visitor);
+        }
+        void traverse(RecordTraversal& visitor) const override
+        {
+            if (_child->validMask(visitor.traversalMask)) _child->accept(visitor);
+        }
 
         void read(Input& input) override;
         void write(Output& output) const override;
@@ -41,6 +50,9 @@ namespace vsg
         Node* getChild() { return _child; }
         const Node* getChild() const { return _child; }
 
+        /// the ref_ptr<> holding the child, used by visitors that push the child onto a TraversalStack
+        const ref_ptr<Node>& getChildRef() const { return _child; }
+
     protected:
         virtual ~CullNode();
 
@@ -36,7 +36,10 @@ namespace vsg
         template<class N, class V>
         static void t_traverse(N& node, V& visitor)
         {
-            for (auto& child : node._children) child->accept(visitor);
+            for (auto& child : node._children)
+            {
+                if (child->validMask(visitor.traversalMask)) child->accept(visitor);
+            }
         }
 
         void traverse(Visitor& visitor) override { t_traverse(*this, visitor); }
@@ -45,7 +45,10 @@ namespace vsg
         template<class N, class V>
         static void t_traverse(N& node, V& visitor)
         {
-            for (auto& child : node._children) child.node->accept(visitor);
+            for (auto& child : node._children)
+            {
+                if (child.node->validMask(visitor.traversalMask)) child.node->accept(visitor);
+            }
         }
 
         void traverse(Visitor& visitor) override { t_traverse(*this, visitor); }
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/core/Inherit.h>
+#include <vsg/core/Mask.h>
 
 namespace vsg
 {
@@ -21,6 +22,15 @@ namespace vsg
     public:
         Node(Allocator* allocator = nullptr);
 
+        /// the node and its subgraph are only traversed by visitors when (mask & visitor.traversalMask) != 0
+        Mask mask = MASK_ALL;
+
+        /// return true if the node should be traversed by a visitor with the specified traversalMask
+        bool validMask(Mask traversalMask) const { return (mask & traversalMask) != 0; }
+
+        void read(Input& input) override;
+        void write(Output& output) const override;
+
     protected:
         virtual ~Node();
     };
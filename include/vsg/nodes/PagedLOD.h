@@ -61,7 +61,7 @@ namespace vsg
         {
             for (auto& child : node._children)
             {
-                if (child.node) child.node->accept(visitor);
+                if (child.node && child.node->validMask(visitor.traversalMask)) child.node->accept(visitor);
             }
         }
 
@@ -116,6 +116,10 @@ namespace vsg
 
         ref_ptr<Node> pending;
         ref_ptr<Semaphore> semaphore;
+        uint64_t semaphoreValue = 0; // non zero when semaphore is a timeline semaphore, the value to wait on
+
+        // device memory reserved when compiling the pending subgraph, used by the DatabasePager to keep paged subgraphs within the device memory budget
+        VkDeviceSize deviceMemorySize = 0;
     };
     VSG_type_name(vsg::PagedLOD);
 
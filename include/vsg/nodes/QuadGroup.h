@@ -33,7 +33,10 @@ namespace vsg
         template<class N, class V>
         static void t_traverse(N& node, V& visitor)
         {
-            for (int i = 0; i < 4; ++i) node._children[i]->accept(visitor);
+            for (int i = 0; i < 4; ++i)
+            {
+                if (node._children[i]->validMask(visitor.traversalMask)) node._children[i]->accept(visitor);
+            }
         }
 
         void traverse(Visitor& visitor) override { t_traverse(*this, visitor); }
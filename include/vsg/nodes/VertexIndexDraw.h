@@ -16,6 +16,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/nodes/Node.h>
 #include <vsg/state/BufferInfo.h>
 #include <vsg/traversals/CompileTraversal.h>
+#include <vsg/vk/GeometryHeap.h>
 
 namespace vsg
 {
@@ -53,6 +54,8 @@ namespace vsg
             std::vector<VkDeviceSize> offsets;
             BufferInfo bufferInfo;
             VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+            ref_ptr<GeometryHeap> geometryHeap;
+            GeometryHeap::Allocation heapAllocation;
         };
 
         vk_buffer<VulkanData> _vulkanData;
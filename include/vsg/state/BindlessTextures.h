@@ -0,0 +1,137 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/state/DescriptorSetLayout.h>
+#include <vsg/state/PipelineLayout.h>
+#include <vsg/state/StateCommand.h>
+#include <vsg/vk/DescriptorPool.h>
+
+#include <deque>
+#include <mutex>
+
+namespace vsg
+{
+
+    /// BindlessTextures manages a large global array of combined image samplers, using VK_EXT_descriptor_indexing, that textures are added to and referenced by index from shaders,
+    /// so that materials don't each require a DescriptorSet and only one BindBindlessTextures is required per frame.
+    /// The Device must be created with the VK_EXT_descriptor_indexing extension enabled.
+    class VSG_DECLSPEC BindlessTextures : public Inherit<Object, BindlessTextures>
+    {
+    public:
+        explicit BindlessTextures(uint32_t in_maxTextures = 4096, uint32_t binding = 0, VkShaderStageFlags stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT);
+
+        const uint32_t maxTextures;
+
+        /// layout of the texture array descriptor set, to be used in the PipelineLayout of pipelines accessing the textures
+        ref_ptr<DescriptorSetLayout> descriptorSetLayout;
+
+        /// number of BindBindlessTextures::record(..) calls before a removed index is reused, must be at least the number of frames in flight multiplied by the number of CommandGraphs that record it.
+        uint32_t releaseDelay = 8;
+
+        /// assign imageInfo to a free index of the texture array and return that index, throws an Exception if all the indices are in use.
+        uint32_t add(const ImageInfo& imageInfo);
+
+        /// release an index returned by add(..), the index is reused once releaseDelay frames have been recorded.
+        void remove(uint32_t index);
+
+        /// number of indices in use or waiting to be reused
+        uint32_t numTextures() const;
+
+        /// create the DescriptorPool and VkDescriptorSet for the context's Device
+        void compile(Context& context);
+
+        /// write the textures added since the previous update to the VkDescriptorSet, called by BindBindlessTextures::record(..)
+        void update(uint32_t deviceID);
+
+        VkDescriptorSet vk(uint32_t deviceID) const { return _implementation[deviceID]->_descriptorSet; }
+
+    protected:
+        virtual ~BindlessTextures();
+
+        struct Implementation : public Inherit<Object, Implementation>
+        {
+            Implementation(Context& context, DescriptorSetLayout* descriptorSetLayout, uint32_t maxTextures);
+
+            virtual ~Implementation();
+
+            ref_ptr<Device> _device;
+            ref_ptr<DescriptorPool> _descriptorPool;
+            VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
+            std::vector<uint32_t> _pendingWrites;
+        };
+
+        vk_buffer<ref_ptr<Implementation>> _implementation;
+
+        mutable std::mutex _mutex;
+        std::vector<ImageInfo> _imageInfos;
+        std::vector<uint32_t> _availableIndices;
+        std::deque<std::pair<uint64_t, uint32_t>> _releasedIndices;
+        uint64_t _updateCount = 0;
+    };
+    VSG_type_name(vsg::BindlessTextures);
+
+    /// BindBindlessTextures binds the BindlessTextures descriptor set, placing it at the top of the scene graph records a single descriptor set bind per frame.
+    class VSG_DECLSPEC BindBindlessTextures : public Inherit<StateCommand, BindBindlessTextures>
+    {
+    public:
+        BindBindlessTextures(ref_ptr<BindlessTextures> in_textures, ref_ptr<PipelineLayout> in_layout, uint32_t in_firstSet = 0, VkPipelineBindPoint in_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        ref_ptr<BindlessTextures> textures;
+        ref_ptr<PipelineLayout> layout;
+        uint32_t firstSet;
+        VkPipelineBindPoint pipelineBindPoint;
+
+        void compile(Context& context) override;
+        void record(CommandBuffer& commandBuffer) const override;
+
+    protected:
+        virtual ~BindBindlessTextures();
+    };
+    VSG_type_name(vsg::BindBindlessTextures);
+
+    /// BindlessTexture adds a texture to a BindlessTextures array when compiled, and records its index as a push constant so shaders can look up the texture.
+    /// The index is released back to the BindlessTextures when the BindlessTexture is deleted, such as when the pager expires a tile.
+    class VSG_DECLSPEC BindlessTexture : public Inherit<StateCommand, BindlessTexture>
+    {
+    public:
+        /// default state slot, kept clear of the pipeline slot 0, the descriptor set slots 1 + firstSet and the PushConstants slot 2 so that pushing the index doesn't displace them.
+        static constexpr uint32_t DEFAULT_SLOT = 16;
+
+        BindlessTexture(ref_ptr<BindlessTextures> in_textures, const ImageInfo& in_imageInfo, VkShaderStageFlags in_stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT, uint32_t in_offset = 128, uint32_t in_slot = DEFAULT_SLOT);
+
+        ref_ptr<BindlessTextures> textures;
+        ImageInfo imageInfo;
+
+        /// vkCmdPushConstants settings for the texture index, the default offset places the index after the projection and modelview matrices.
+        VkShaderStageFlags stageFlags;
+        uint32_t offset;
+
+        static constexpr uint32_t INVALID_INDEX = ~0u;
+
+        /// index of the texture in the BindlessTextures array, INVALID_INDEX until compiled
+        uint32_t index() const { return _index; }
+
+        void compile(Context& context) override;
+        void record(CommandBuffer& commandBuffer) const override;
+
+    protected:
+        virtual ~BindlessTexture();
+
+        ref_ptr<DescriptorImage> _descriptorImage;
+        uint32_t _index = INVALID_INDEX;
+    };
+    VSG_type_name(vsg::BindlessTexture);
+
+} // namespace vsg
@@ -32,6 +32,9 @@ namespace vsg
         VkBufferUsageFlags usage;
         VkSharingMode sharingMode;
 
+        /// queue families that access the buffer when sharingMode is VK_SHARING_MODE_CONCURRENT
+        std::vector<uint32_t> queueFamilyIndices;
+
         /// Vulkan VkImage handle
         VkBuffer vk(uint32_t deviceID) const { return _vulkanData[deviceID].buffer; }
 
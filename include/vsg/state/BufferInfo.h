@@ -48,12 +48,15 @@ namespace vsg
             buffer = 0;
             offset = 0;
             range = 0;
+            copyState.clear();
         }
 
         /// copy data to the VkBuffer(s) for all Devices associated with vsg::Buffer
         void copyDataToBuffer();
 
-        /// copy data to the VkBuffer associated with the a specified Device
+        /// copy data to the VkBuffer associated with the a specified Device.
+        /// Data that has been marked as modified with Data::dirty() or Data::dirty(offset, size) is skipped if it hasn't been modified since it was last copied, and if only dirty ranges
+        /// have been modified since then just those ranges are copied. Data that has never been dirty()'d is always copied. Clear copyState to force a copy of the whole data.
         void copyDataToBuffer(uint32_t deviceID);
 
         explicit operator bool() const { return buffer.valid() && data.valid() && range != 0; }
@@ -62,6 +65,14 @@ namespace vsg
         VkDeviceSize offset = 0;
         VkDeviceSize range = 0;
         ref_ptr<Data> data;
+
+        /// the Data and its ModifiedCount when last copied to the VkBuffer of each Device, clear to force a copy of the whole data.
+        struct CopyState
+        {
+            const Data* data = nullptr;
+            uint32_t modifiedCount = 0;
+        };
+        vk_buffer<CopyState> copyState;
     };
 
     using BufferInfoList = std::vector<BufferInfo>;
@@ -72,6 +83,9 @@ namespace vsg
 
     extern VSG_DECLSPEC BufferInfoList createHostVisibleBuffer(Device* device, const DataList& dataList, VkBufferUsageFlags usage, VkSharingMode sharingMode);
 
+    /// copy the modified data of each BufferInfo to its VkBuffer for the specified Device, mapping each Buffer's memory just once for all the BufferInfo that share it
+    extern VSG_DECLSPEC void copyDataListToBuffers(uint32_t deviceID, BufferInfoList& bufferInfoList);
+
     extern VSG_DECLSPEC void copyDataListToBuffers(Device* device, BufferInfoList& bufferInfoList);
 
 } // namespace vsg
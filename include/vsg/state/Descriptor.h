@@ -39,6 +39,10 @@ namespace vsg
 
         virtual void assignTo(Context& context, VkWriteDescriptorSet& wds) const;
 
+        /// write the packed VkDescriptorImageInfo, VkDescriptorBufferInfo or VkBufferView entries used by a VkDescriptorUpdateTemplate to data.
+        /// Default implementation copies the entries set up by assignTo(context, wds).
+        virtual void assignToTemplateData(Context& context, void* data) const;
+
         virtual uint32_t getNumDescriptors() const { return 1; }
     };
 
@@ -14,6 +14,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/state/BufferInfo.h>
 #include <vsg/state/Descriptor.h>
+#include <vsg/vk/DynamicUniformRing.h>
+
+#include <mutex>
 
 namespace vsg
 {
@@ -38,12 +41,33 @@ namespace vsg
 
         void assignTo(Context& context, VkWriteDescriptorSet& wds) const override;
 
+        void assignToTemplateData(Context& context, void* data) const override;
+
         uint32_t getNumDescriptors() const override;
 
+        /// copy any modified data to the buffers, unchanged data is skipped and data with dirty ranges only has those ranges copied
         void copyDataListToBuffers();
 
+        /// ring buffer the data is copied to each frame, assigned by compile(..) for VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC and VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC descriptors
+        /// when the Context provides one, no buffers have been assigned and the ring has space to reserve for the data. Otherwise the descriptor uses its own buffers with dynamic offsets of 0.
+        ref_ptr<DynamicUniformRing> dynamicUniformRing;
+
+        /// number of dynamic offsets required when binding, one for each BufferInfo of dynamic descriptor types, otherwise 0
+        uint32_t getNumDynamicOffsets() const;
+
+        /// write the dynamic offsets for each BufferInfo, copying the data to the current frame's region of the dynamicUniformRing when it's assigned, otherwise the offsets are 0.
+        /// The data is only copied on the first call each frame so the DescriptorBuffer can be bound multiple times per frame, including from different threads.
+        void recordDynamicOffsets(uint32_t* dynamicOffsets);
+
     protected:
         virtual ~DescriptorBuffer();
+
+        void _releaseBuffers();
+
+        std::mutex _dynamicOffsetsMutex;
+        std::vector<uint32_t> _dynamicOffsets;
+        uint64_t _dynamicOffsetsFrameCount = 0;
+        VkDeviceSize _dynamicUniformRingReservedSize = 0;
     };
     VSG_type_name(vsg::DescriptorBuffer)
 
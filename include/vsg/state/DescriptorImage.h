@@ -56,6 +56,8 @@ namespace vsg
 
         void assignTo(Context& context, VkWriteDescriptorSet& wds) const override;
 
+        void assignToTemplateData(Context& context, void* data) const override;
+
         uint32_t getNumDescriptors() const override;
 
     protected:
@@ -20,6 +20,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 namespace vsg
 {
+    // forward declare
+    class DescriptorBuffer;
 
     class VSG_DECLSPEC DescriptorSet : public Inherit<Object, DescriptorSet>
     {
@@ -48,8 +50,23 @@ namespace vsg
         void compile(Context& context);
 
         // remove the local reference to the Vulkan implementation
-        void release(uint32_t deviceID) { _implementation[deviceID] = {}; }
-        void release() { _implementation.clear(); }
+        void release(uint32_t deviceID)
+        {
+            _implementation[deviceID] = {};
+            _rewrittenImplementation[deviceID] = {};
+        }
+        void release()
+        {
+            _implementation.clear();
+            _rewrittenImplementation.clear();
+        }
+
+        /// write the descriptors to a newly allocated descriptor set that vk(deviceID) returns once switchToRewrite(deviceID) is called.
+        /// Used once MemoryBufferPools compaction has relocated the BufferInfo of its DescriptorBuffer, as the current descriptor set may still be in use by submitted frames.
+        void rewrite(Context& context);
+
+        /// switch to the descriptor set written by rewrite(context), returning the previous implementation that must be retained until the frames that may use it have completed.
+        ref_ptr<Object> switchToRewrite(uint32_t deviceID);
 
         VkDescriptorSet vk(uint32_t deviceID) const { return _implementation[deviceID]->_descriptorSet; }
 
@@ -60,11 +77,14 @@ namespace vsg
         {
             Implementation(Device* device, DescriptorPool* descriptorPool, DescriptorSetLayout* descriptorSetLayout);
 
+            /// allocate from context.descriptorPool when it has space, otherwise from context.descriptorPools
+            Implementation(Context& context, DescriptorSetLayout* descriptorSetLayout);
+
             virtual ~Implementation();
 
             void assign(Context& context, const Descriptors& descriptors);
 
-            VkDescriptorSet _descriptorSet;
+            VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
             ref_ptr<Device> _device;
             ref_ptr<DescriptorPool> _descriptorPool;
             ref_ptr<DescriptorSetLayout> _descriptorSetLayout;
@@ -72,6 +92,7 @@ namespace vsg
         };
 
         vk_buffer<ref_ptr<Implementation>> _implementation;
+        vk_buffer<ref_ptr<Implementation>> _rewrittenImplementation;
     };
     VSG_type_name(vsg::DescriptorSet);
 
@@ -131,6 +152,10 @@ namespace vsg
         {
             VkPipelineLayout _vkPipelineLayout = 0;
             std::vector<VkDescriptorSet> _vkDescriptorSets;
+
+            // DescriptorBuffer that require dynamic offsets, in the order vkCmdBindDescriptorSets expects their offsets
+            std::vector<DescriptorBuffer*> _dynamicDescriptorBuffers;
+            uint32_t _numDynamicOffsets = 0;
         };
 
         vk_buffer<VulkanData> _vulkanData;
@@ -191,6 +216,10 @@ namespace vsg
         {
             VkPipelineLayout _vkPipelineLayout = 0;
             VkDescriptorSet _vkDescriptorSet;
+
+            // DescriptorBuffer that require dynamic offsets, in the order vkCmdBindDescriptorSets expects their offsets
+            std::vector<DescriptorBuffer*> _dynamicDescriptorBuffers;
+            uint32_t _numDynamicOffsets = 0;
         };
 
         vk_buffer<VulkanData> _vulkanData;
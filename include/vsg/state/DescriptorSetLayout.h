@@ -12,6 +12,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/state/Descriptor.h>
 #include <vsg/vk/Device.h>
 #include <vsg/vk/vk_buffer.h>
 
@@ -29,8 +30,12 @@ namespace vsg
         DescriptorSetLayout(const DescriptorSetLayoutBindings& descriptorSetLayoutBindings);
 
         /// VkDescriptorSetLayoutCreateInfo settings
+        VkDescriptorSetLayoutCreateFlags flags = 0;
         DescriptorSetLayoutBindings bindings;
 
+        /// optional VkDescriptorSetLayoutBindingFlagsCreateInfoEXT settings, one entry per binding, requires VK_EXT_descriptor_indexing
+        std::vector<VkDescriptorBindingFlagsEXT> bindingFlags;
+
         /// Vulkan VkDescriptorSetLayout handle
         VkDescriptorSetLayout vk(uint32_t deviceID) const { return _implementation[deviceID]->_descriptorSetLayout; }
 
@@ -40,6 +45,11 @@ namespace vsg
         // compile the Vulkan object, context parameter used for Device
         void compile(Context& context);
 
+        /// write descriptors to descriptorSet with a single vkUpdateDescriptorSetWithTemplateKHR call using a VkDescriptorUpdateTemplate built when the layout was compiled.
+        /// Descriptors may each write the whole of a binding or individual array elements of it, written at their dstArrayElement.
+        /// Return false when VK_KHR_descriptor_update_template isn't enabled or the descriptors don't write every array element of every binding exactly once, in which case vkUpdateDescriptorSets should be used.
+        bool updateDescriptorSet(Context& context, VkDescriptorSet descriptorSet, const Descriptors& descriptors) const;
+
         // remove the local reference to the Vulkan implementation
         void release(uint32_t deviceID) { _implementation[deviceID] = {}; }
         void release() { _implementation.clear(); }
@@ -49,12 +59,30 @@ namespace vsg
 
         struct Implementation : public Inherit<Object, Implementation>
         {
-            Implementation(Device* device, const DescriptorSetLayoutBindings& descriptorSetLayoutBindings);
+            Implementation(Device* device, const DescriptorSetLayoutBindings& descriptorSetLayoutBindings, VkDescriptorSetLayoutCreateFlags flags = 0, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags = {});
 
             virtual ~Implementation();
 
             ref_ptr<Device> _device;
             VkDescriptorSetLayout _descriptorSetLayout;
+
+            // VkDescriptorUpdateTemplate writing every binding of the layout from a packed data block
+            struct TemplateEntry
+            {
+                uint32_t binding;
+                uint32_t descriptorCount;
+                VkDescriptorType descriptorType;
+                size_t offset;
+                size_t stride;
+                uint32_t firstElement; // index of the binding's first array element across all the entries, used to track which elements have been written
+            };
+
+            VkDescriptorUpdateTemplateKHR _updateTemplate = VK_NULL_HANDLE;
+            std::vector<TemplateEntry> _templateEntries;
+            size_t _templateDataSize = 0;
+            uint32_t _templateNumElements = 0;
+            PFN_vkUpdateDescriptorSetWithTemplateKHR _vkUpdateDescriptorSetWithTemplate = nullptr;
+            PFN_vkDestroyDescriptorUpdateTemplateKHR _vkDestroyDescriptorUpdateTemplate = nullptr;
         };
 
         vk_buffer<ref_ptr<Implementation>> _implementation;
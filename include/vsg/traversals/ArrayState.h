@@ -16,9 +16,46 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/Data.h>
 #include <vsg/core/Inherit.h>
 
+#include <mutex>
+
 namespace vsg
 {
 
+    /// vec3 vertices decoded from an array with a half float, normalized integer or double vertex format.
+    /// DecodedVertices are cached on the source array so repeated intersection and bounds traversals can reuse them rather than decoding each traversal.
+    class VSG_DECLSPEC DecodedVertices : public Inherit<Object, DecodedVertices>
+    {
+    public:
+        DecodedVertices();
+
+        /// details of the source the vertices were decoded from, used to decide whether they need to be decoded again
+        uint32_t offset = 0;
+        uint32_t stride = 0;
+        VkFormat format = {};
+        uint32_t sourceModifiedCount = 0;
+
+        ref_ptr<vec3Array> vertices;
+
+        /// return true if the vertex format can be decoded
+        static bool supported(VkFormat in_format);
+
+        /// decode the vertices from source, return false if the format isn't supported
+        bool decode(const Data& source, uint32_t in_offset, uint32_t in_stride, VkFormat in_format);
+
+        /// return true if the vertices were decoded from source with the specified layout and the source hasn't been modified since
+        bool valid(const Data& source, uint32_t in_offset, uint32_t in_stride, VkFormat in_format) const;
+
+        /// get the DecodedVertices cached on source, decoding them if they are missing or out of date, return null if the format isn't supported
+        /// Vertices are decoded once, only threads requesting the same DecodedVertices wait on the thread decoding them.
+        static ref_ptr<const DecodedVertices> getOrCreate(const Data& source, uint32_t in_offset, uint32_t in_stride, VkFormat in_format);
+
+    protected:
+        virtual ~DecodedVertices();
+
+        std::once_flag _decoded;
+    };
+    VSG_type_name(vsg::DecodedVertices);
+
     class VSG_DECLSPEC ArrayState : public Inherit<ConstVisitor, ArrayState>
     {
     public:
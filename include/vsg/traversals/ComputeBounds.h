@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/maths/box.h>
 #include <vsg/traversals/ArrayState.h>
+#include <vsg/traversals/ParallelTraversal.h>
 
 namespace vsg
 {
@@ -31,7 +32,18 @@ namespace vsg
         using MatrixStack = std::vector<mat4>;
         MatrixStack matrixStack;
 
+        /// optional ParallelTraversal used to distribute the traversal of large Group and QuadGroup subgraphs across threads
+        ref_ptr<ParallelTraversal> parallelTraversal;
+
+        /// create a ComputeBounds with the current matrix and array state but empty bounds, for use by ParallelTraversal
+        ref_ptr<ComputeBounds> fork() const;
+
+        /// merge the bounds computed by a forked ComputeBounds
+        void join(const ComputeBounds& forked);
+
         void apply(const Node& node) override;
+        void apply(const Group& group) override;
+        void apply(const QuadGroup& group) override;
         void apply(const StateGroup& stategroup) override;
         void apply(const MatrixTransform& transform) override;
         void apply(const Geometry& geometry) override;
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/traversals/Intersector.h>
+#include <vsg/traversals/TriangleBVH.h>
 
 #include <vsg/viewer/Camera.h>
 
@@ -51,7 +52,35 @@ namespace vsg
         using Intersections = std::vector<Intersection>;
         Intersections intersections;
 
-        void add(const dvec3& intersection, double ratio, const IndexRatios& indexRatios);
+        enum IntersectionMode
+        {
+            ALL_INTERSECTIONS,
+            NEAREST_INTERSECTION
+        };
+
+        /// ALL_INTERSECTIONS collects every intersection, NEAREST_INTERSECTION keeps just the nearest in intersections,
+        /// shortening the line segment as hits are found so that subgraphs beyond the current nearest hit are skipped.
+        /// Changing the mode calls reset().
+        void setIntersectionMode(IntersectionMode mode);
+        IntersectionMode getIntersectionMode() const { return _intersectionMode; }
+
+        /// set the world coordinate line segment to intersect with, calls reset().
+        void setLineSegment(const dvec3& s, const dvec3& e);
+
+        /// clear the intersections and restore maximumRatio() to 1.0 so the intersector can be reused for another traversal.
+        void reset();
+
+        /// ratio along the line segment beyond which intersections are rejected, 1.0 unless a hit has been found in NEAREST_INTERSECTION mode
+        double maximumRatio() const { return _maximumRatio; }
+
+        /// minimum number of triangles in a draw before a TriangleBVH is built and cached to accelerate intersections, 0 disables the use of TriangleBVH.
+        uint32_t triangleBVHThreshold = 256;
+
+        /// add an intersection, returns false if it was rejected as being further away than the nearest hit in NEAREST_INTERSECTION mode
+        bool add(const dvec3& intersection, double ratio, const IndexRatios& indexRatios);
+
+        /// in NEAREST_INTERSECTION mode visit the children front to back so near hits are found first and shorten the line segment for the remaining children
+        void apply(const Group& group) override;
 
         void pushTransform(const dmat4& m) override;
         void popTransform() override;
@@ -69,7 +98,15 @@ namespace vsg
             dvec3 end;
         };
 
+        IntersectionMode _intersectionMode = ALL_INTERSECTIONS;
         std::vector<LineSegment> _lineSegmentStack;
+        double _maximumRatio = 1.0;
+
+        /// children with the ratio at which the line segment enters their bounds, shared between nested groups to avoid allocating per group
+        std::vector<std::pair<double, const Node*>> _orderedChildren;
+
+        /// compute the ratio at which the line segment enters the sphere, return false if the line segment doesn't intersect it before maximumRatio()
+        bool entryRatio(const dsphere& bs, double& ratio) const;
     };
     VSG_type_name(vsg::LineSegmentIntersector);
 
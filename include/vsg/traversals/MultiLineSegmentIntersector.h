@@ -0,0 +1,98 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/traversals/LineSegmentIntersector.h>
+
+namespace vsg
+{
+
+    /// MultiLineSegmentIntersector intersects a batch of line segments with the scene graph in a single traversal.
+    /// Each subtree is only visited by the segments that intersect its bounding sphere, with the segments kept in a struct of arrays layout
+    /// so that the bounding sphere and triangle tests for all the active segments can be vectorized by the compiler.
+    class VSG_DECLSPEC MultiLineSegmentIntersector : public Inherit<Intersector, MultiLineSegmentIntersector>
+    {
+    public:
+        struct LineSegment
+        {
+            dvec3 start;
+            dvec3 end;
+        };
+
+        using LineSegments = std::vector<LineSegment>;
+        using Intersection = LineSegmentIntersector::Intersection;
+        using Intersections = LineSegmentIntersector::Intersections;
+
+        explicit MultiLineSegmentIntersector(const LineSegments& lineSegments);
+        MultiLineSegmentIntersector(const Camera& camera, const std::vector<ivec2>& windowCoordinates);
+
+        /// intersections for each of the line segments, in the same order as the line segments were passed to the constructor
+        std::vector<Intersections> intersections;
+
+        /// minimum number of triangles in a draw before a TriangleBVH is built and cached to accelerate intersections, 0 disables the use of TriangleBVH.
+        uint32_t triangleBVHThreshold = 256;
+
+        size_t numLineSegments() const { return intersections.size(); }
+
+        void add(uint32_t lineSegmentIndex, const dvec3& intersection, double ratio, const IndexRatios& indexRatios);
+
+        void apply(const LOD& lod) override;
+        void apply(const PagedLOD& plod) override;
+        void apply(const CullNode& cn) override;
+        void apply(const VertexIndexDraw& vid) override;
+
+        void pushTransform(const dmat4& m) override;
+        void popTransform() override;
+
+        /// remove the active line segments that don't intersect the sphere, return true if any line segments remain active
+        bool intersects(const dsphere& bs) override;
+
+        bool intersectDraw(uint32_t firstVertex, uint32_t vertexCount) override;
+        bool intersectDrawIndexed(uint32_t firstIndex, uint32_t indexCount) override;
+
+    protected:
+        /// line segments in the local coordinate frame, stored as start points and start to end deltas in a struct of arrays layout
+        struct LineSegmentArrays
+        {
+            std::vector<double> sx, sy, sz;
+            std::vector<double> dx, dy, dz;
+
+            void resize(size_t size);
+            void set(size_t i, const dvec3& start, const dvec3& end);
+        };
+
+        std::vector<LineSegmentArrays> _lineSegmentStack;
+        size_t _lineSegmentDepth = 0;
+
+        /// indices of the line segments that are active for the current subtree, one list per level so that the parent's list can be restored
+        std::vector<std::vector<uint32_t>> _activeStack;
+        size_t _activeDepth = 0;
+
+        size_t _numIntersections = 0;
+
+        struct PushPopActive
+        {
+            MultiLineSegmentIntersector& intersector;
+
+            explicit PushPopActive(MultiLineSegmentIntersector& in_intersector);
+            ~PushPopActive() { --intersector._activeDepth; }
+        };
+
+        std::vector<uint32_t>& active() { return _activeStack[_activeDepth]; }
+
+        void intersectTriangle(uint32_t i0, uint32_t i1, uint32_t i2);
+        void intersectTriangle(uint32_t lineSegmentIndex, uint32_t i0, uint32_t i1, uint32_t i2);
+    };
+    VSG_type_name(vsg::MultiLineSegmentIntersector);
+
+} // namespace vsg
@@ -0,0 +1,193 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/nodes/Group.h>
+#include <vsg/nodes/QuadGroup.h>
+#include <vsg/threading/Latch.h>
+#include <vsg/threading/OperationThreads.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace vsg
+{
+
+    /// ParallelTraversal distributes the traversal of the children of large Group and QuadGroup nodes across OperationThreads.
+    /// Visitors that wish to use ParallelTraversal must be forkable and joinable, providing the methods:
+    ///     ref_ptr<V> fork() const;     // create a copy of the visitor with the current traversal state and empty results
+    ///     void join(const V& forked);  // merge the results of a forked visitor back into this visitor
+    class VSG_DECLSPEC ParallelTraversal : public Inherit<Object, ParallelTraversal>
+    {
+    public:
+        explicit ParallelTraversal(ref_ptr<OperationThreads> in_operationThreads = {});
+
+        ref_ptr<OperationThreads> operationThreads;
+
+        /// minimum number of children a Group requires before it's children are distributed across threads
+        size_t minimumNumChildren = 32;
+
+        /// maximum number of tasks that the children of a single Group are divided into, 0 uses the number of threads + 1
+        size_t maximumNumTasks = 0;
+
+        /// maximum depth of nested parallel traversals, subgraphs below this depth are traversed by the thread that reaches them
+        uint32_t maximumDepth = 2;
+
+        /// traverse the children of Group in parallel, return false if the caller should traverse the Group serially
+        template<class V>
+        bool traverse(const Group& group, V& visitor)
+        {
+            auto& children = group.getChildren();
+            if (children.size() < minimumNumChildren) return false;
+            return t_traverse(children.data(), children.size(), visitor);
+        }
+
+        /// traverse the children of QuadGroup in parallel, return false if the caller should traverse the QuadGroup serially
+        template<class V>
+        bool traverse(const QuadGroup& group, V& visitor)
+        {
+            return t_traverse(&(group.getChildren()[0]), group.getNumChildren(), visitor);
+        }
+
+    protected:
+        virtual ~ParallelTraversal();
+
+        /// depth of parallel traversal that the calling thread is currently running
+        static uint32_t& threadDepth();
+
+        struct ScopedDepth
+        {
+            uint32_t& depth;
+            uint32_t previous;
+
+            ScopedDepth(uint32_t in_depth) :
+                depth(threadDepth()), previous(depth) { depth = in_depth; }
+            ~ScopedDepth() { depth = previous; }
+        };
+
+        /// ranges of children to traverse with forked visitors, claimed by the calling thread and by helper operations run on the OperationThreads,
+        /// so the threads only ever run the traversal's own subtrees and never block on unrelated operations in the shared queue.
+        template<class V>
+        struct TaskSet : public Inherit<Object, TaskSet<V>>
+        {
+            struct Task
+            {
+                ref_ptr<V> visitor;
+                const ref_ptr<Node>* begin;
+                const ref_ptr<Node>* end;
+            };
+
+            TaskSet(size_t numTasks, uint32_t in_depth) :
+                depth(in_depth),
+                latch(Latch::create(static_cast<int>(numTasks)))
+            {
+                tasks.reserve(numTasks);
+            }
+
+            /// claim and run the next task, return false when all the tasks have been claimed
+            bool runNext()
+            {
+                size_t i = next.fetch_add(1);
+                if (i >= tasks.size()) return false;
+
+                auto& task = tasks[i];
+                {
+                    ScopedDepth scopedDepth(depth);
+                    for (auto itr = task.begin; itr != task.end; ++itr)
+                    {
+                        if ((*itr)->validMask(task.visitor->traversalMask)) (*itr)->accept(*task.visitor);
+                    }
+                }
+                latch->count_down();
+                return true;
+            }
+
+            std::vector<Task> tasks;
+            std::atomic<size_t> next{0};
+            uint32_t depth;
+            ref_ptr<Latch> latch;
+        };
+
+        /// operation added to the OperationThreads queue that helps run the tasks of a TaskSet, exiting as soon as all have been claimed
+        template<class V>
+        struct HelperOperation : public Inherit<Operation, HelperOperation<V>>
+        {
+            explicit HelperOperation(ref_ptr<TaskSet<V>> in_taskSet) :
+                taskSet(in_taskSet) {}
+
+            void run() override
+            {
+                while (taskSet->runNext()) {}
+            }
+
+            ref_ptr<TaskSet<V>> taskSet;
+        };
+
+        template<class V>
+        bool t_traverse(const ref_ptr<Node>* children, size_t numChildren, V& visitor)
+        {
+            uint32_t depth = threadDepth();
+            if (!operationThreads || depth >= maximumDepth) return false;
+
+            size_t numTasks = (maximumNumTasks > 0) ? maximumNumTasks : (operationThreads->threads.size() + 1);
+            if (numTasks > numChildren) numTasks = numChildren;
+            if (numTasks < 2) return false;
+
+            // this thread takes the first range of children, the remaining ranges are handed to forked visitors
+            auto taskSet = TaskSet<V>::create(numTasks - 1, depth + 1);
+
+            size_t numChildrenFirstRange = numChildren / numTasks;
+            const ref_ptr<Node>* end = children + numChildren;
+            const ref_ptr<Node>* itr = children + numChildrenFirstRange;
+            for (size_t i = 1; i < numTasks; ++i)
+            {
+                const ref_ptr<Node>* range_end = (i + 1 < numTasks) ? (children + ((i + 1) * numChildren) / numTasks) : end;
+                taskSet->tasks.push_back(typename TaskSet<V>::Task{visitor.fork(), itr, range_end});
+                itr = range_end;
+            }
+
+            // helpers are only useful up to the number of threads, any that run after all the tasks are claimed exit immediately
+            size_t numHelpers = std::min(taskSet->tasks.size(), operationThreads->threads.size());
+            for (size_t i = 0; i < numHelpers; ++i)
+            {
+                operationThreads->add(HelperOperation<V>::create(taskSet));
+            }
+
+            {
+                ScopedDepth scopedDepth(depth + 1);
+                for (itr = children; itr != children + numChildrenFirstRange; ++itr)
+                {
+                    if ((*itr)->validMask(visitor.traversalMask)) (*itr)->accept(visitor);
+                }
+            }
+
+            // use this thread to run any tasks not yet claimed by the helpers
+            while (taskSet->runNext()) {}
+
+            // wait till the tasks claimed by the helpers have completed
+            taskSet->latch->wait();
+
+            // release the forked visitors on this thread, as the helpers may hold the last reference to the TaskSet,
+            // and a forked visitor may hold the last reference to the ParallelTraversal and its OperationThreads
+            for (auto& task : taskSet->tasks)
+            {
+                visitor.join(*(task.visitor));
+                task.visitor = {};
+            }
+
+            return true;
+        }
+    };
+    VSG_type_name(vsg::ParallelTraversal);
+
+} // namespace vsg
@@ -0,0 +1,93 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/maths/plane.h>
+#include <vsg/traversals/Intersector.h>
+
+#include <vsg/viewer/Camera.h>
+
+namespace vsg
+{
+
+    /// PolytopeIntersector intersects a convex polytope with the scene graph, used for rubber band selection and volume queries.
+    /// The polytope is a list of planes with normals pointing inwards, points, lines and triangles wholly or partially inside the polytope are reported.
+    class VSG_DECLSPEC PolytopeIntersector : public Inherit<Intersector, PolytopeIntersector>
+    {
+    public:
+        using Polytope = std::vector<dplane>;
+
+        explicit PolytopeIntersector(const Polytope& polytope);
+
+        /// create a polytope from the window coordinate rectangle xMin, yMin to xMax, yMax, clipped by the camera's side planes
+        PolytopeIntersector(const Camera& camera, double xMin, double yMin, double xMax, double yMax);
+
+        struct Intersection
+        {
+            dvec3 localIntersection;
+            dvec3 worldIntersection;
+
+            dmat4 localToWord;
+            NodePath nodePath;
+            DataList arrays;
+
+            /// vertex indices of the primitive, empty when in BOUNDING_SPHERES mode
+            std::vector<uint32_t> indices;
+
+            // return true if Intersection is valid
+            operator bool() const { return !nodePath.empty(); }
+        };
+
+        using Intersections = std::vector<Intersection>;
+        Intersections intersections;
+
+        enum IntersectionMode
+        {
+            ALL_PRIMITIVES,  // report every primitive inside the polytope
+            FIRST_PRIMITIVE, // report only the first primitive found inside the polytope for each draw
+            BOUNDING_SPHERES // report each draw whose bounding sphere intersects the polytope without testing its primitives, localIntersection is the draw's first vertex
+        };
+
+        IntersectionMode intersectionMode = ALL_PRIMITIVES;
+
+        void add(const dvec3& intersection, const uint32_t* primitiveIndices, uint32_t numIndices);
+
+        void pushTransform(const dmat4& m) override;
+        void popTransform() override;
+
+        /// check for intersection instersects with sphere
+        bool intersects(const dsphere& bs) override;
+
+        bool intersectDraw(uint32_t firstVertex, uint32_t vertexCount) override;
+        bool intersectDrawIndexed(uint32_t firstIndex, uint32_t indexCount) override;
+
+    protected:
+        std::vector<Polytope> _polytopeStack;
+
+        /// buffers used when clipping primitives against the polytope, reused to avoid allocating for each primitive
+        std::vector<dvec3> _clipBuffer;
+        std::vector<dvec3> _clipResult;
+
+        /// return true if the primitive's vertices are wholly or partially inside the polytope, computing the center of the part that is inside
+        bool intersectPrimitive(const uint32_t* primitiveIndices, uint32_t numIndices, dvec3& center);
+
+        /// return true if the bounding sphere of the vertices covered by the current draw intersects the polytope.
+        template<typename GetIndex>
+        bool intersectsDrawBound(uint32_t first, uint32_t count, GetIndex getIndex);
+
+        template<typename GetIndex>
+        bool intersectPrimitives(uint32_t first, uint32_t count, GetIndex getIndex);
+    };
+    VSG_type_name(vsg::PolytopeIntersector);
+
+} // namespace vsg
@@ -0,0 +1,50 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <cstdint>
+
+namespace vsg
+{
+
+    /// RecordStatistics counts the work done by a RecordTraversal when recording a frame, reset at the start of each CommandGraph::record().
+    struct RecordStatistics
+    {
+        uint32_t numNodes = 0;                 // nodes visited
+        uint32_t numCulledByFrustum = 0;       // CullGroup, CullNode, LOD and PagedLOD culled as they are outside the view frustum
+        uint32_t numCulledByLOD = 0;           // LOD and PagedLOD culled as none of their children are visible at the current distance
+        uint32_t numPagedLODRequests = 0;      // PagedLOD children requested from the DatabasePager
+        uint32_t numStateCommandsRecorded = 0; // state commands recorded, when a new state is applied
+        uint32_t numStateCommandsSkipped = 0;  // state commands pushed, or restored by a pop, that were popped again before any draw needed them recorded
+        uint32_t numPushConstants = 0;         // projection and modelview matrix push constant updates
+        uint32_t numDraws = 0;                 // draw commands, Draw, DrawIndexed, VertexIndexDraw and the draws within Geometry
+        uint64_t numTriangles = 0;             // triangles submitted by draw commands, assumes triangle lists as RecordTraversal doesn't track topology
+
+        void reset() { *this = {}; }
+
+        RecordStatistics& operator+=(const RecordStatistics& rhs)
+        {
+            numNodes += rhs.numNodes;
+            numCulledByFrustum += rhs.numCulledByFrustum;
+            numCulledByLOD += rhs.numCulledByLOD;
+            numPagedLODRequests += rhs.numPagedLODRequests;
+            numStateCommandsRecorded += rhs.numStateCommandsRecorded;
+            numStateCommandsSkipped += rhs.numStateCommandsSkipped;
+            numPushConstants += rhs.numPushConstants;
+            numDraws += rhs.numDraws;
+            numTriangles += rhs.numTriangles;
+            return *this;
+        }
+    };
+
+} // namespace vsg
@@ -12,9 +12,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/core/Mask.h>
 #include <vsg/core/Object.h>
 #include <vsg/core/type_name.h>
 #include <vsg/maths/mat4.h>
+#include <vsg/maths/sphere.h>
+#include <vsg/traversals/RecordStatistics.h>
+
+#include <vector>
 
 namespace vsg
 {
@@ -31,11 +36,16 @@ namespace vsg
     class MatrixTransform;
     class Command;
     class Commands;
+    class Draw;
+    class DrawIndexed;
+    class VertexIndexDraw;
+    class Geometry;
     class CommandBuffer;
     class State;
     class DatabasePager;
     class FrameStamp;
     class CulledPagedLODs;
+    class TraversalStack;
 
     class RecordTraversal;
     VSG_type_name(vsg::RecordTraversal);
@@ -49,8 +59,42 @@ namespace vsg
         std::size_t sizeofObject() const noexcept override { return sizeof(RecordTraversal); }
         const char* className() const noexcept override { return type_name<RecordTraversal>(); }
 
+        /// only traverse nodes where (node.mask & traversalMask) != 0
+        Mask traversalMask = MASK_ALL;
+
+        /// set by TraversalStack::traverse() while it drives this RecordTraversal, the apply() methods then push children onto it rather than visiting them recursively
+        TraversalStack* traversalStack = nullptr;
+
+        /// restoreMarker bits used when pushing children onto the traversalStack
+        enum RestoreMarker : uint32_t
+        {
+            RESTORE_STATE = 1,
+            RESTORE_MATRIX = 2,
+            RESTORE_FRUSTUM = 4
+        };
+
+        /// pop the state, matrices and frustum pushed by apply() once the node's children have been visited from the traversalStack
+        void restore(const Node& node, uint32_t restoreMarker);
+
         State* getState() { return _state; }
 
+        /// bit mask of views, bit i set when view i is visible
+        using ViewMask = uint32_t;
+
+        /// set the number of views culled and recorded in a single traversal, up to 32. View 0 is the main State, the additional views each have their own State.
+        /// Each node is visited once, with the cull tests of CullGroup, CullNode, LOD and PagedLOD restricting the subgraph to the views that it's visible in.
+        void setNumViews(uint32_t numViews);
+        uint32_t getNumViews() const { return static_cast<uint32_t>(_views.size()); }
+
+        State* getState(uint32_t viewIndex) { return _views[viewIndex]; }
+
+        /// when true LOD and PagedLOD children are selected using the first view the LOD is visible in, and that selection is shared by all the views
+        bool shareLODSelection = false;
+
+        /// when true all views record into view 0's CommandBuffer, once per command, for use with a multiview render pass where the shaders select per view matrices using gl_ViewIndex.
+        /// When false each view records into its own State's CommandBuffer.
+        bool multiview = false;
+
         void setFrameStamp(FrameStamp* fs);
         FrameStamp* getFrameStamp() { return _frameStamp; }
 
@@ -58,6 +102,11 @@ namespace vsg
         DatabasePager* getDatabasePager() { return _databasePager; }
 
         void setProjectionAndViewMatrix(const dmat4& projMatrix, const dmat4& viewMatrix);
+        void setProjectionAndViewMatrix(uint32_t viewIndex, const dmat4& projMatrix, const dmat4& viewMatrix);
+
+        /// statistics of the work done recording the current frame, reset at the start of each CommandGraph::record()
+        RecordStatistics& getStatistics();
+        const RecordStatistics& getStatistics() const;
 
         void apply(const Object& object);
 
@@ -75,10 +124,26 @@ namespace vsg
         void apply(const Commands& commands);
         void apply(const Command& command);
 
+        // draw commands, handled separately to collect statistics
+        void apply(const Draw& draw);
+        void apply(const DrawIndexed& drawIndexed);
+        void apply(const VertexIndexDraw& vid);
+        void apply(const Geometry& geometry);
+
     private:
+        ViewMask _visibleViews(const dsphere& bound);
+        ViewMask _stateViews() const { return multiview ? (_viewMask | 1) : _viewMask; }
+        void _traverse(const Node& node, const ref_ptr<Node>* children, std::size_t numChildren, ViewMask viewMask);
+        void _traverseChild(const Node& parent, const ref_ptr<Node>& child, ViewMask viewMask);
+        uint32_t _record(const Command& command);
+
         FrameStamp* _frameStamp = nullptr;
         State* _state = nullptr;
 
+        // _views[0] is _state, views are only traversed while their bit in _viewMask is set
+        std::vector<State*> _views;
+        ViewMask _viewMask = 1;
+
         // used to handle loading of PagedLOD external children.
         DatabasePager* _databasePager = nullptr;
         CulledPagedLODs* _culledPagedLODs = nullptr;
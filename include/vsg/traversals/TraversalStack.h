@@ -0,0 +1,128 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/nodes/Node.h>
+
+#include <vector>
+
+namespace vsg
+{
+
+    /** TraversalStack drives a visitor iteratively over a scene graph using an explicit, preallocated stack of records rather than recursing,
+     *  so that very deep scene graphs can be traversed without overflowing the thread's call stack.
+     *  Iterative traversal is an explicit entry point, TraversalStack::traverse(), for visitors written to support it. Node traverse() methods always recurse,
+     *  instead while driven by a TraversalStack the visitor's traversalStack member is set and the visitor's own apply() methods push a record of the children
+     *  they would otherwise have traversed. Visitors that need to undo changes made in apply() once a subgraph has been visited, such as popping state or matrices,
+     *  push their children with a non zero restoreMarker, the visitor's restore(node, restoreMarker) method is then called once all the children have been visited.
+     *  RecordTraversal supports iterative traversal, enabled by assigning CommandGraph::traversalStack.*/
+    class VSG_DECLSPEC TraversalStack : public Inherit<Object, TraversalStack>
+    {
+    public:
+        explicit TraversalStack(std::size_t reserve = 1024);
+
+        struct Record
+        {
+            const Node* node = nullptr;        // node whose children are being visited
+            const uint8_t* children = nullptr; // address of the first child's ref_ptr<Node>
+            uint32_t stride = 0;               // distance in bytes between successive children
+            uint32_t numChildren = 0;
+            uint32_t childIndex = 0;    // next child to visit
+            uint32_t restoreMarker = 0; // passed to visitor.restore(..) once all the children have been visited, 0 for no restore
+
+            const ref_ptr<Node>& child(uint32_t i) const { return *reinterpret_cast<const ref_ptr<Node>*>(children + i * stride); }
+        };
+
+        using Records = std::vector<Record>;
+
+        /// push the children of node, children are stride bytes apart so that ref_ptr<Node> embedded in structs such as LOD::Child can be referenced in place.
+        void push(const Node& node, const ref_ptr<Node>* children, std::size_t numChildren, std::size_t stride = sizeof(ref_ptr<Node>), uint32_t restoreMarker = 0)
+        {
+            _records.push_back(Record{&node, reinterpret_cast<const uint8_t*>(children), static_cast<uint32_t>(stride), static_cast<uint32_t>(numChildren), 0, restoreMarker});
+        }
+
+        /// push a record with no children so that visitor.restore(node, restoreMarker) is called once the records pushed after it have been visited
+        void pushRestore(const Node& node, uint32_t restoreMarker)
+        {
+            _records.push_back(Record{&node, nullptr, 0, 0, 0, restoreMarker});
+        }
+
+        /// visit node and its subgraph with visitor, visitor.traversalStack is set to this TraversalStack for the duration of the traversal.
+        /// The visitor must provide a traversalStack member and a restore(node, restoreMarker) method.
+        template<class N, class V>
+        void traverse(N& node, V& visitor)
+        {
+            auto previousTraversalStack = visitor.traversalStack;
+            visitor.traversalStack = this;
+
+            auto base = _records.size();
+            node.accept(visitor);
+            visitRecords(base, visitor);
+
+            visitor.traversalStack = previousTraversalStack;
+        }
+
+        /// visit the subgraphs of node's children before returning, for use by apply()/accept() implementations that have work to do once their subgraph has been visited
+        template<class V>
+        void traverseChildren(const Node& node, const ref_ptr<Node>* children, std::size_t numChildren, V& visitor)
+        {
+            auto base = _records.size();
+            push(node, children, numChildren);
+            visitRecords(base, visitor);
+        }
+
+        /// visit the subgraph of a single child of parent before returning
+        template<class V>
+        void traverseChild(const Node& parent, const ref_ptr<Node>& child, V& visitor)
+        {
+            auto base = _records.size();
+            push(parent, &child, 1);
+            visitRecords(base, visitor);
+        }
+
+        /// current depth of the traversal
+        std::size_t size() const { return _records.size(); }
+
+        const Records& getRecords() const { return _records; }
+
+    protected:
+        virtual ~TraversalStack();
+
+        template<class V>
+        void visitRecords(std::size_t base, V& visitor)
+        {
+            while (_records.size() > base)
+            {
+                auto& record = _records.back();
+                if (record.childIndex < record.numChildren)
+                {
+                    // accept() may push new records so the record reference must not be used after it
+                    auto& child = record.child(record.childIndex++);
+                    if (child && child->validMask(visitor.traversalMask)) child->accept(visitor);
+                }
+                else
+                {
+                    const Node* parent = record.node;
+                    uint32_t restoreMarker = record.restoreMarker;
+                    _records.pop_back();
+
+                    if (restoreMarker != 0) visitor.restore(*parent, restoreMarker);
+                }
+            }
+        }
+
+        Records _records;
+    };
+    VSG_type_name(vsg::TraversalStack);
+
+} // namespace vsg
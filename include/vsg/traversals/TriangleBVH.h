@@ -0,0 +1,169 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Array.h>
+#include <vsg/core/Inherit.h>
+#include <vsg/core/observer_ptr.h>
+#include <vsg/maths/box.h>
+
+#include <mutex>
+
+namespace vsg
+{
+
+    // forward declare
+    class ArrayState;
+
+    /// TriangleBVH is a bounding volume hierarchy of the triangles of a mesh, used to accelerate line segment intersections.
+    /// Triangles are stored in packets of PacketSize in a struct of arrays layout so the ray/triangle tests of a packet can be vectorized by the compiler.
+    class VSG_DECLSPEC TriangleBVH : public Inherit<Object, TriangleBVH>
+    {
+    public:
+        TriangleBVH();
+
+        static constexpr uint32_t PacketSize = 4;
+        static constexpr uint32_t MaxPacketsPerLeaf = 2;
+        static constexpr uint32_t InvalidTriangle = 0xffffffff;
+
+        struct Node
+        {
+            box bounds;
+            uint32_t first = 0; // leaf: index of the first packet, internal: index of the second child, the first child immediately follows its parent
+            uint32_t count = 0; // leaf: number of packets, internal: 0
+        };
+
+        struct Packet
+        {
+            float v0[3][PacketSize];
+            float e1[3][PacketSize];
+            float e2[3][PacketSize];
+            uint32_t triangles[PacketSize];
+        };
+
+        std::vector<Node> nodes;
+        std::vector<Packet> packets;
+
+        /// three vertex indices per triangle, in the order of the source indices
+        std::vector<uint32_t> indices;
+
+        /// details of the arrays the TriangleBVH was built from, used to decide whether it needs to be rebuilt.
+        /// The arrays are observed so that a new array allocated at the address of a deleted source array isn't mistaken for it.
+        observer_ptr<Data> sourceVertices;
+        observer_ptr<Data> sourceIndices;
+        uint32_t sourceVerticesModifiedCount = 0;
+        uint32_t sourceIndicesModifiedCount = 0;
+        uint32_t numVertices = 0;
+
+        /// build the TriangleBVH from vertices and optional ushortArray/uintArray indices, if no indices are provided the vertices are treated as a triangle list.
+        void build(const vec3Array& vertices, const Data* in_indices);
+
+        /// return true if the TriangleBVH was built from the specified arrays and they still exist
+        bool builtFrom(const Data* in_sourceVertices, const Data* in_sourceIndices) const;
+
+        /// return true if the TriangleBVH was built from the specified arrays and neither has been modified since
+        bool valid(const Data* in_sourceVertices, const Data* in_sourceIndices, uint32_t in_numVertices) const;
+
+        uint32_t numTriangles() const { return static_cast<uint32_t>(indices.size() / 3); }
+
+        /// get the TriangleBVH for the vertex and index arrays, building a new one if it's missing or out of date.
+        /// TriangleBVH are cached on the index array, or the vertex array if there are no indices, keyed by both arrays.
+        /// Each TriangleBVH is built once, only threads requesting the same TriangleBVH wait on the thread building it.
+        static ref_ptr<const TriangleBVH> getOrCreate(const ArrayState& arrayState, const Data* indices);
+
+        /// call hit(triangle) for each triangle that potentially intersects the line segment start to end.
+        /// The packet test is conservative so callers should still run their exact triangle test on the reported triangles.
+        template<class Hit>
+        void intersect(const dvec3& start, const dvec3& end, Hit hit) const
+        {
+            if (nodes.empty()) return;
+
+            dvec3 d = end - start;
+
+            uint32_t stack[64];
+            uint32_t stackSize = 0;
+            stack[stackSize++] = 0;
+
+            while (stackSize > 0)
+            {
+                const Node& node = nodes[stack[--stackSize]];
+                if (!intersects(node.bounds, start, d)) continue;
+
+                if (node.count == 0)
+                {
+                    // internal node, first child follows the parent
+                    stack[stackSize++] = node.first;
+                    stack[stackSize++] = static_cast<uint32_t>(&node - nodes.data()) + 1;
+                    continue;
+                }
+
+                for (uint32_t p = node.first; p < node.first + node.count; ++p)
+                {
+                    const Packet& packet = packets[p];
+
+                    bool mask[PacketSize];
+                    intersect(packet, start, d, mask);
+
+                    for (uint32_t i = 0; i < PacketSize; ++i)
+                    {
+                        if (mask[i]) hit(packet.triangles[i]);
+                    }
+                }
+            }
+        }
+
+    protected:
+        virtual ~TriangleBVH();
+
+        std::once_flag _built;
+
+        uint32_t _build(std::vector<uint32_t>& order, uint32_t begin, uint32_t end, const std::vector<box>& triangleBounds, const std::vector<vec3>& centers, const vec3Array& vertices);
+
+        static bool intersects(const box& bb, const dvec3& start, const dvec3& d);
+
+        /// test the line segment start to start+d against all the triangles in a packet
+        static void intersect(const Packet& packet, const dvec3& start, const dvec3& d, bool* mask)
+        {
+            const double epsilon = 1e-10;
+            const double tolerance = 1e-6;
+
+            for (uint32_t i = 0; i < PacketSize; ++i)
+            {
+                double e1x = packet.e1[0][i], e1y = packet.e1[1][i], e1z = packet.e1[2][i];
+                double e2x = packet.e2[0][i], e2y = packet.e2[1][i], e2z = packet.e2[2][i];
+                double tx = start.x - packet.v0[0][i], ty = start.y - packet.v0[1][i], tz = start.z - packet.v0[2][i];
+
+                // P = d x e2
+                double px = d.y * e2z - d.z * e2y;
+                double py = d.z * e2x - d.x * e2z;
+                double pz = d.x * e2y - d.y * e2x;
+
+                // Q = T x e1
+                double qx = ty * e1z - tz * e1y;
+                double qy = tz * e1x - tx * e1z;
+                double qz = tx * e1y - ty * e1x;
+
+                double det = px * e1x + py * e1y + pz * e1z;
+                double inv_det = (det > epsilon || det < -epsilon) ? 1.0 / det : 0.0;
+
+                double u = (px * tx + py * ty + pz * tz) * inv_det;
+                double v = (qx * d.x + qy * d.y + qz * d.z) * inv_det;
+                double t = (qx * e2x + qy * e2y + qz * e2z) * inv_det;
+
+                mask[i] = (inv_det != 0.0) && (u >= -tolerance) && (v >= -tolerance) && ((u + v) <= 1.0 + tolerance) && (t >= -tolerance) && (t <= 1.0 + tolerance);
+            }
+        }
+    };
+    VSG_type_name(vsg::TriangleBVH);
+
+} // namespace vsg
@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/core/Export.h>
 #include <vsg/nodes/Group.h>
+#include <vsg/traversals/TraversalStack.h>
 #include <vsg/viewer/Camera.h>
 #include <vsg/viewer/Window.h>
 #include <vsg/vk/CommandBuffer.h>
@@ -45,8 +46,22 @@ namespace vsg
         VkQueryControlFlags queryFlags = 0;
         VkQueryPipelineStatisticFlags pipelineStatistics = 0;
 
+        /// additional views culled and recorded in the same traversal as camera, additionalCameras[i] is view i+1.
+        /// Unless multiview is set each view records into its own CommandBuffer. For a secondary CommandGraph each view's CommandBuffer is passed on to the ExecuteCommands connected with that view index,
+        /// for a primary CommandGraph the views must be recorded beneath a RenderGraph, which begins and ends its render pass in each view's CommandBuffer, see RenderGraph::additionalRenderAreas.
+        std::vector<ref_ptr<Camera>> additionalCameras;
+
+        /// when set all views are recorded into the one CommandBuffer, for use with a multiview render pass, see RecordTraversal::multiview
+        bool multiview = false;
+
+        /// when set LOD children are selected using the first visible view and shared by all views, see RecordTraversal::shareLODSelection
+        bool shareLODSelection = false;
+
         ref_ptr<RecordTraversal> recordTraversal;
 
+        /// when assigned the scene graph is recorded iteratively using the TraversalStack rather than recursively, so very deep scene graphs don't overflow the call stack
+        ref_ptr<TraversalStack> traversalStack;
+
         void reset();
 
         virtual void record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameStamp> frameStamp = {}, ref_ptr<DatabasePager> databasePager = {});
@@ -54,12 +69,16 @@ namespace vsg
     protected:
         virtual ~CommandGraph();
 
-        void _connect(ExecuteCommands* executeCommand);
+        void _connect(ExecuteCommands* executeCommand, uint32_t viewIndex);
         void _disconnect(ExecuteCommands* executeCommand);
 
+        ref_ptr<CommandBuffer> _getOrCreateCommandBuffer(CommandBuffers& commandBuffers);
+        void _beginCommandBuffer(CommandBuffer& commandBuffer);
+
         CommandBuffers _commandBuffers; // assign one per index? Or just use round robin, each has a CommandPool
+        std::vector<CommandBuffers> _additionalViewCommandBuffers;
 
-        std::vector<ExecuteCommands*> _executeCommands;
+        std::vector<std::pair<ExecuteCommands*, uint32_t>> _executeCommands;
 
         friend ExecuteCommands;
     };
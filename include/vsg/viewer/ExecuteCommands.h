@@ -24,8 +24,8 @@ namespace vsg
     public:
         ExecuteCommands();
 
-        /// connect a second CommmandGraph that will provide the CommandBuffer each frame
-        void connect(ref_ptr<CommandGraph> commandGraph);
+        /// connect a second CommmandGraph that will provide the CommandBuffer each frame, viewIndex selects which of a multi view CommandGraph's views to execute
+        void connect(ref_ptr<CommandGraph> commandGraph, uint32_t viewIndex = 0);
 
         /// clean the internal cache of CommandBuffer and reset the Latch used to signal when all the connected CommandGraph have completed the recording of their CommandBuffer
         void reset();
@@ -15,6 +15,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/nodes/Group.h>
 
 #include <vsg/vk/CommandBuffer.h>
+#include <vsg/vk/DynamicUniformRing.h>
 
 #include <vsg/io/DatabasePager.h>
 
@@ -58,6 +59,12 @@ namespace vsg
 
         ref_ptr<DatabasePager> databasePager;
 
+        /// timeout in nanoseconds when waiting on the fences of previous submissions, by start() and when beginning the frame of the dynamicUniformRing.
+        uint64_t waitTimeout = std::numeric_limits<uint64_t>::max();
+
+        /// ring that dynamic uniform data is copied to while recording, begun each frame by record() with the submission's fence added by finish() so regions are only reused once the GPU has finished reading them.
+        ref_ptr<DynamicUniformRing> dynamicUniformRing;
+
     protected:
         size_t _currentFrameIndex;
         std::vector<size_t> _indices;
@@ -36,6 +36,11 @@ namespace vsg
 
         VkRect2D renderArea; // viewport dimensions
 
+        /// render areas of the RecordTraversal's additional views, additionalRenderAreas[i] is view i+1.
+        /// When the additional views record into their own primary CommandBuffers the render pass is begun and ended in each view's CommandBuffer,
+        /// using that view's render area, or renderArea if none is assigned, so that clearing is restricted to the view's region of the framebuffer.
+        std::vector<VkRect2D> additionalRenderAreas;
+
         //ref_ptr<RenderPass> renderPass;   // If not set, use window's.
 
         RenderPass* getRenderPass();
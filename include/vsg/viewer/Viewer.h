@@ -12,6 +12,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/io/Options.h>
 #include <vsg/threading/Barrier.h>
 #include <vsg/threading/FrameBlock.h>
 #include <vsg/traversals/CompileTraversal.h>
@@ -81,8 +82,14 @@ namespace vsg
         /// pass the Events into the any register EventHandlers
         virtual void handleEvents();
 
+        /// Options used by compile(..), when options->pipelineCacheFilename is set the PipelineCache is loaded from it on compile and saved to it when the Viewer is destroyed
+        ref_ptr<Options> options;
+
         virtual void compile(BufferPreferences bufferPreferences = {});
 
+        /// save the PipelineCache of each Device that has an associated filename, called automatically by the Viewer destructor
+        void savePipelineCaches() const;
+
         virtual bool acquireNextFrame();
 
         // Manage the work to do each frame uisng RecordAndSubmitTasks. thpse that need to present results to be wired up to respective Presentation object
@@ -106,6 +113,9 @@ namespace vsg
 
         virtual void present();
 
+        /// return the RecordStatistics of the most recently recorded frame, summed across all the CommandGraphs of all the RecordAndSubmitTasks
+        RecordStatistics getRecordStatistics() const;
+
         /// Call vkDeviceWaitIdle on all the devices associated with this Viewer
         void deviceWaitIdle() const;
 
@@ -126,6 +136,9 @@ namespace vsg
         bool _threading = false;
         ref_ptr<FrameBlock> _frameBlock;
         ref_ptr<Barrier> _submissionCompleted;
+
+        std::map<Device*, ref_ptr<PipelineCache>> _pipelineCaches;
+        std::map<Device*, ref_ptr<DynamicUniformRing>> _dynamicUniformRings;
     };
     VSG_type_name(vsg::Viewer);
 
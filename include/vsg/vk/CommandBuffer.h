@@ -46,6 +46,10 @@ namespace vsg
 
         ref_ptr<ScratchMemory> scratchMemory;
 
+        /// GeometryHeap::Block whose vertex and index buffers are currently bound, reset to nullptr by commands that bind other vertex/index buffers.
+        const Object* boundGeometryHeapBlock = nullptr;
+        uint32_t boundGeometryHeapFirstBinding = 0;
+
     protected:
         virtual ~CommandBuffer();
 
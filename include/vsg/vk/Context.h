@@ -22,10 +22,17 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/state/GraphicsPipeline.h>
 #include <vsg/vk/CommandPool.h>
 #include <vsg/vk/DescriptorPool.h>
+#include <vsg/vk/DescriptorPools.h>
+#include <vsg/vk/DynamicUniformRing.h>
 #include <vsg/vk/Fence.h>
+#include <vsg/vk/GeometryHeap.h>
 #include <vsg/vk/MemoryBufferPools.h>
+#include <vsg/vk/PipelineCache.h>
+#include <vsg/vk/StagingRing.h>
 
 #include <vsg/commands/Command.h>
+#include <vsg/commands/CopyAndReleaseBuffer.h>
+#include <vsg/commands/CopyAndReleaseImage.h>
 
 namespace vsg
 {
@@ -46,6 +53,9 @@ namespace vsg
         ref_ptr<Buffer> _scratchBuffer;
     };
 
+    /// create a timeline semaphore with the specified initial value, returns null if VK_KHR_timeline_semaphore isn't enabled on the Device.
+    extern VSG_DECLSPEC ref_ptr<Semaphore> createTimelineSemaphore(Device* device, VkPipelineStageFlags pipelineStageFlags, uint64_t initialValue = 0);
+
     class VSG_DECLSPEC Context
     {
     public:
@@ -73,9 +83,15 @@ namespace vsg
         // the scene graph .
         GraphicsPipelineStates overridePipelineStates;
 
+        // GraphicsPipeline.cpp, ComputePipeline.cpp and RayTracingPipeline.cpp
+        ref_ptr<PipelineCache> pipelineCache;
+
         // DescriptorSet.cpp
         ref_ptr<DescriptorPool> descriptorPool;
 
+        /// growable DescriptorPools used once descriptorPool is full, or when no descriptorPool is assigned, unique to each Context so that compile threads don't contend.
+        ref_ptr<DescriptorPools> descriptorPools;
+
         // transfer data settings
         ref_ptr<Queue> graphicsQueue;
         ref_ptr<CommandPool> commandPool;
@@ -84,16 +100,64 @@ namespace vsg
         ref_ptr<Semaphore> semaphore;
         ref_ptr<ScratchMemory> scratchMemory;
 
+        /// timeline semaphore signalled with timelineValue by each record(), used in place of semaphore when assigned so that submissions can wait on it without the binary semaphore's single wait restriction.
+        /// Requires VK_KHR_timeline_semaphore to be enabled, see createTimelineSemaphore(..).
+        ref_ptr<Semaphore> timelineSemaphore;
+        uint64_t timelineValue = 0;
+
+        /// dedicated transfer queue used for the batched buffer copies when both it and the timelineSemaphore are assigned,
+        /// and the MemoryBufferPools::concurrentQueueFamilyIndices include the graphicsQueue and transferQueue families, see sharedWithTransferQueue().
+        ref_ptr<Queue> transferQueue;
+        ref_ptr<CommandPool> transferCommandPool;
+        ref_ptr<CommandBuffer> transferCommandBuffer;
+
+        /// return true if the buffers of the device and staging MemoryBufferPools are shared concurrently by the graphicsQueue and transferQueue families.
+        bool sharedWithTransferQueue() const;
+
         std::vector<ref_ptr<Command>> commands;
 
+        /// CopyAndReleaseBuffer in commands that buffer transfers are batched into until the next record(), see createBufferAndTransferData(..)
+        ref_ptr<CopyAndReleaseBuffer> copyAndReleaseBuffer;
+
+        /// add a copy from the staging source to the destination to the copyAndReleaseBuffer batch, creating it if required.
+        /// The source is released once the copy has completed, unless it's a region of the stagingRing or releaseSource is false.
+        void copy(const BufferInfo& source, const BufferInfo& destination, bool releaseSource = true);
+
+        /// CopyAndReleaseImage in commands that image uploads are batched into until the next record(), see DescriptorImage::compile(..)
+        ref_ptr<CopyAndReleaseImage> copyAndReleaseImage;
+
+        /// add a copy from the staging source to the destination image to the copyAndReleaseImage batch, creating it if required.
+        void copy(const BufferInfo& source, const ImageInfo& destination, uint32_t mipLevels);
+
         void record();
         void waitForCompletion();
 
+        /// return true if there is no submission from record() still in progress, does not block.
+        bool completed() const;
+
         ref_ptr<CommandBuffer> getOrCreateCommandBuffer();
 
         ref_ptr<MemoryBufferPools> deviceMemoryBufferPools;
         ref_ptr<MemoryBufferPools> stagingMemoryBufferPools;
 
+        /// running total of the device memory reserved for buffers and images compiled with this Context, used by the DatabasePager to account for the memory of each PagedLOD's subgraph.
+        VkDeviceSize deviceMemoryReserved = 0;
+
+        /// persistently mapped ring buffer used as the source of uploads, unique to each Context as regions are retired when the Context's submission completes.
+        ref_ptr<StagingRing> stagingRing;
+
+        /// value returned by stagingRing->submit() for the last record(), passed to stagingRing->retire() once the submission has completed.
+        uint64_t stagingRingSubmission = 0;
+
+        /// return the stagingRing, creating it if required, returns null if BufferPreferences::stagingRingSize is 0.
+        ref_ptr<StagingRing> getOrCreateStagingRing();
+
+        /// shared vertex/index buffers used by VertexIndexDraw::compile(..), only assigned when BufferPreferences::useGeometryHeap is set.
+        ref_ptr<GeometryHeap> geometryHeap;
+
+        /// ring buffer that VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC DescriptorBuffer copy their data to each frame, assigned by Viewer::compile(..) when the scene graph contains them.
+        ref_ptr<DynamicUniformRing> dynamicUniformRing;
+
         // raytracing
         VkDeviceSize scratchBufferSize;
         std::vector<ref_ptr<BuildAccelerationStructureCommand>> buildAccelerationStructureCommands;
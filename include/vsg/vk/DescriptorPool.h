@@ -14,6 +14,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/vk/Device.h>
 
+#include <atomic>
+
 namespace vsg
 {
 
@@ -22,7 +24,7 @@ namespace vsg
     class VSG_DECLSPEC DescriptorPool : public Inherit<Object, DescriptorPool>
     {
     public:
-        DescriptorPool(Device* device, uint32_t maxSets, const DescriptorPoolSizes& descriptorPoolSizes);
+        DescriptorPool(Device* device, uint32_t maxSets, const DescriptorPoolSizes& descriptorPoolSizes, VkDescriptorPoolCreateFlags flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
         operator const VkDescriptorPool&() const { return _descriptorPool; }
 
@@ -31,10 +33,26 @@ namespace vsg
 
         std::mutex& getMutex() const { return _mutex; }
 
+        /// allocate a VkDescriptorSet from the pool, return VK_NULL_HANDLE if the pool doesn't have space for it.
+        VkDescriptorSet allocateDescriptorSet(VkDescriptorSetLayout descriptorSetLayout);
+
+        /// free a VkDescriptorSet allocated from this pool, the pool is reset once all of its descriptor sets have been freed.
+        void freeDescriptorSet(VkDescriptorSet descriptorSet);
+
+        uint32_t maxSets() const { return _maxSets; }
+
+        /// number of descriptor sets currently allocated from this pool
+        uint32_t numAllocatedSets() const { return _numAllocatedSets; }
+
+        /// return true if no more descriptor sets can be allocated from this pool
+        bool full() const { return _numAllocatedSets >= _maxSets; }
+
     protected:
         virtual ~DescriptorPool();
 
         VkDescriptorPool _descriptorPool;
+        uint32_t _maxSets = 0;
+        std::atomic_uint _numAllocatedSets = 0;
         ref_ptr<Device> _device;
         mutable std::mutex _mutex;
     };
@@ -0,0 +1,68 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/state/DescriptorSetLayout.h>
+#include <vsg/vk/DescriptorPool.h>
+
+#include <map>
+
+namespace vsg
+{
+
+    /// DescriptorPools manages lists of DescriptorPool, one list per descriptor set layout signature, creating new pools on demand so descriptor set allocation never fails due to pool exhaustion.
+    /// As all the sets in a pool share the same signature, sets freed when their DescriptorSet is released can always be reused by subsequent allocations.
+    /// Each Context has its own DescriptorPools so compile threads don't contend with each other when allocating.
+    class VSG_DECLSPEC DescriptorPools : public Inherit<Object, DescriptorPools>
+    {
+    public:
+        explicit DescriptorPools(Device* device);
+
+        /// number of descriptor sets the first DescriptorPool of a signature is sized for, each additional pool doubles in size up to maximumSetsPerPool.
+        uint32_t minimumSetsPerPool = 16;
+        uint32_t maximumSetsPerPool = 1024;
+
+        /// allocate a VkDescriptorSet for descriptorSetLayout, returning the DescriptorPool that it was allocated from.
+        ref_ptr<DescriptorPool> allocate(DescriptorSetLayout* descriptorSetLayout, VkDescriptorSet& descriptorSet);
+
+        /// destroy the DescriptorPools that have no descriptor sets allocated from them.
+        void releaseUnusedPools();
+
+        struct Statistics
+        {
+            uint32_t numPools = 0;
+            uint32_t maxSets = 0;
+            uint32_t numAllocatedSets = 0;
+        };
+
+        Statistics getStatistics() const;
+
+        Device* getDevice() { return _device; }
+        const Device* getDevice() const { return _device; }
+
+    protected:
+        virtual ~DescriptorPools();
+
+        /// number of descriptors of each type required by a descriptor set layout
+        using Signature = std::vector<std::pair<VkDescriptorType, uint32_t>>;
+        using Pools = std::vector<ref_ptr<DescriptorPool>>;
+
+        static Signature _signature(const DescriptorSetLayout* descriptorSetLayout);
+
+        ref_ptr<Device> _device;
+        mutable std::mutex _mutex;
+        std::map<std::pair<VkDescriptorPoolCreateFlags, Signature>, Pools> _signaturePools;
+    };
+    VSG_type_name(vsg::DescriptorPools);
+
+} // namespace vsg
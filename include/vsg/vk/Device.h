@@ -16,6 +16,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/vk/Queue.h>
 
 #include <list>
+#include <set>
+#include <string>
 
 namespace vsg
 {
@@ -54,6 +56,22 @@ namespace vsg
 
         ref_ptr<Queue> getQueue(uint32_t queueFamilyIndex, uint32_t queueIndex = 0);
 
+        /// return true if the extension was enabled when the Device was created
+        bool supportsDeviceExtension(const char* extensionName) const { return _enabledExtensions.count(extensionName) != 0; }
+
+        /// return true if queues of the queue family were requested when the Device was created
+        bool hasQueueFamily(uint32_t queueFamilyIndex) const { return _queueFamilyIndices.count(queueFamilyIndex) != 0; }
+
+        /// budget and current usage in bytes, summed over the device local memory heaps
+        struct MemoryBudget
+        {
+            VkDeviceSize budget = 0;
+            VkDeviceSize usage = 0;
+        };
+
+        /// return the device local MemoryBudget, using VK_EXT_memory_budget when enabled, otherwise the budget is the size of the device local heaps and the usage is 0.
+        MemoryBudget getDeviceLocalMemoryBudget() const;
+
     protected:
         virtual ~Device();
 
@@ -64,6 +82,8 @@ namespace vsg
         ref_ptr<AllocationCallbacks> _allocator;
 
         std::list<ref_ptr<Queue>> _queues;
+        std::set<std::string> _enabledExtensions;
+        std::set<uint32_t> _queueFamilyIndices;
     };
     VSG_type_name(vsg::Device);
 
@@ -15,13 +15,15 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/core/Array.h>
 #include <vsg/vk/Device.h>
 
-#include <map>
+#include <vector>
 
 namespace vsg
 {
     class Buffer;
     class Image;
 
+    /// MemorySlots manages the reservation of ranges within a fixed size block of memory.
+    /// Uses a two level segregated fit (TLSF) scheme, with bitmap indexed free lists, so that reserve(..) and release(..) are O(1) and the memory statistics are maintained as ranges are reserved and released.
     class VSG_DECLSPEC MemorySlots
     {
     public:
@@ -32,29 +34,72 @@ namespace vsg
 
         void release(VkDeviceSize offset, VkDeviceSize size);
 
-        bool full() const { return _availableMemory.empty(); }
+        bool full() const { return _totalAvailableSize == 0; }
 
-        VkDeviceSize maximumAvailableSpace() const { return _availableMemory.empty() ? 0 : _availableMemory.rbegin()->first; }
-        VkDeviceSize totalAvailableSize() const;
-        VkDeviceSize totalReservedSize() const;
+        VkDeviceSize maximumAvailableSpace() const;
+        VkDeviceSize totalAvailableSize() const { return _totalAvailableSize; }
+        VkDeviceSize totalReservedSize() const { return _totalReservedSize; }
         VkDeviceSize totalMemorySize() const { return _totalMemorySize; }
 
+        /// number of contiguous available ranges, a measure of fragmentation
+        size_t numAvailableBlocks() const { return _numAvailableBlocks; }
+        size_t numReservedBlocks() const { return _numReservedBlocks; }
+
+        /// offset and size of each reserved range, in offset order
+        using Ranges = std::vector<std::pair<VkDeviceSize, VkDeviceSize>>;
+        Ranges reservedRanges() const;
+
         void report() const;
         bool check() const;
 
     protected:
-        using SizeOffsets = std::multimap<VkDeviceSize, VkDeviceSize>;
-        using SizeOffset = SizeOffsets::value_type;
-        SizeOffsets _availableMemory;
+        static constexpr uint32_t INVALID_BLOCK = ~0u;
 
-        using OffsetSizes = std::map<VkDeviceSize, VkDeviceSize>;
-        using OffsetSize = OffsetSizes::value_type;
-        OffsetSizes _offsetSizes;
+        // each power of two size range is subdivided into 2^SECOND_LEVEL_BITS free lists
+        static constexpr uint32_t SECOND_LEVEL_BITS = 4;
+        static constexpr uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_BITS;
 
-        using OffsetAllocatedSlot = std::map<VkDeviceSize, OffsetSize>;
-        OffsetSizes _reservedOffsetSizes;
-
-        VkDeviceSize _totalMemorySize;
+        /// contiguous range of memory, either available or reserved, blocks are linked in offset order via previousPhysical/nextPhysical and available blocks are linked into their free list via previousFree/nextFree.
+        struct Block
+        {
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            uint32_t previousPhysical = INVALID_BLOCK;
+            uint32_t nextPhysical = INVALID_BLOCK;
+            uint32_t previousFree = INVALID_BLOCK;
+            uint32_t nextFree = INVALID_BLOCK;
+            bool available = false;
+        };
+
+        void mapping(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel) const;
+        uint32_t findAvailableBlock(VkDeviceSize size) const;
+        void insertAvailableBlock(uint32_t index);
+        void removeAvailableBlock(uint32_t index);
+
+        uint32_t createBlock();
+        void destroyBlock(uint32_t index);
+        uint32_t splitBlock(uint32_t index, VkDeviceSize size);
+
+        size_t reservedBlockHash(VkDeviceSize offset) const;
+        void insertReservedBlock(uint32_t index);
+        uint32_t removeReservedBlock(VkDeviceSize offset);
+
+        std::vector<Block> _blocks; // block 0 always starts at offset 0
+        uint32_t _unusedBlocks = INVALID_BLOCK; // destroyed Block entries, linked via nextFree, available for reuse
+
+        uint32_t _numFirstLevels = 0;
+        uint64_t _firstLevelBitmap = 0;
+        std::vector<uint32_t> _secondLevelBitmaps;
+        std::vector<uint32_t> _freeLists;
+        size_t _numAvailableBlocks = 0;
+
+        // open addressing hash table of reserved block indices, keyed by offset
+        std::vector<uint32_t> _reservedBlocks;
+        size_t _numReservedBlocks = 0;
+
+        VkDeviceSize _totalMemorySize = 0;
+        VkDeviceSize _totalAvailableSize = 0;
+        VkDeviceSize _totalReservedSize = 0;
     };
 
     class VSG_DECLSPEC DeviceMemory : public Inherit<Object, DeviceMemory>
@@ -0,0 +1,85 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/state/Buffer.h>
+#include <vsg/vk/Fence.h>
+
+#include <limits>
+#include <mutex>
+
+namespace vsg
+{
+
+    /// DynamicUniformRing is a persistently mapped, host visible buffer divided into a region for each frame in flight.
+    /// DescriptorBuffer of type VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC or VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC reference the ring's buffer and copy their data to the current frame's region as they are bound,
+    /// with BindDescriptorSets/BindDescriptorSet passing the resulting offsets as dynamic offsets, so per frame updates need neither additional buffers nor waits on the GPU.
+    /// Each DescriptorBuffer reserves space in every region when compiled so the regions can't overflow while recording.
+    /// A region is reused once the RecordAndSubmitTask fences of the submissions that last read from it have been signalled.
+    /// All methods are thread safe so the ring can be shared by RecordAndSubmitTask and CommandGraph recorded on different threads.
+    class VSG_DECLSPEC DynamicUniformRing : public Inherit<Object, DynamicUniformRing>
+    {
+    public:
+        DynamicUniformRing(Device* device, VkDeviceSize in_frameSize, uint32_t in_numFrames = 3);
+
+        /// size rounded up to the alignment required for dynamic offsets
+        VkDeviceSize alignedSize(VkDeviceSize size) const { return ((size + _alignment - 1) / _alignment) * _alignment; }
+
+        /// reserve size bytes, which must be aligned, in every frame's region, called by DescriptorBuffer::compile(..).
+        /// returns false if the regions don't have sufficient unreserved space, in which case the DescriptorBuffer uses its own buffers instead of the ring.
+        bool reserve(VkDeviceSize size);
+
+        /// release space previously reserved, called when DescriptorBuffer that use the ring are deleted.
+        void release(VkDeviceSize size);
+
+        /// start using the next frame's region, waiting on the fences of the submissions that last read from it, called by RecordAndSubmitTask with the FrameStamp's frameCount.
+        /// Subsequent calls with the same frameStampCount, from other RecordAndSubmitTask sharing the ring, continue to use the same region.
+        /// If waiting on a fence doesn't return VK_SUCCESS within the timeout the result is returned and the previous region remains current.
+        VkResult beginFrame(uint64_t frameStampCount, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+
+        /// add the fence of a submission reading from the current frame's region, called by RecordAndSubmitTask::finish().
+        void addFence(Fence* fence);
+
+        /// allocate size bytes from the current frame's region, aligned for use as a dynamic offset, setting dynamicOffset to its offset from the start of the buffer.
+        /// returns nullptr if the frame's region is full, which can only occur when more is allocated each frame than has been reserved.
+        void* allocate(VkDeviceSize size, uint32_t& dynamicOffset);
+
+        /// number of frames begun, used to detect the start of a new frame
+        uint64_t frameCount() const;
+        VkDeviceSize frameSize() const { return _frameSize; }
+        uint32_t numFrames() const { return _numFrames; }
+
+        Buffer* getBuffer() { return _buffer; }
+        const Buffer* getBuffer() const { return _buffer; }
+
+    protected:
+        virtual ~DynamicUniformRing();
+
+        ref_ptr<Buffer> _buffer;
+        ref_ptr<DeviceMemory> _deviceMemory;
+        uint8_t* _mappedData = nullptr;
+        VkDeviceSize _alignment;
+        VkDeviceSize _frameSize;
+        uint32_t _numFrames;
+
+        mutable std::mutex _mutex;
+        VkDeviceSize _reservedSize = 0;
+        uint64_t _frameCount = 0;
+        uint64_t _frameStampCount = 0;
+        uint32_t _currentFrame = 0;
+        VkDeviceSize _head = 0;
+        std::vector<std::vector<ref_ptr<Fence>>> _frameFences;
+    };
+    VSG_type_name(vsg::DynamicUniformRing);
+
+} // namespace vsg
@@ -43,6 +43,11 @@ namespace vsg
         PFN_vkCreateRayTracingPipelinesNV vkCreateRayTracingPipelinesNV;
         PFN_vkGetRayTracingShaderGroupHandlesNV vkGetRayTracingShaderGroupHandlesNV;
         PFN_vkCmdTraceRaysNV vkCmdTraceRaysNV;
+
+        // VK_KHR_descriptor_update_template, null when the extension isn't enabled on the Device
+        PFN_vkCreateDescriptorUpdateTemplateKHR vkCreateDescriptorUpdateTemplateKHR = nullptr;
+        PFN_vkDestroyDescriptorUpdateTemplateKHR vkDestroyDescriptorUpdateTemplateKHR = nullptr;
+        PFN_vkUpdateDescriptorSetWithTemplateKHR vkUpdateDescriptorSetWithTemplateKHR = nullptr;
     };
 
 } // namespace vsg
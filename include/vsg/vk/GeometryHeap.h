@@ -0,0 +1,93 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/state/BufferInfo.h>
+#include <vsg/vk/DeviceMemory.h>
+
+#include <mutex>
+
+namespace vsg
+{
+    // forward declare
+    class CommandBuffer;
+    class Context;
+
+    /// GeometryHeap sub-allocates the vertex arrays and indices of many geometries from shared device local buffers.
+    /// Geometries with the same vertex array strides and index type share a Block, with each array placed at the same vertex index in the block's per binding buffers,
+    /// so consecutive draws from the same Block only differ in their firstIndex/vertexOffset and don't need to rebind the vertex and index buffers.
+    /// Enabled by setting BufferPreferences::useGeometryHeap, as shaders that use gl_VertexIndex see the offset vertex index.
+    class VSG_DECLSPEC GeometryHeap : public Inherit<Object, GeometryHeap>
+    {
+    public:
+        GeometryHeap(uint32_t in_vertexCapacity = 256 * 1024, uint32_t in_indexCapacity = 1024 * 1024);
+
+        /// number of vertices/indices in each Block
+        const uint32_t vertexCapacity;
+        const uint32_t indexCapacity;
+
+        class VSG_DECLSPEC Block : public Inherit<Object, Block>
+        {
+        public:
+            Block(Context& context, const std::vector<uint32_t>& in_strides, VkIndexType in_indexType, uint32_t vertexCapacity, uint32_t indexCapacity);
+
+            const std::vector<uint32_t> strides;
+            const VkIndexType indexType;
+
+            BufferInfoList vertexBufferInfoList;
+            BufferInfo indexBufferInfo;
+
+            bool valid() const { return indexBufferInfo.buffer.valid(); }
+
+            bool reserve(uint32_t vertexCount, uint32_t indexCount, uint32_t& vertexBase, uint32_t& indexBase);
+            void release(uint32_t vertexBase, uint32_t indexBase);
+
+            /// bind the vertex and index buffers, unless they are already bound on the commandBuffer
+            void bind(CommandBuffer& commandBuffer, uint32_t firstBinding) const;
+
+        protected:
+            virtual ~Block();
+
+            std::mutex _mutex;
+            MemorySlots _vertexSlots;
+            MemorySlots _indexSlots;
+            uint32_t _deviceID;
+            std::vector<VkBuffer> _vkBuffers;
+            std::vector<VkDeviceSize> _offsets;
+        };
+
+        struct Allocation
+        {
+            ref_ptr<Block> block;
+            uint32_t vertexBase = 0;
+            uint32_t indexBase = 0;
+
+            explicit operator bool() const { return block.valid(); }
+        };
+
+        /// reserve space for the arrays and indices and add the transfer of the data to the context's commands.
+        /// Returns an invalid Allocation if the arrays don't all have the same number of vertices or are too large for a Block, in which case separate buffers should be used.
+        Allocation allocate(Context& context, const DataList& arrays, const Data* indices);
+
+        /// release the space reserved by allocate(..)
+        void release(Allocation& allocation);
+
+    protected:
+        virtual ~GeometryHeap();
+
+        std::mutex _mutex;
+        std::vector<ref_ptr<Block>> _blocks;
+    };
+    VSG_type_name(vsg::GeometryHeap);
+
+} // namespace vsg
@@ -17,6 +17,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vulkan/vulkan.h>
 
+#include <set>
+#include <string>
 #include <vector>
 
 namespace vsg
@@ -40,6 +42,9 @@ namespace vsg
         AllocationCallbacks* getAllocationCallbacks() { return _allocator.get(); }
         const AllocationCallbacks* getAllocationCallbacks() const { return _allocator.get(); }
 
+        /// return true if the extension was enabled when the Instance was created
+        bool supportsInstanceExtension(const char* extensionName) const { return _enabledExtensions.count(extensionName) != 0; }
+
         using PhysicalDevices = std::vector<ref_ptr<PhysicalDevice>>;
         PhysicalDevices& getPhysicalDevices() { return _physicalDevices; }
         const PhysicalDevices& getPhysicalDevices() const { return _physicalDevices; }
@@ -63,6 +68,7 @@ namespace vsg
         ref_ptr<AllocationCallbacks> _allocator;
 
         PhysicalDevices _physicalDevices;
+        std::set<std::string> _enabledExtensions;
     };
     VSG_type_name(vsg::Instance);
 
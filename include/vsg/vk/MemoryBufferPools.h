@@ -14,17 +14,61 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <deque>
 #include <memory>
+#include <mutex>
 
 #include <vsg/core/Object.h>
+#include <vsg/core/observer_ptr.h>
 #include <vsg/state/BufferInfo.h>
 
 namespace vsg
 {
+    // forward declare
+    class Context;
+    class CopyAndReleaseBuffer;
+    class DescriptorSet;
+
     struct BufferPreferences
     {
         VkDeviceSize minimumBufferSize = 16 * 1024 * 1024;
         VkDeviceSize minimumBufferDeviceMemorySize = 16 * 1024 * 1024;
         VkDeviceSize minimumImageDeviceMemorySize = 16 * 1024 * 1024;
+
+        /// size of the persistently mapped StagingRing used by each Context for uploads, 0 disables its use so staging buffers are reserved from the staging MemoryBufferPools.
+        VkDeviceSize stagingRingSize = 16 * 1024 * 1024;
+
+        /// sub-allocate the arrays and indices of VertexIndexDraw from the shared buffers of a GeometryHeap so that consecutive draws avoid rebinding,
+        /// off by default as gl_VertexIndex is offset by the vertex position in the heap.
+        bool useGeometryHeap = false;
+        uint32_t geometryHeapVertexCapacity = 256 * 1024;
+        uint32_t geometryHeapIndexCapacity = 1024 * 1024;
+
+        /// size of each frame's region of the DynamicUniformRing shared by the VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC and VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC DescriptorBuffer of a Device, 0 disables its use.
+        /// DescriptorBuffer that don't fit in the remaining space use their own buffers.
+        VkDeviceSize dynamicUniformRingFrameSize = 1024 * 1024;
+
+        /// Buffer blocks with less than this proportion of their size reserved are compacted by MemoryBufferPools::releaseUnusedMemory(context, ..), 0.0 disables compaction.
+        double compactionDensity = 0.25;
+
+        /// number of frames that the previous ranges and descriptor sets of relocated DescriptorSets are retained for, so frames already submitted can complete using them.
+        uint32_t compactionRetainFrames = 3;
+    };
+
+    /// statistics of the DeviceMemory or Buffer blocks of a MemoryBufferPools, used to monitor fragmentation
+    struct MemoryPoolStatistics
+    {
+        size_t numBlocks = 0;
+        size_t numUnusedBlocks = 0;
+        size_t numAvailableRanges = 0;
+        VkDeviceSize totalSize = 0;
+        VkDeviceSize reservedSize = 0;
+        VkDeviceSize availableSize = 0;
+        VkDeviceSize maximumAvailableSpace = 0;
+
+        /// 0.0 when all the available memory could be reserved as a single range, approaching 1.0 as the available memory is split into many small ranges
+        double fragmentation() const { return availableSize > 0 ? 1.0 - static_cast<double>(maximumAvailableSpace) / static_cast<double>(availableSize) : 0.0; }
+
+        /// proportion of the allocated memory that is reserved
+        double utilization() const { return totalSize > 0 ? static_cast<double>(reservedSize) / static_cast<double>(totalSize) : 0.0; }
     };
 
     class VSG_DECLSPEC MemoryBufferPools : public Inherit<Object, MemoryBufferPools>
@@ -43,11 +87,42 @@ namespace vsg
         using BufferPools = std::vector<ref_ptr<Buffer>>;
         BufferPools bufferPools;
 
+        /// when more than one queue family is assigned the Buffers are created with VK_SHARING_MODE_CONCURRENT across them, in place of the sharingMode passed to reserveBuffer(..),
+        /// so that ranges of the shared buffers can be written on a transfer queue and read on the graphics queue without queue family ownership transfers.
+        std::vector<uint32_t> concurrentQueueFamilyIndices;
+
         VkDeviceSize computeMemoryTotalAvailable() const;
         VkDeviceSize computeMemoryTotalReserved() const;
         VkDeviceSize computeBufferTotalAvailable() const;
         VkDeviceSize computeBufferTotalReserved() const;
 
+        MemoryPoolStatistics computeMemoryStatistics() const;
+        MemoryPoolStatistics computeBufferStatistics() const;
+
+        /// Release Buffer and DeviceMemory blocks that no longer contain any reserved ranges, retaining one unused block of each to avoid reallocating when paging.
+        /// maxBlocks limits the number of blocks released per call so the cost can be spread across frames. Returns the number of bytes of DeviceMemory released.
+        /// The remaining blocks are reordered most densely used first, so subsequent reservations favour dense blocks and sparsely used blocks can drain and be released by later calls.
+        VkDeviceSize releaseUnusedMemory(size_t maxBlocks = 4);
+
+        /// Release unused blocks as releaseUnusedMemory(maxBlocks), and incrementally compact the Buffer blocks used less than BufferPreferences::compactionDensity.
+        /// Each call starts the compaction of at most one block, copying its reserved ranges to free ranges of denser blocks with context.copy(..), so the caller must submit the context with context.record().
+        /// Once a later call finds that submission has completed, the BufferInfo of the registered DescriptorSets are updated to the new ranges and the DescriptorSets rewritten,
+        /// updateRelocations(..) then switches to the rewritten descriptor sets and releases the previous ranges. Only blocks whose reserved ranges are all referenced by
+        /// registered DescriptorSets are compacted, as ranges used in other ways, such as vertex arrays, can't be relocated. The ranges are copied rather than moved,
+        /// so writes made by the GPU to a range after the copy is submitted are lost, compaction should be disabled for pools with buffers written by shaders.
+        VkDeviceSize releaseUnusedMemory(Context& context, size_t maxBlocks = 4);
+
+        /// register a DescriptorSet so the ranges of the pools' Buffers that its DescriptorBuffer reference can be relocated by compaction, only an observer_ptr to the DescriptorSet is kept.
+        /// Called by DescriptorSet::compile(..).
+        void addRelocatable(DescriptorSet* descriptorSet);
+
+        /// switch the DescriptorSets rewritten by compaction to their new descriptor sets and release the ranges and descriptor sets relocated at least BufferPreferences::compactionRetainFrames frames ago.
+        /// Must be called between frames, when the DescriptorSets aren't being recorded, such as from DatabasePager::updateSceneGraph(..).
+        void updateRelocations(uint64_t frameCount);
+
+        /// return true if relocated ranges remain to be rewritten, switched or released
+        bool relocationsPending() const;
+
         BufferInfo reserveBuffer(VkDeviceSize totalSize, VkDeviceSize alignment, VkBufferUsageFlags bufferUsageFlags, VkSharingMode sharingMode, VkMemoryPropertyFlags memoryProperties);
 
         using DeviceMemoryOffset = std::pair<ref_ptr<DeviceMemory>, VkDeviceSize>;
@@ -57,6 +132,44 @@ namespace vsg
         using CopyQueue = std::deque<CopyPair>;
 
         CopyQueue bufferDataToCopy;
+
+    protected:
+        mutable std::mutex _mutex;
+
+        std::vector<observer_ptr<DescriptorSet>> _relocatables;
+
+        /// reserved range of a block being compacted and the range in another block its contents are copied to
+        struct Relocation
+        {
+            BufferInfo source;
+            BufferInfo destination;
+            bool adopted = false;
+        };
+
+        /// compaction of a Buffer block, progressing from Copying to Rewritten once the copies have completed, then to Switched by updateRelocations(..)
+        struct Compaction
+        {
+            enum Status
+            {
+                Copying,
+                Rewritten,
+                Switched
+            };
+
+            Status status = Copying;
+            ref_ptr<Buffer> buffer;
+            std::vector<Relocation> relocations;
+            observer_ptr<CopyAndReleaseBuffer> copies;
+            std::vector<ref_ptr<DescriptorSet>> descriptorSets;
+            std::vector<ref_ptr<Object>> previousDescriptorSets;
+            uint64_t switchFrameCount = 0;
+        };
+
+        std::vector<Compaction> _compactions;
+
+        bool _compacting(const Buffer* buffer) const;
+        void _rewriteRelocated(Context& context, Compaction& compaction);
+        bool _startCompaction(Context& context);
     };
 
 } // namespace vsg
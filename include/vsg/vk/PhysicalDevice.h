@@ -28,11 +28,23 @@ namespace vsg
         int getQueueFamily(VkQueueFlags queueFlags) const;
         std::pair<int, int> getQueueFamily(VkQueueFlags queueFlags, Surface* surface) const;
 
+        /// return the queue family that supports queueFlags but none of the excludedQueueFlags, preferring the family with the fewest other capabilities, -1 if there is none.
+        int getDedicatedQueueFamily(VkQueueFlags queueFlags, VkQueueFlags excludedQueueFlags = VK_QUEUE_GRAPHICS_BIT) const;
+
         using QueueFamilyProperties = std::vector<VkQueueFamilyProperties>;
         const QueueFamilyProperties& getQueueFamilyProperties() const { return _queueFamiles; }
 
         const VkPhysicalDeviceProperties& getProperties() const { return _properties; }
 
+        /// return true if the named device extension is supported by the physical device
+        bool supportsDeviceExtension(const char* extensionName) const;
+
+        /// fill in features2 and its pNext chain using vkGetPhysicalDeviceFeatures2KHR, return false if the Instance wasn't created with VK_KHR_get_physical_device_properties2.
+        bool getFeatures2(VkPhysicalDeviceFeatures2& features2) const;
+
+        /// fill in memoryProperties2 and its pNext chain using vkGetPhysicalDeviceMemoryProperties2KHR, return false if the Instance wasn't created with VK_KHR_get_physical_device_properties2.
+        bool getMemoryProperties2(VkPhysicalDeviceMemoryProperties2& memoryProperties2) const;
+
         template<typename FeatureStruct, VkStructureType type>
         FeatureStruct getFeatures() const
         {
@@ -76,6 +88,9 @@ namespace vsg
         VkPhysicalDeviceProperties _properties;
         QueueFamilyProperties _queueFamiles;
 
+        PFN_vkGetPhysicalDeviceFeatures2KHR _vkGetPhysicalDeviceFeatures2KHR = nullptr;
+        PFN_vkGetPhysicalDeviceMemoryProperties2KHR _vkGetPhysicalDeviceMemoryProperties2KHR = nullptr;
+
         vsg::observer_ptr<Instance> _instance;
     };
 
@@ -0,0 +1,70 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/FileSystem.h>
+#include <vsg/vk/Device.h>
+
+#include <mutex>
+
+namespace vsg
+{
+
+    /// PipelineCache encapsulates a VkPipelineCache that can be saved to file and loaded on subsequent runs so that pipelines don't need to be recompiled by the driver.
+    /// VkPipelineCache is internally synchronized so a single PipelineCache can be shared by all the threads compiling pipelines for a Device.
+    class VSG_DECLSPEC PipelineCache : public Inherit<Object, PipelineCache>
+    {
+    public:
+        /// create a VkPipelineCache, initialized with initialData when it's compatible with the device, see PipelineCache::compatible(..)
+        explicit PipelineCache(Device* device, const std::vector<uint8_t>& initialData = {});
+
+        /// create a PipelineCache for device, initialized from filename when the file exists and was written by the same device and driver version, otherwise an empty PipelineCache is created.
+        static ref_ptr<PipelineCache> load(Device* device, const Path& filename);
+
+        /// return filename with the vendorID, deviceID and pipelineCacheUUID of physicalDevice inserted before the extension,
+        /// so that the PipelineCaches of different devices sharing a filename don't overwrite each other, i.e. "pipelines.bin" becomes "pipelines_10de_2204_<uuid>.bin"
+        static Path deviceFilename(const Path& filename, const PhysicalDevice* physicalDevice);
+
+        /// save the contents of the PipelineCache to path, with a header recording the device and driver version so that stale files are rejected by load(..). Return true on success.
+        bool save(const Path& path) const;
+
+        /// return the current contents of the VkPipelineCache
+        std::vector<uint8_t> getData() const;
+
+        /// return true if the Vulkan pipeline cache header of data matches the vendorID, deviceID and pipelineCacheUUID of physicalDevice
+        static bool compatible(const PhysicalDevice* physicalDevice, const std::vector<uint8_t>& data);
+
+        /// file the PipelineCache was loaded from, used by Viewer to save the PipelineCache on exit.
+        Path filename;
+
+        /// return true if the PipelineCache was initialized with data from a previous run
+        bool initializedFromData() const { return _initializedFromData; }
+
+        operator VkPipelineCache() const { return _pipelineCache; }
+        VkPipelineCache vk() const { return _pipelineCache; }
+
+        Device* getDevice() { return _device; }
+        const Device* getDevice() const { return _device; }
+
+    protected:
+        virtual ~PipelineCache();
+
+        VkPipelineCache _pipelineCache = VK_NULL_HANDLE;
+        bool _initializedFromData = false;
+        ref_ptr<Device> _device;
+
+        mutable std::mutex _mutex;
+    };
+    VSG_type_name(vsg::PipelineCache);
+
+} // namespace vsg
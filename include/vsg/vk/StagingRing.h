@@ -0,0 +1,76 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/state/BufferInfo.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace vsg
+{
+
+    /// StagingRing is a persistently mapped, host visible ring buffer used as the source of transfers from host memory to device local buffers and images.
+    /// Regions are reserved by advancing a lock free head so the cost of an upload is a memcpy, and regions are retired once the submission that read them has completed.
+    /// Each Context has its own StagingRing, created on demand by Context::getOrCreateStagingRing(), with the size set by BufferPreferences::stagingRingSize.
+    class VSG_DECLSPEC StagingRing : public Inherit<Object, StagingRing>
+    {
+    public:
+        /// create a ring of in_size bytes, shared with VK_SHARING_MODE_CONCURRENT across the queueFamilyIndices when more than one is specified.
+        StagingRing(Device* device, VkDeviceSize in_size, const std::vector<uint32_t>& queueFamilyIndices = {});
+
+        /// reserve a region of the ring, returns an invalid BufferInfo if there isn't enough space available until earlier submissions have completed.
+        BufferInfo reserve(VkDeviceSize size, VkDeviceSize alignment);
+
+        /// reserve a region of the ring and copy the data to it, returns an invalid BufferInfo if there isn't enough space.
+        BufferInfo copy(const Data* data, VkDeviceSize alignment);
+
+        /// pointer to the mapped memory associated with the specified offset into the ring's buffer
+        void* dataPointer(VkDeviceSize offset) { return _mappedData + offset; }
+
+        /// mark the regions reserved so far as used by the submission about to be made, called by Context::record(). Returns the value identifying the submission to pass to retire().
+        uint64_t submit();
+
+        /// retire the regions used by the specified submission and all those made before it, in submission order, called by Context::waitForCompletion() once its fence has been signalled.
+        void retire(uint64_t submission);
+
+        /// return true if the buffer is the ring's, used to avoid releasing the ring's regions to the Buffer's MemorySlots as they are retired by the ring.
+        bool owns(const Buffer* buffer) const { return buffer == _buffer.get(); }
+
+        VkDeviceSize size() const { return _size; }
+        VkDeviceSize totalReservedSize() const { return _head.load() - _tail.load(); }
+
+        Buffer* getBuffer() { return _buffer; }
+        const Buffer* getBuffer() const { return _buffer; }
+
+    protected:
+        virtual ~StagingRing();
+
+        ref_ptr<Buffer> _buffer;
+        ref_ptr<DeviceMemory> _deviceMemory;
+        uint8_t* _mappedData = nullptr;
+        VkDeviceSize _size;
+
+        // head and tail are monotonically increasing positions, the offset into the buffer is the position modulo _size
+        std::atomic<uint64_t> _head{0};
+        std::atomic<uint64_t> _tail{0};
+
+        // head position at each submission still in flight, in submission order
+        std::mutex _mutex;
+        uint64_t _submissionCount = 0;
+        std::deque<std::pair<uint64_t, uint64_t>> _submissions;
+    };
+    VSG_type_name(vsg::StagingRing);
+
+} // namespace vsg
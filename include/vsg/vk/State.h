@@ -17,6 +17,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/state/ComputePipeline.h>
 #include <vsg/state/DescriptorSet.h>
 #include <vsg/state/GraphicsPipeline.h>
+#include <vsg/traversals/RecordStatistics.h>
 #include <vsg/vk/CommandBuffer.h>
 
 #include <array>
@@ -219,6 +220,8 @@ namespace vsg
 
         StateStacks stateStacks;
 
+        RecordStatistics statistics;
+
         MatrixStack projectionMatrixStack{0};
         MatrixStack modelviewMatrixStack{64};
 
@@ -253,9 +256,14 @@ namespace vsg
             {
                 for (auto& stateStack : stateStacks)
                 {
+                    if (stateStack.dirty) ++statistics.numStateCommandsRecorded;
+
                     stateStack.record(*_commandBuffer);
                 }
 
+                if (projectionMatrixStack.dirty) ++statistics.numPushConstants;
+                if (modelviewMatrixStack.dirty) ++statistics.numPushConstants;
+
                 projectionMatrixStack.record(*_commandBuffer);
                 modelviewMatrixStack.record(*_commandBuffer);
 
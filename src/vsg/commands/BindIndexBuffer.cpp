@@ -92,5 +92,7 @@ void BindIndexBuffer::compile(Context& context)
 void BindIndexBuffer::record(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
+
+    commandBuffer.boundGeometryHeapBlock = nullptr;
     vkCmdBindIndexBuffer(commandBuffer, vkd.bufferInfo.buffer->vk(commandBuffer.deviceID), vkd.bufferInfo.offset, vkd.indexType);
 }
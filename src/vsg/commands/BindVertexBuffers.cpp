@@ -84,5 +84,7 @@ void BindVertexBuffers::compile(Context& context)
 void BindVertexBuffers::record(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
+
+    commandBuffer.boundGeometryHeapBlock = nullptr;
     vkCmdBindVertexBuffers(commandBuffer, _firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
 }
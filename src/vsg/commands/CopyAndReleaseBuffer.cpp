@@ -13,19 +13,74 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/commands/CopyAndReleaseBuffer.h>
 #include <vsg/io/Options.h>
 
+#include <algorithm>
+
 using namespace vsg;
 
+CopyAndReleaseBuffer::CopyAndReleaseBuffer(BufferInfo src, BufferInfo dest)
+{
+    add(src, dest);
+}
+
 CopyAndReleaseBuffer::~CopyAndReleaseBuffer()
 {
-    source.release();
+    // release each staging range individually as merged regions may span several reserved ranges
+    for (auto& copyData : copies)
+    {
+        if (copyData.releaseSource) copyData.source.release();
+    }
+}
+
+void CopyAndReleaseBuffer::add(BufferInfo src, BufferInfo dest, bool releaseSource)
+{
+    copies.push_back(CopyData{src, dest, releaseSource});
 }
 
 void CopyAndReleaseBuffer::record(CommandBuffer& commandBuffer) const
 {
-    //std::cout<<"CopyAndReleaseBuffer::record(CommandBuffer& commandBuffer) source.offset = "<<source.offset<<", "<<destination.offset<<std::endl;
-    VkBufferCopy copyRegion = {};
-    copyRegion.srcOffset = source.offset;
-    copyRegion.dstOffset = destination.offset;
-    copyRegion.size = source.range;
-    vkCmdCopyBuffer(commandBuffer, source.buffer->vk(commandBuffer.deviceID), destination.buffer->vk(commandBuffer.deviceID), 1, &copyRegion);
+    if (copies.empty()) return;
+
+    // order the copies by source and destination buffer, retaining the order within each pair, so each pair can be recorded with a single vkCmdCopyBuffer
+    std::vector<const CopyData*> orderedCopies;
+    orderedCopies.reserve(copies.size());
+    for (auto& copyData : copies) orderedCopies.push_back(&copyData);
+
+    std::stable_sort(orderedCopies.begin(), orderedCopies.end(), [](const CopyData* lhs, const CopyData* rhs) {
+        if (lhs->source.buffer != rhs->source.buffer) return lhs->source.buffer.get() < rhs->source.buffer.get();
+        return lhs->destination.buffer.get() < rhs->destination.buffer.get();
+    });
+
+    std::vector<VkBufferCopy> regions;
+    regions.reserve(orderedCopies.size());
+
+    auto itr = orderedCopies.begin();
+    while (itr != orderedCopies.end())
+    {
+        const Buffer* source = (*itr)->source.buffer;
+        const Buffer* destination = (*itr)->destination.buffer;
+
+        regions.clear();
+        for (; itr != orderedCopies.end() && (*itr)->source.buffer == source && (*itr)->destination.buffer == destination; ++itr)
+        {
+            auto& copyData = *(*itr);
+            if (!regions.empty())
+            {
+                // merge with the previous region if both the source and destination ranges are contiguous
+                auto& previous = regions.back();
+                if ((previous.srcOffset + previous.size) == copyData.source.offset && (previous.dstOffset + previous.size) == copyData.destination.offset)
+                {
+                    previous.size += copyData.source.range;
+                    continue;
+                }
+            }
+
+            VkBufferCopy copyRegion = {};
+            copyRegion.srcOffset = copyData.source.offset;
+            copyRegion.dstOffset = copyData.destination.offset;
+            copyRegion.size = copyData.source.range;
+            regions.push_back(copyRegion);
+        }
+
+        vkCmdCopyBuffer(commandBuffer, source->vk(commandBuffer.deviceID), destination->vk(commandBuffer.deviceID), static_cast<uint32_t>(regions.size()), regions.data());
+    }
 }
@@ -11,9 +11,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/commands/CopyAndReleaseImage.h>
-#include <vsg/commands/PipelineBarrier.h>
 #include <vsg/io/Options.h>
 
+#include <algorithm>
+
 using namespace vsg;
 
 CopyAndReleaseImage::CopyAndReleaseImage(BufferInfo src, ImageInfo dest)
@@ -26,10 +27,19 @@ CopyAndReleaseImage::CopyAndReleaseImage(BufferInfo src, ImageInfo dest, uint32_
     add(src, dest, numMipMapLevels);
 }
 
+template<class T>
+static void releaseSources(std::vector<T>& copies)
+{
+    for (auto& copyData : copies)
+    {
+        if (copyData.releaseSource) copyData.source.release();
+    }
+}
+
 CopyAndReleaseImage::~CopyAndReleaseImage()
 {
-    for (auto& copyData : completed) copyData.source.release();
-    for (auto& copyData : pending) copyData.source.release();
+    releaseSources(completed);
+    releaseSources(pending);
 }
 
 void CopyAndReleaseImage::add(BufferInfo src, ImageInfo dest)
@@ -37,63 +47,104 @@ void CopyAndReleaseImage::add(BufferInfo src, ImageInfo dest)
     pending.push_back(CopyData{src, dest, vsg::computeNumMipMapLevels(src.data, dest.sampler)});
 }
 
-void CopyAndReleaseImage::add(BufferInfo src, ImageInfo dest, uint32_t numMipMapLevels)
+void CopyAndReleaseImage::add(BufferInfo src, ImageInfo dest, uint32_t numMipMapLevels, bool releaseSource)
 {
-    pending.push_back(CopyData{src, dest, numMipMapLevels});
+    pending.push_back(CopyData{src, dest, numMipMapLevels, releaseSource});
 }
 
-void CopyAndReleaseImage::CopyData::record(CommandBuffer& commandBuffer) const
+static VkImageMemoryBarrier imageMemoryBarrier(VkImage image, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t baseMipLevel, uint32_t levelCount)
 {
-    ref_ptr<Buffer> imageStagingBuffer(source.buffer);
-    ref_ptr<Data> data(source.data);
-    ref_ptr<Image> textureImage(destination.imageView->image);
-    VkImageLayout targetImageLayout = destination.imageLayout;
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = baseMipLevel;
+    barrier.subresourceRange.levelCount = levelCount;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
 
-    Data::Layout layout = data->getLayout();
-    auto mipmapOffsets = data->computeMipmapOffsets();
+void CopyAndReleaseImage::record(CommandBuffer& commandBuffer) const
+{
+    releaseSources(completed);
+    completed.clear();
 
-    bool useDataMipmaps = (mipLevels > 1) && (mipmapOffsets.size() > 1);
-    bool generatMipmaps = (mipLevels > 1) && (mipmapOffsets.size() <= 1);
+    if (pending.empty()) return;
 
-    uint32_t width = data->width() * layout.blockWidth;
-    uint32_t height = data->height() * layout.blockHeight;
-    uint32_t depth = data->depth() * layout.blockDepth;
+    auto deviceID = commandBuffer.deviceID;
 
-    auto vk_textureImage = textureImage->vk(commandBuffer.deviceID);
+    struct ImageCopy
+    {
+        const CopyData* copyData;
+        VkImage image;
+        uint32_t mipLevels;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        Data::MipmapOffsets mipmapOffsets;
+        bool generateMipmaps;
+    };
+
+    std::vector<ImageCopy> imageCopies;
+    imageCopies.reserve(pending.size());
+
+    uint32_t maxGeneratedMipLevels = 0;
+    for (auto& copyData : pending)
+    {
+        auto data = copyData.source.data.get();
+        Data::Layout layout = data->getLayout();
+
+        ImageCopy imageCopy;
+        imageCopy.copyData = &copyData;
+        imageCopy.image = copyData.destination.imageView->image->vk(deviceID);
+        imageCopy.mipLevels = std::max(copyData.mipLevels, 1u);
+        imageCopy.width = data->width() * layout.blockWidth;
+        imageCopy.height = data->height() * layout.blockHeight;
+        imageCopy.depth = data->depth() * layout.blockDepth;
+        imageCopy.mipmapOffsets = data->computeMipmapOffsets();
+        imageCopy.generateMipmaps = (imageCopy.mipLevels > 1) && (imageCopy.mipmapOffsets.size() <= 1);
+
+        if (imageCopy.generateMipmaps) maxGeneratedMipLevels = std::max(maxGeneratedMipLevels, imageCopy.mipLevels);
+
+        imageCopies.push_back(std::move(imageCopy));
+    }
 
-    // transfer the data.
-    if (useDataMipmaps)
+    // transition all the mip levels of all the images ready for the copies with a single barrier
+    std::vector<VkImageMemoryBarrier> barriers;
+    barriers.reserve(imageCopies.size() * 2);
+    for (auto& imageCopy : imageCopies)
     {
-        VkImageMemoryBarrier preCopyBarrier = {};
-        preCopyBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        preCopyBarrier.srcAccessMask = 0;
-        preCopyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        preCopyBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        preCopyBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        preCopyBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        preCopyBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        preCopyBarrier.image = vk_textureImage;
-        preCopyBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        preCopyBarrier.subresourceRange.baseArrayLayer = 0;
-        preCopyBarrier.subresourceRange.layerCount = 1;
-        preCopyBarrier.subresourceRange.levelCount = mipLevels;
-        preCopyBarrier.subresourceRange.baseMipLevel = 0;
+        barriers.push_back(imageMemoryBarrier(imageCopy.image, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, imageCopy.mipLevels));
+    }
 
-        vkCmdPipelineBarrier(commandBuffer,
-                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-                             0, nullptr,
-                             0, nullptr,
-                             1, &preCopyBarrier);
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr,
+                         0, nullptr,
+                         static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    // copy all the precomputed mip levels of each image with a single vkCmdCopyBufferToImage
+    std::vector<VkBufferImageCopy> regions;
+    for (auto& imageCopy : imageCopies)
+    {
+        auto& source = imageCopy.copyData->source;
+        auto valueSize = source.data->valueSize();
+
+        uint32_t numLevels = 1;
+        if (imageCopy.mipLevels > 1 && imageCopy.mipmapOffsets.size() > 1) numLevels = std::min(imageCopy.mipLevels, static_cast<uint32_t>(imageCopy.mipmapOffsets.size()));
 
-        uint32_t mipWidth = width;
-        uint32_t mipHeight = height;
-        uint32_t mipDepth = depth;
-        auto valueSize = data->valueSize();
-        for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel)
+        regions.clear();
+        for (uint32_t mipLevel = 0; mipLevel < numLevels; ++mipLevel)
         {
-            // std::cout<<"   level = "<<mipLevel<<", mipWidth = "<<mipWidth<<", mipHeight = "<<mipHeight<<std::endl;
             VkBufferImageCopy region = {};
-            region.bufferOffset = source.offset + mipmapOffsets[mipLevel] * valueSize;
+            region.bufferOffset = source.offset + imageCopy.mipmapOffsets[mipLevel] * valueSize;
             region.bufferRowLength = 0;
             region.bufferImageHeight = 0;
             region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -101,202 +152,82 @@ void CopyAndReleaseImage::CopyData::record(CommandBuffer& commandBuffer) const
             region.imageSubresource.baseArrayLayer = 0;
             region.imageSubresource.layerCount = 1;
             region.imageOffset = {0, 0, 0};
-            region.imageExtent = {mipWidth, mipHeight, mipDepth};
-
-            vkCmdCopyBufferToImage(commandBuffer, imageStagingBuffer->vk(commandBuffer.deviceID), vk_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-            if (mipWidth > 1) mipWidth /= 2;
-            if (mipHeight > 1) mipHeight /= 2;
-            if (mipDepth > 1) mipDepth /= 2;
+            region.imageExtent = {std::max(imageCopy.width >> mipLevel, 1u), std::max(imageCopy.height >> mipLevel, 1u), std::max(imageCopy.depth >> mipLevel, 1u)};
+            regions.push_back(region);
         }
 
-        VkImageMemoryBarrier postCopyBarrier = {};
-        postCopyBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        postCopyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        postCopyBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        postCopyBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        postCopyBarrier.newLayout = targetImageLayout;
-        postCopyBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        postCopyBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        postCopyBarrier.image = vk_textureImage;
-        postCopyBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        postCopyBarrier.subresourceRange.baseArrayLayer = 0;
-        postCopyBarrier.subresourceRange.layerCount = 1;
-        postCopyBarrier.subresourceRange.levelCount = mipLevels;
-        postCopyBarrier.subresourceRange.baseMipLevel = 0;
-
-        vkCmdPipelineBarrier(commandBuffer,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                             0, nullptr,
-                             0, nullptr,
-                             1, &postCopyBarrier);
+        vkCmdCopyBufferToImage(commandBuffer, source.buffer->vk(deviceID), imageCopy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
     }
-    else if (generatMipmaps)
+
+    // generate the mipmaps of the images without precomputed mipmaps a level at a time, so that each level needs just one barrier for all the images
+    for (uint32_t mipLevel = 1; mipLevel < maxGeneratedMipLevels; ++mipLevel)
     {
-        // generate mipmaps using Vulkan
-        VkImageMemoryBarrier preCopyBarrier = {};
-        preCopyBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        preCopyBarrier.srcAccessMask = 0;
-        preCopyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        preCopyBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        preCopyBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        preCopyBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        preCopyBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        preCopyBarrier.image = vk_textureImage;
-        preCopyBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        preCopyBarrier.subresourceRange.baseArrayLayer = 0;
-        preCopyBarrier.subresourceRange.layerCount = 1;
-        preCopyBarrier.subresourceRange.levelCount = mipLevels;
-        preCopyBarrier.subresourceRange.baseMipLevel = 0;
+        barriers.clear();
+        for (auto& imageCopy : imageCopies)
+        {
+            if (imageCopy.generateMipmaps && mipLevel < imageCopy.mipLevels)
+            {
+                barriers.push_back(imageMemoryBarrier(imageCopy.image, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mipLevel - 1, 1));
+            }
+        }
 
         vkCmdPipelineBarrier(commandBuffer,
-                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
                              0, nullptr,
                              0, nullptr,
-                             1, &preCopyBarrier);
-
-        VkBufferImageCopy region = {};
-        region.bufferOffset = source.offset;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, depth};
-
-        vkCmdCopyBufferToImage(commandBuffer, imageStagingBuffer->vk(commandBuffer.deviceID), vk_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        VkImageMemoryBarrier barrier = {};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.image = vk_textureImage;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
-
-        int32_t mipWidth = width;
-        int32_t mipHeight = height;
-        int32_t mipDepth = depth;
-
-        for (uint32_t i = 1; i < mipLevels; ++i)
+                             static_cast<uint32_t>(barriers.size()), barriers.data());
+
+        for (auto& imageCopy : imageCopies)
         {
-            barrier.subresourceRange.baseMipLevel = i - 1;
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-            vkCmdPipelineBarrier(commandBuffer,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-                                 0, nullptr,
-                                 0, nullptr,
-                                 1, &barrier);
+            if (!imageCopy.generateMipmaps || mipLevel >= imageCopy.mipLevels) continue;
+
+            int32_t srcWidth = std::max(imageCopy.width >> (mipLevel - 1), 1u);
+            int32_t srcHeight = std::max(imageCopy.height >> (mipLevel - 1), 1u);
+            int32_t srcDepth = std::max(imageCopy.depth >> (mipLevel - 1), 1u);
 
             VkImageBlit blit = {};
             blit.srcOffsets[0] = {0, 0, 0};
-            blit.srcOffsets[1] = {mipWidth, mipHeight, mipDepth};
+            blit.srcOffsets[1] = {srcWidth, srcHeight, srcDepth};
             blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.srcSubresource.mipLevel = i - 1;
+            blit.srcSubresource.mipLevel = mipLevel - 1;
             blit.srcSubresource.baseArrayLayer = 0;
             blit.srcSubresource.layerCount = 1;
             blit.dstOffsets[0] = {0, 0, 0};
-            blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, mipDepth > 1 ? mipDepth / 2 : 1};
+            blit.dstOffsets[1] = {srcWidth > 1 ? srcWidth / 2 : 1, srcHeight > 1 ? srcHeight / 2 : 1, srcDepth > 1 ? srcDepth / 2 : 1};
             blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.dstSubresource.mipLevel = i;
+            blit.dstSubresource.mipLevel = mipLevel;
             blit.dstSubresource.baseArrayLayer = 0;
             blit.dstSubresource.layerCount = 1;
 
             vkCmdBlitImage(commandBuffer,
-                           vk_textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                           vk_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           imageCopy.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           imageCopy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                            1, &blit,
                            VK_FILTER_LINEAR);
-
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.newLayout = targetImageLayout;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            vkCmdPipelineBarrier(commandBuffer,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                                 0, nullptr,
-                                 0, nullptr,
-                                 1, &barrier);
-
-            if (mipWidth > 1) mipWidth /= 2;
-            if (mipHeight > 1) mipHeight /= 2;
-            if (mipDepth > 1) mipDepth /= 2;
         }
-
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = targetImageLayout;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(commandBuffer,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                             0, nullptr,
-                             0, nullptr,
-                             1, &barrier);
     }
-    else
-    {
 
-        auto preCopyImageMemoryBarrier = ImageMemoryBarrier::create(
-            0, VK_ACCESS_TRANSFER_WRITE_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-            textureImage,
-            VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
-
-        auto preCopyPipelineBarrier = PipelineBarrier::create(
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-            0, preCopyImageMemoryBarrier);
-
-        preCopyPipelineBarrier->record(commandBuffer);
-
-        VkBufferImageCopy region = {};
-        region.bufferOffset = source.offset;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, depth};
-
-        vkCmdCopyBufferToImage(commandBuffer, imageStagingBuffer->vk(commandBuffer.deviceID), vk_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        auto postCopyImageBarrier = ImageMemoryBarrier::create(
-            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, targetImageLayout,
-            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-            textureImage,
-            VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
-
-        auto postPipelineBarrier = PipelineBarrier::create(
-            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            0, postCopyImageBarrier);
-
-        postPipelineBarrier->record(commandBuffer);
-    }
-}
-
-void CopyAndReleaseImage::record(CommandBuffer& commandBuffer) const
-{
-    for (auto& copyData : completed) copyData.source.release();
-    completed.clear();
-
-    for (auto& copyData : pending)
+    // transition all the images to their final layouts with a single barrier, the generated levels blitted from are in TRANSFER_SRC_OPTIMAL and the rest in TRANSFER_DST_OPTIMAL
+    barriers.clear();
+    for (auto& imageCopy : imageCopies)
     {
-        copyData.record(commandBuffer);
+        VkImageLayout targetImageLayout = imageCopy.copyData->destination.imageLayout;
+        if (imageCopy.generateMipmaps)
+        {
+            barriers.push_back(imageMemoryBarrier(imageCopy.image, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, targetImageLayout, 0, imageCopy.mipLevels - 1));
+            barriers.push_back(imageMemoryBarrier(imageCopy.image, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, targetImageLayout, imageCopy.mipLevels - 1, 1));
+        }
+        else
+        {
+            barriers.push_back(imageMemoryBarrier(imageCopy.image, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, targetImageLayout, 0, imageCopy.mipLevels));
+        }
     }
 
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr,
+                         0, nullptr,
+                         static_cast<uint32_t>(barriers.size()), barriers.data());
+
     pending.swap(completed);
 }
@@ -15,6 +15,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Options.h>
 #include <vsg/io/Output.h>
 
+#include <algorithm>
+
 using namespace vsg;
 
 void Data::read(Input& input)
@@ -95,3 +97,53 @@ std::size_t Data::computeValueCountIncludingMipmaps(std::size_t w, std::size_t h
 
     return lastPosition;
 }
+
+void Data::dirty(std::size_t offset, std::size_t size)
+{
+    ++_modifiedCount;
+
+    if (_dirtyRanges.size() >= maxNumDirtyRanges)
+    {
+        // discard the oldest range, anything copied before it was recorded will now need the whole data copied.
+        _wholeModifiedCount = _dirtyRanges.front().modifiedCount;
+        _dirtyRanges.erase(_dirtyRanges.begin());
+    }
+
+    _dirtyRanges.push_back(DirtyRange{_modifiedCount, offset, size});
+}
+
+bool Data::getDirtyRanges(uint32_t modifiedCount, DirtyRanges& ranges) const
+{
+    ranges.clear();
+
+    // compare ages relative to the current ModifiedCount so that wrap around of the counters is handled
+    uint32_t age = _modifiedCount - modifiedCount;
+    if (age > (_modifiedCount - _wholeModifiedCount)) return false;
+
+    for (auto& range : _dirtyRanges)
+    {
+        if (age > (_modifiedCount - range.modifiedCount)) ranges.push_back(range);
+    }
+
+    if (ranges.size() <= 1) return true;
+
+    std::sort(ranges.begin(), ranges.end(), [](const DirtyRange& lhs, const DirtyRange& rhs) { return lhs.offset < rhs.offset; });
+
+    // merge overlapping and adjacent ranges
+    auto merged = ranges.begin();
+    for (auto itr = ranges.begin() + 1; itr != ranges.end(); ++itr)
+    {
+        if (itr->offset <= merged->offset + merged->size)
+        {
+            merged->size = std::max(merged->offset + merged->size, itr->offset + itr->size) - merged->offset;
+            merged->modifiedCount = std::max(merged->modifiedCount, itr->modifiedCount);
+        }
+        else
+        {
+            *(++merged) = *itr;
+        }
+    }
+    ranges.erase(merged + 1, ranges.end());
+
+    return true;
+}
@@ -15,7 +15,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/threading/atomics.h>
 #include <vsg/ui/ApplicationEvent.h>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 using namespace vsg;
 
@@ -232,18 +234,23 @@ void DatabasePager::start()
 
         std::list<ref_ptr<CompileTraversal>> compileTraversals;
 
-        int numCompileContexts = 16;
+        // assign a timeline semaphore when supported, as unlike a binary semaphore it doesn't have to be waited on by a frame before the Context can signal it again
+        auto createCompileTraversal = [&compileTraversals, &db_ct]() {
+            ref_ptr<CompileTraversal> ct(new CompileTraversal(*db_ct));
+            ct->context.timelineSemaphore = createTimelineSemaphore(ct->context.device, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            if (!ct->context.timelineSemaphore) ct->context.semaphore = Semaphore::create(ct->context.device, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
 
-        for (int i = 0; i < numCompileContexts; ++i)
-        {
-            compileTraversals.emplace_back(new CompileTraversal(*db_ct));
-        }
+            compileTraversals.emplace_back(ct);
+        };
 
-        // assign semaphores
-        for (auto& ct : compileTraversals)
-        {
-            ct->context.semaphore = Semaphore::create(ct->context.device, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
-        }
+        // a CompileTraversal is available once its previous submission has completed, and when using a binary semaphore, the frame that waited on it has completed
+        auto available = [](CompileTraversal* ct) {
+            return ct->context.completed() && (!ct->context.semaphore || ct->context.semaphore->numDependentSubmissions().load() == 0);
+        };
+
+        // further CompileTraversal are created on demand, up to maxNumCompileTraversals, when all those in the list are still in use
+        uint32_t maxCompileTraversals = std::max(databasePager.maxNumCompileTraversals, 1u);
+        createCompileTraversal();
 
         auto compile_itr = compileTraversals.begin();
 
@@ -277,18 +284,30 @@ void DatabasePager::start()
 
             if (!nodesToCompile.empty())
             {
-                CompileTraversal* ct = compile_itr->get();
+                // select the next available CompileTraversal in the list, wrapping around if we get to the end,
+                // if all are still in use create another, or once maxNumCompileTraversals are in flight defer the tiles to a later iteration rather than blocking.
+                CompileTraversal* ct = nullptr;
+                for (size_t i = 0; i < compileTraversals.size() && !ct; ++i)
+                {
+                    CompileTraversal* candidate = compile_itr->get();
+
+                    ++compile_itr;
+                    if (compile_itr == compileTraversals.end()) compile_itr = compileTraversals.begin();
 
-                ++compile_itr;
-                // advance the compile iterator to the next CompileTraversal in the list, wrap around if we get to the end
-                if (compile_itr == compileTraversals.end())
+                    if (available(candidate)) ct = candidate;
+                }
+
+                if (!ct && compileTraversals.size() < maxCompileTraversals)
                 {
-                    // std::cout<<"Wrapping around"<<std::endl;
-                    compile_itr = compileTraversals.begin();
+                    createCompileTraversal();
+                    ct = compileTraversals.back().get();
                 }
-                else
+
+                if (!ct)
                 {
-                    // std::cout<<"Using next CompileTraversal"<<std::endl;
+                    compileQueue->add(nodesToCompile);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
                 }
 
 #if REPORT_STATS
@@ -302,6 +321,7 @@ void DatabasePager::start()
 #if DO_TIMING
                 auto before_wait_for_completion = clock::now();
 #endif
+                // previous submission has completed so clean up without blocking
                 ct->context.waitForCompletion();
 
 #if REPORT_STATS
@@ -318,12 +338,6 @@ void DatabasePager::start()
                 //std::cout<<"Compile Semaphore after wait Semaphore "<<*(ct->context.semaphore->data())<<" , count "<<ct->context.semaphore->numDependentSubmissions().load()<<std::endl;
 #endif
 
-                while (ct->context.semaphore->numDependentSubmissions().load() > 0)
-                {
-                    if (status->cancel()) return;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                }
-
 #if DO_TIMING
                 auto after_wait_and_semaphore = clock::now();
                 static double total_wait_time = 0.0;
@@ -334,7 +348,14 @@ void DatabasePager::start()
                 std::cout << "Fence + Semaphore wait : " << std::chrono::duration<double, std::chrono::milliseconds::period>(after_wait_and_semaphore - before_wait_for_completion).count() << " average = " << (total_wait_time / num_waits) << std::endl;
 #endif
 
-                ct->context.semaphore->numDependentSubmissions().exchange(1);
+                if (ct->context.semaphore) ct->context.semaphore->numDependentSubmissions().exchange(1);
+
+                // release memory blocks emptied by expired subgraphs, a few at a time to spread the cost across compiles.
+                ct->context.deviceMemoryBufferPools->releaseUnusedMemory();
+                ct->context.stagingMemoryBufferPools->releaseUnusedMemory();
+
+                // release descriptor pools whose sets have all been freed by expired subgraphs
+                if (ct->context.descriptorPools) ct->context.descriptorPools->releaseUnusedPools();
 
                 DatabaseQueue::Nodes nodesCompiled;
                 for (auto& plod : nodesToCompile)
@@ -355,7 +376,11 @@ void DatabasePager::start()
                             // compiling subgraph
                             if (subgraph)
                             {
+                                // record the device memory reserved by this compile so that it can be accounted for once merged,
+                                // assigned rather than accumulated as a PagedLOD is recompiled each time its subgraph is paged back in
+                                VkDeviceSize deviceMemoryReserved = ct->context.deviceMemoryReserved;
                                 subgraph->accept(*ct);
+                                plod->deviceMemorySize = ct->context.deviceMemoryReserved - deviceMemoryReserved;
                                 nodesCompiled.emplace_back(plod);
                             }
                             else
@@ -399,17 +424,31 @@ void DatabasePager::start()
 #endif
                 if (!nodesCompiled.empty())
                 {
+                    // compact sparsely used blocks here so the copies are submitted along with the compiled subgraphs
+                    ct->context.deviceMemoryBufferPools->releaseUnusedMemory(ct->context);
+
                     ct->context.record();
 
                     for (auto& plod : nodesCompiled)
                     {
-                        plod->semaphore = ct->context.semaphore;
+                        if (ct->context.timelineSemaphore)
+                        {
+                            if (ct->context.timelineValue > 0)
+                            {
+                                plod->semaphore = ct->context.timelineSemaphore;
+                                plod->semaphoreValue = ct->context.timelineValue;
+                            }
+                        }
+                        else
+                        {
+                            plod->semaphore = ct->context.semaphore;
+                        }
                         plod->requestStatus.exchange(PagedLOD::MergeRequest);
                     }
 
                     toMergeQueue->add(nodesCompiled);
                 }
-                else
+                else if (ct->context.semaphore)
                 {
                     ct->context.semaphore->numDependentSubmissions().exchange(0);
                 }
@@ -466,15 +505,37 @@ void DatabasePager::requestDiscarded(PagedLOD* plod)
     //std::scoped_lock<std::mutex> lock(pendingPagedLODMutex);
     //plod->pending = nullptr;
     plod->requestCount.exchange(0);
+    plod->deviceMemorySize = 0;
     plod->requestStatus.exchange(PagedLOD::NoRequest);
     --numActiveRequests;
 }
 
+VkDeviceSize DatabasePager::computeTargetPagedDeviceMemory() const
+{
+    if (deviceMemoryBudget > 0) return deviceMemoryBudget;
+
+    Device* device = compileTraversal ? compileTraversal->context.device.get() : nullptr;
+    if (deviceMemoryBudgetRatio <= 0.0 || !device) return std::numeric_limits<VkDeviceSize>::max();
+
+    // the usage is only known when VK_EXT_memory_budget is enabled, in which case the memory used outside the pager's MemoryBufferPools is deducted from the budget.
+    // The blocks held by the pools are deducted rather than pagedDeviceMemory, as expiring subgraphs returns their memory to the pools rather than the driver so doesn't reduce the reported usage.
+    auto memoryBudget = device->getDeviceLocalMemoryBudget();
+    VkDeviceSize limit = static_cast<VkDeviceSize>(static_cast<double>(memoryBudget.budget) * deviceMemoryBudgetRatio);
+    VkDeviceSize pooledMemory = compileTraversal->context.deviceMemoryBufferPools ? compileTraversal->context.deviceMemoryBufferPools->computeMemoryStatistics().totalSize : 0;
+    VkDeviceSize otherUsage = (memoryBudget.usage > pooledMemory) ? (memoryBudget.usage - pooledMemory) : 0;
+
+    return (limit > otherUsage) ? (limit - otherUsage) : 0;
+}
+
 void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
 {
     frameCount.exchange(frameStamp ? frameStamp->frameCount : 0);
 
+    // switch the DescriptorSets rewritten by compaction between frames, and release the relocated ranges no longer used by frames in flight
+    if (compileTraversal && compileTraversal->context.deviceMemoryBufferPools) compileTraversal->context.deviceMemoryBufferPools->updateRelocations(frameCount);
+
     _semaphores.clear();
+    _timelineSemaphores.clear();
 
     auto nodes = _toMergeQueue->take_all();
 
@@ -574,6 +635,19 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
 
         culledPagedLODs->clear();
 
+        auto expire = [&](PagedLODContainer::Element& element) {
+            if (compare_exchange(element.plod->requestStatus, PagedLOD::NoRequest, PagedLOD::DeleteRequest))
+            {
+                // std::cout<<"    trimming "<<plod<<std::endl;
+                ref_ptr<PagedLOD> plod = element.plod;
+                if (plod->getChild(0).node) pagedDeviceMemory -= std::min(pagedDeviceMemory, plod->deviceMemorySize);
+                plod->deviceMemorySize = 0;
+                plod->getChild(0).node = nullptr;
+                pagedLODContainer->remove(plod);
+                _compileQueue->add_then_reset(plod);
+            }
+        };
+
         // set the number of PagedLOD to expire
         uint32_t total = pagedLODContainer->activeList.count + pagedLODContainer->inactiveList.count;
         if ((nodes.size() + total) > targetMaxNumPagedLODWithHighResSubgraphs)
@@ -588,17 +662,31 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
                 auto& element = elements[index];
                 index = element.next;
 
-                if (compare_exchange(element.plod->requestStatus, PagedLOD::NoRequest, PagedLOD::DeleteRequest))
-                {
-                    // std::cout<<"    trimming "<<plod<<std::endl;
-                    ref_ptr<PagedLOD> plod = element.plod;
-                    plod->getChild(0).node = nullptr;
-                    pagedLODContainer->remove(plod);
-                    _compileQueue->add_then_reset(plod);
-                }
+                expire(element);
             }
         }
 
+        // expire the least recently used inactive high res subgraphs until the merged and to be merged subgraphs fit within the device memory budget,
+        // the budget is only queried every deviceMemoryBudgetQueryInterval frames as it's relatively costly and changes slowly
+        if (frameCount.load() >= _nextDeviceMemoryBudgetQueryFrame || frameCount.load() + deviceMemoryBudgetQueryInterval < _nextDeviceMemoryBudgetQueryFrame)
+        {
+            _targetPagedDeviceMemory = computeTargetPagedDeviceMemory();
+            _nextDeviceMemoryBudgetQueryFrame = frameCount.load() + std::max(deviceMemoryBudgetQueryInterval, 1u);
+        }
+        VkDeviceSize targetPagedDeviceMemory = _targetPagedDeviceMemory;
+        VkDeviceSize requiredDeviceMemory = pagedDeviceMemory;
+        for (auto& plod : nodes) requiredDeviceMemory += plod->deviceMemorySize;
+
+        for (uint32_t index = pagedLODContainer->inactiveList.head; (index != 0) && (requiredDeviceMemory > targetPagedDeviceMemory);)
+        {
+            auto& element = elements[index];
+            index = element.next;
+
+            VkDeviceSize previousPagedDeviceMemory = pagedDeviceMemory;
+            expire(element);
+            requiredDeviceMemory -= (previousPagedDeviceMemory - pagedDeviceMemory);
+        }
+
 #if 0
 
         unsigned int numOrhphanedPagedLOD = 0;
@@ -654,11 +742,22 @@ void DatabasePager::updateSceneGraph(FrameStamp* frameStamp)
                     plod->getChild(0).node = plod->pending;
                 }
 
+                pagedDeviceMemory += plod->deviceMemorySize;
+
                 // insert any semaphore into a set that will be used by the GraphicsStage
                 if (plod->semaphore)
                 {
-                    _semaphores.insert(plod->semaphore);
+                    if (plod->semaphoreValue > 0)
+                    {
+                        auto& value = _timelineSemaphores[plod->semaphore];
+                        value = std::max(value, plod->semaphoreValue);
+                    }
+                    else
+                    {
+                        _semaphores.insert(plod->semaphore);
+                    }
                     plod->semaphore = nullptr;
+                    plod->semaphoreValue = 0;
                 }
 
                 plod->requestStatus.exchange(PagedLOD::NoRequest);
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/ObjectCache.h>
 #include <vsg/io/Options.h>
 #include <vsg/io/ReaderWriter.h>
+#include <vsg/io/SharedObjects.h>
 #include <vsg/threading/OperationThreads.h>
 #include <vsg/utils/CommandLine.h>
 
@@ -32,7 +33,9 @@ Options::Options(const Options& options) :
     //    fileCache(options.fileCache),
     objectCache(options.objectCache),
     readerWriter(options.readerWriter),
-    operationThreads(options.operationThreads)
+    operationThreads(options.operationThreads),
+    sharedObjects(options.sharedObjects),
+    pipelineCacheFilename(options.pipelineCacheFilename)
 {
 }
 
@@ -0,0 +1,258 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/BinaryOutput.h>
+#include <vsg/io/Options.h>
+#include <vsg/io/SharedObjects.h>
+#include <vsg/state/ComputePipeline.h>
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/state/DescriptorSet.h>
+#include <vsg/state/GraphicsPipeline.h>
+#include <vsg/state/StateGroup.h>
+
+#include <sstream>
+
+using namespace vsg;
+
+namespace
+{
+    // serialize an object's contents to build its key, nested objects that are already shared are written by address rather than contents,
+    // so keys of pipelines are built from their shared layouts and shader stages without serializing the SPIR-V again.
+    class KeyOutput : public BinaryOutput
+    {
+    public:
+        KeyOutput(std::ostream& output, const std::unordered_set<const Object*>& sharedObjects) :
+            BinaryOutput(output),
+            _sharedObjects(sharedObjects)
+        {
+            version = vsgGetVersion();
+        }
+
+        void write(const Object* object) override
+        {
+            if (_sharedObjects.count(object) != 0)
+            {
+                uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object));
+                _output.write(reinterpret_cast<const char*>(&address), sizeof(address));
+            }
+            else
+            {
+                BinaryOutput::write(object);
+            }
+        }
+
+        using BinaryOutput::write;
+
+    protected:
+        const std::unordered_set<const Object*>& _sharedObjects;
+    };
+
+    // bottom up share the state objects referenced by StateCommands so that child objects are shared before the objects that reference them
+    class ShareState : public Visitor
+    {
+    public:
+        explicit ShareState(SharedObjects& in_sharedObjects) :
+            sharedObjects(in_sharedObjects) {}
+
+        SharedObjects& sharedObjects;
+
+        template<class T>
+        bool skip(ref_ptr<T>& object)
+        {
+            return !object || sharedObjects.contains(object.get());
+        }
+
+        void share(ref_ptr<Sampler>& sampler)
+        {
+            if (!skip(sampler)) sharedObjects.share(sampler);
+        }
+
+        void share(ref_ptr<DescriptorSetLayout>& layout)
+        {
+            if (!skip(layout)) sharedObjects.share(layout);
+        }
+
+        void share(ref_ptr<PipelineLayout>& layout)
+        {
+            if (skip(layout)) return;
+            for (auto& setLayout : layout->setLayouts) share(setLayout);
+            sharedObjects.share(layout);
+        }
+
+        void share(ref_ptr<ShaderStage>& stage)
+        {
+            if (skip(stage)) return;
+            if (stage->module && !sharedObjects.contains(stage->module.get())) sharedObjects.share(stage->module);
+            sharedObjects.share(stage);
+        }
+
+        void share(ref_ptr<GraphicsPipeline>& pipeline)
+        {
+            if (skip(pipeline)) return;
+            share(pipeline->layout);
+            for (auto& stage : pipeline->stages) share(stage);
+            sharedObjects.share(pipeline);
+        }
+
+        void share(ref_ptr<ComputePipeline>& pipeline)
+        {
+            if (skip(pipeline)) return;
+            share(pipeline->layout);
+            share(pipeline->stage);
+            sharedObjects.share(pipeline);
+        }
+
+        void share(ref_ptr<DescriptorSet>& descriptorSet)
+        {
+            if (!descriptorSet || !visited.insert(descriptorSet.get()).second) return;
+            share(descriptorSet->setLayout);
+            for (auto& descriptor : descriptorSet->descriptors)
+            {
+                if (auto descriptorImage = descriptor.cast<DescriptorImage>())
+                {
+                    for (auto& imageInfo : descriptorImage->imageInfoList) share(imageInfo.sampler);
+                }
+            }
+        }
+
+        void apply(Object& object) override
+        {
+            if (visited.insert(&object).second) object.traverse(*this);
+        }
+
+        void apply(StateGroup& stateGroup) override
+        {
+            if (!visited.insert(&stateGroup).second) return;
+            for (auto& stateCommand : stateGroup.getStateCommands()) stateCommand->accept(*this);
+            stateGroup.traverse(*this);
+        }
+
+        void apply(BindGraphicsPipeline& bindPipeline) override
+        {
+            share(bindPipeline.pipeline);
+        }
+
+        void apply(BindComputePipeline& bindPipeline) override
+        {
+            share(bindPipeline.pipeline);
+        }
+
+        void apply(BindDescriptorSets& bindDescriptorSets) override
+        {
+            share(bindDescriptorSets.layout);
+            for (auto& descriptorSet : bindDescriptorSets.descriptorSets) share(descriptorSet);
+        }
+
+        void apply(BindDescriptorSet& bindDescriptorSet) override
+        {
+            share(bindDescriptorSet.layout);
+            share(bindDescriptorSet.descriptorSet);
+        }
+
+        std::unordered_set<const Object*> visited;
+    };
+} // namespace
+
+SharedObjects::SharedObjects()
+{
+}
+
+SharedObjects::~SharedObjects()
+{
+}
+
+std::string SharedObjects::_key(const Object* object) const
+{
+    std::ostringstream stream;
+    KeyOutput output(stream, _sharedObjects);
+    output._write(std::string(object->className()));
+    object->write(output);
+    return stream.str();
+}
+
+ref_ptr<Object> SharedObjects::shareObject(ref_ptr<Object> object)
+{
+    if (!object) return object;
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_sharedObjects.count(object.get()) != 0) return object;
+
+    auto [itr, inserted] = _objects.emplace(_key(object.get()), object);
+    if (inserted)
+    {
+        _sharedObjects.insert(object.get());
+        ++_statistics.misses;
+    }
+    else
+    {
+        ++_statistics.hits;
+    }
+    return itr->second;
+}
+
+bool SharedObjects::contains(const Object* object) const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _sharedObjects.count(object) != 0;
+}
+
+void SharedObjects::shareState(Object& subgraph)
+{
+    ShareState shareState(*this);
+    subgraph.accept(shareState);
+}
+
+SharedObjects::Statistics SharedObjects::getStatistics() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+size_t SharedObjects::size() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _objects.size();
+}
+
+void SharedObjects::removeUnreferencedObjects()
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // repeat until no more objects are removed as removing a pipeline can leave its layout and shader stages unreferenced
+    bool removed = true;
+    while (removed)
+    {
+        removed = false;
+        for (auto itr = _objects.begin(); itr != _objects.end();)
+        {
+            if (itr->second->referenceCount() == 1)
+            {
+                _sharedObjects.erase(itr->second.get());
+                itr = _objects.erase(itr);
+                removed = true;
+            }
+            else
+            {
+                ++itr;
+            }
+        }
+    }
+}
+
+void SharedObjects::clear()
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    _objects.clear();
+    _sharedObjects.clear();
+    _statistics = {};
+}
@@ -12,6 +12,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/io/ObjectCache.h>
 #include <vsg/io/ReaderWriter_vsg.h>
+#include <vsg/io/SharedObjects.h>
 #include <vsg/io/read.h>
 
 #include <vsg/threading/OperationThreads.h>
@@ -20,7 +21,7 @@ using namespace vsg;
 
 ref_ptr<Object> vsg::read(const Path& filename, ref_ptr<const Options> options)
 {
-    auto read_file = [&]() -> ref_ptr<Object> {
+    auto read_object = [&]() -> ref_ptr<Object> {
         if (options && options->readerWriter)
         {
             auto object = options->readerWriter->read(filename, options);
@@ -39,6 +40,12 @@ ref_ptr<Object> vsg::read(const Path& filename, ref_ptr<const Options> options)
         }
     };
 
+    auto read_file = [&]() -> ref_ptr<Object> {
+        auto object = read_object();
+        if (object && options && options->sharedObjects) options->sharedObjects->shareState(*object);
+        return object;
+    };
+
     if (options && options->objectCache)
     {
         auto& ot = options->objectCache->getObjectTimepoint(filename, options);
@@ -147,6 +147,8 @@ void Geometry::record(CommandBuffer& commandBuffer) const
 
     VkCommandBuffer cmdBuffer{commandBuffer};
 
+    commandBuffer.boundGeometryHeapBlock = nullptr;
+
     vkCmdBindVertexBuffers(cmdBuffer, firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
 
     if (indices)
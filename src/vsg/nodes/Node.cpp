@@ -10,7 +10,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/io/Input.h>
 #include <vsg/io/Options.h>
+#include <vsg/io/Output.h>
 #include <vsg/nodes/Node.h>
 
 using namespace vsg;
@@ -23,3 +25,23 @@ Node::Node(Allocator* allocator) :
 Node::~Node()
 {
 }
+
+void Node::read(Input& input)
+{
+    Object::read(input);
+
+    if (input.version_greater_equal(0, 0, 3))
+    {
+        input.read("mask", mask);
+    }
+}
+
+void Node::write(Output& output) const
+{
+    Object::write(output);
+
+    if (output.version_greater_equal(0, 0, 3))
+    {
+        output.write("mask", mask);
+    }
+}
@@ -42,6 +42,7 @@ VertexIndexDraw::~VertexIndexDraw()
             }
         }
         if (vkd.bufferInfo.buffer) vkd.bufferInfo.buffer->release(vkd.bufferInfo.offset, vkd.bufferInfo.range);
+        if (vkd.geometryHeap) vkd.geometryHeap->release(vkd.heapAllocation);
     }
 }
 
@@ -100,12 +101,23 @@ void VertexIndexDraw::compile(Context& context)
     auto& vkd = _vulkanData[context.deviceID];
 
     // check to see if we've already been compiled
-    if (vkd.buffers.size() == arrays.size()) return;
+    if (vkd.buffers.size() == arrays.size() || vkd.heapAllocation) return;
 
     bool failure = false;
 
     vkd = {};
 
+    // share the vertex and index buffers with other VertexIndexDraw when a GeometryHeap is assigned, falling back to dedicated buffers when the arrays aren't suitable
+    if (context.geometryHeap)
+    {
+        vkd.heapAllocation = context.geometryHeap->allocate(context, arrays, indices);
+        if (vkd.heapAllocation)
+        {
+            vkd.geometryHeap = context.geometryHeap;
+            return;
+        }
+    }
+
     DataList dataList;
     dataList.reserve(arrays.size() + 1);
     dataList.insert(dataList.end(), arrays.begin(), arrays.end());
@@ -145,6 +157,16 @@ void VertexIndexDraw::record(CommandBuffer& commandBuffer) const
 
     VkCommandBuffer cmdBuffer{commandBuffer};
 
+    if (vkd.heapAllocation)
+    {
+        vkd.heapAllocation.block->bind(commandBuffer, firstBinding);
+
+        vkCmdDrawIndexed(cmdBuffer, indexCount, instanceCount, firstIndex + vkd.heapAllocation.indexBase, vertexOffset + vkd.heapAllocation.vertexBase, firstInstance);
+        return;
+    }
+
+    commandBuffer.boundGeometryHeapBlock = nullptr;
+
     vkCmdBindVertexBuffers(cmdBuffer, firstBinding, static_cast<uint32_t>(vkd.vkBuffers.size()), vkd.vkBuffers.data(), vkd.offsets.data());
 
     vkCmdBindIndexBuffer(cmdBuffer, vkd.bufferInfo.buffer->vk(commandBuffer.deviceID), vkd.bufferInfo.offset, vkd.indexType);
@@ -0,0 +1,251 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Exception.h>
+#include <vsg/io/Options.h>
+#include <vsg/state/BindlessTextures.h>
+#include <vsg/traversals/CompileTraversal.h>
+#include <vsg/vk/CommandBuffer.h>
+
+#include <algorithm>
+
+using namespace vsg;
+
+//////////////////////////////////////
+//
+// BindlessTextures
+//
+BindlessTextures::BindlessTextures(uint32_t in_maxTextures, uint32_t binding, VkShaderStageFlags stageFlags) :
+    maxTextures(in_maxTextures),
+    _imageInfos(in_maxTextures)
+{
+    descriptorSetLayout = DescriptorSetLayout::create(DescriptorSetLayoutBindings{{binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxTextures, stageFlags, nullptr}});
+    descriptorSetLayout->flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    descriptorSetLayout->bindingFlags = {VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT};
+
+    // hand out low indices first
+    _availableIndices.reserve(maxTextures);
+    for (uint32_t i = maxTextures; i > 0; --i) _availableIndices.push_back(i - 1);
+}
+
+BindlessTextures::~BindlessTextures()
+{
+}
+
+uint32_t BindlessTextures::add(const ImageInfo& imageInfo)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_availableIndices.empty())
+    {
+        throw Exception{"Error: BindlessTextures::add(..) no free texture indices.", VK_ERROR_OUT_OF_POOL_MEMORY};
+    }
+
+    uint32_t index = _availableIndices.back();
+    _availableIndices.pop_back();
+
+    _imageInfos[index] = imageInfo;
+
+    for (auto& implementation : _implementation)
+    {
+        if (implementation) implementation->_pendingWrites.push_back(index);
+    }
+
+    return index;
+}
+
+void BindlessTextures::remove(uint32_t index)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // the index may still be used by frames in flight, so defer reuse until releaseDelay frames have been recorded
+    _releasedIndices.emplace_back(_updateCount, index);
+}
+
+uint32_t BindlessTextures::numTextures() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return maxTextures - static_cast<uint32_t>(_availableIndices.size());
+}
+
+void BindlessTextures::compile(Context& context)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_implementation[context.deviceID]) return;
+
+    if (!context.device->supportsDeviceExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        throw Exception{"Error: BindlessTextures requires the VK_EXT_descriptor_indexing extension.", VK_ERROR_EXTENSION_NOT_PRESENT};
+    }
+
+    descriptorSetLayout->compile(context);
+
+    auto implementation = Implementation::create(context, descriptorSetLayout, maxTextures);
+
+    // write any textures added before this device was compiled
+    std::vector<bool> available(maxTextures, false);
+    for (auto index : _availableIndices) available[index] = true;
+    for (uint32_t index = 0; index < maxTextures; ++index)
+    {
+        if (!available[index] && _imageInfos[index]) implementation->_pendingWrites.push_back(index);
+    }
+
+    _implementation[context.deviceID] = implementation;
+}
+
+void BindlessTextures::update(uint32_t deviceID)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    ++_updateCount;
+
+    // make indices removed more than releaseDelay frames ago available for reuse
+    while (!_releasedIndices.empty() && (_releasedIndices.front().first + releaseDelay) <= _updateCount)
+    {
+        uint32_t index = _releasedIndices.front().second;
+        _releasedIndices.pop_front();
+
+        _imageInfos[index] = {};
+        _availableIndices.push_back(index);
+
+        for (auto& implementation : _implementation)
+        {
+            if (!implementation) continue;
+            auto& pendingWrites = implementation->_pendingWrites;
+            pendingWrites.erase(std::remove(pendingWrites.begin(), pendingWrites.end(), index), pendingWrites.end());
+        }
+    }
+
+    auto& implementation = _implementation[deviceID];
+    if (!implementation || implementation->_pendingWrites.empty()) return;
+
+    auto& pendingWrites = implementation->_pendingWrites;
+
+    std::vector<VkDescriptorImageInfo> imageInfos(pendingWrites.size());
+    std::vector<VkWriteDescriptorSet> descriptorWrites(pendingWrites.size());
+
+    const auto& binding = descriptorSetLayout->bindings.front();
+    for (size_t i = 0; i < pendingWrites.size(); ++i)
+    {
+        auto& imageInfo = _imageInfos[pendingWrites[i]];
+
+        VkDescriptorImageInfo& info = imageInfos[i];
+        info.sampler = imageInfo.sampler->vk(deviceID);
+        info.imageView = imageInfo.imageView->vk(deviceID);
+        info.imageLayout = imageInfo.imageLayout;
+
+        VkWriteDescriptorSet& wds = descriptorWrites[i];
+        wds = {};
+        wds.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        wds.dstSet = implementation->_descriptorSet;
+        wds.dstBinding = binding.binding;
+        wds.dstArrayElement = pendingWrites[i];
+        wds.descriptorCount = 1;
+        wds.descriptorType = binding.descriptorType;
+        wds.pImageInfo = &info;
+    }
+
+    // VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT allows the writes after the descriptor set has been bound, as long as it's before submission
+    vkUpdateDescriptorSets(*implementation->_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+    pendingWrites.clear();
+}
+
+BindlessTextures::Implementation::Implementation(Context& context, DescriptorSetLayout* descriptorSetLayout, uint32_t maxTextures) :
+    _device(context.device)
+{
+    DescriptorPoolSizes poolSizes{{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxTextures}};
+    _descriptorPool = DescriptorPool::create(_device, 1, poolSizes, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT | VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT);
+
+    _descriptorSet = _descriptorPool->allocateDescriptorSet(descriptorSetLayout->vk(context.deviceID));
+    if (!_descriptorSet)
+    {
+        throw Exception{"Error: Failed to allocate BindlessTextures DescriptorSet.", VK_ERROR_OUT_OF_POOL_MEMORY};
+    }
+}
+
+BindlessTextures::Implementation::~Implementation()
+{
+    if (_descriptorSet)
+    {
+        _descriptorPool->freeDescriptorSet(_descriptorSet);
+    }
+}
+
+//////////////////////////////////////
+//
+// BindBindlessTextures
+//
+BindBindlessTextures::BindBindlessTextures(ref_ptr<BindlessTextures> in_textures, ref_ptr<PipelineLayout> in_layout, uint32_t in_firstSet, VkPipelineBindPoint in_bindPoint) :
+    Inherit(1 + in_firstSet),
+    textures(in_textures),
+    layout(in_layout),
+    firstSet(in_firstSet),
+    pipelineBindPoint(in_bindPoint)
+{
+}
+
+BindBindlessTextures::~BindBindlessTextures()
+{
+}
+
+void BindBindlessTextures::compile(Context& context)
+{
+    layout->compile(context);
+    textures->compile(context);
+}
+
+void BindBindlessTextures::record(CommandBuffer& commandBuffer) const
+{
+    textures->update(commandBuffer.deviceID);
+
+    VkDescriptorSet descriptorSet = textures->vk(commandBuffer.deviceID);
+    vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout->vk(commandBuffer.deviceID), firstSet, 1, &descriptorSet, 0, nullptr);
+}
+
+//////////////////////////////////////
+//
+// BindlessTexture
+//
+BindlessTexture::BindlessTexture(ref_ptr<BindlessTextures> in_textures, const ImageInfo& in_imageInfo, VkShaderStageFlags in_stageFlags, uint32_t in_offset, uint32_t in_slot) :
+    Inherit(in_slot),
+    textures(in_textures),
+    imageInfo(in_imageInfo),
+    stageFlags(in_stageFlags),
+    offset(in_offset)
+{
+}
+
+BindlessTexture::~BindlessTexture()
+{
+    if (_index != INVALID_INDEX) textures->remove(_index);
+}
+
+void BindlessTexture::compile(Context& context)
+{
+    // reuse DescriptorImage to compile the sampler and image view and to schedule the transfer of the image data
+    if (!_descriptorImage) _descriptorImage = DescriptorImage::create(imageInfo);
+    _descriptorImage->compile(context);
+    imageInfo = _descriptorImage->imageInfoList.front();
+
+    textures->compile(context);
+
+    if (_index == INVALID_INDEX) _index = textures->add(imageInfo);
+}
+
+void BindlessTexture::record(CommandBuffer& commandBuffer) const
+{
+    if (_index == INVALID_INDEX) return;
+
+    vkCmdPushConstants(commandBuffer, commandBuffer.getCurrentPipelineLayout(), stageFlags, offset, sizeof(uint32_t), &_index);
+}
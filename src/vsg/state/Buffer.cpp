@@ -108,6 +108,11 @@ bool Buffer::compile(Device* device)
     bufferInfo.size = size;
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = sharingMode;
+    if (sharingMode == VK_SHARING_MODE_CONCURRENT)
+    {
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndices.size());
+        bufferInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+    }
 
     if (VkResult result = vkCreateBuffer(*device, &bufferInfo, device->getAllocationCallbacks(), &vd.buffer); result != VK_SUCCESS)
     {
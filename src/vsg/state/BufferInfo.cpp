@@ -16,6 +16,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/traversals/CompileTraversal.h>
 #include <vsg/vk/CommandBuffer.h>
 
+#include <algorithm>
+
 using namespace vsg;
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -32,19 +34,56 @@ void BufferInfo::copyDataToBuffer()
     }
 }
 
+static bool requiresCopy(BufferInfo& bufferInfo, uint32_t deviceID)
+{
+    if (!bufferInfo.buffer || !bufferInfo.data) return false;
+
+    // Data that has never been dirty()'d is copied every time as applications may modify it without updating the ModifiedCount,
+    // Data opts in to unmodified copies being skipped by calling dirty() or dirty(offset, size) whenever it's modified.
+    if (bufferInfo.data->getModifiedCount() == 0) return true;
+
+    auto& copyState = bufferInfo.copyState[deviceID];
+    return copyState.data != bufferInfo.data.get() || bufferInfo.data->differentModifiedCount(copyState.modifiedCount);
+}
+
+// copy the parts of the data modified since the last copy to ptr, the mapped memory associated with the start of the BufferInfo
+static void copyModifiedData(BufferInfo& bufferInfo, uint32_t deviceID, char* ptr)
+{
+    auto& copyState = bufferInfo.copyState[deviceID];
+    auto data = bufferInfo.data.get();
+    auto src = static_cast<const char*>(data->dataPointer());
+    auto dataSize = data->dataSize();
+
+    Data::DirtyRanges dirtyRanges;
+    if (copyState.data == data && data->getModifiedCount() != 0 && data->getDirtyRanges(copyState.modifiedCount, dirtyRanges))
+    {
+        for (auto& dirtyRange : dirtyRanges)
+        {
+            if (dirtyRange.offset >= dataSize) continue;
+            std::memcpy(ptr + dirtyRange.offset, src + dirtyRange.offset, std::min(dirtyRange.size, dataSize - dirtyRange.offset));
+        }
+    }
+    else
+    {
+        std::memcpy(ptr, src, dataSize);
+    }
+
+    copyState.data = data;
+    copyState.modifiedCount = data->getModifiedCount();
+}
+
 void BufferInfo::copyDataToBuffer(uint32_t deviceID)
 {
-    if (!buffer) return;
+    if (!requiresCopy(*this, deviceID)) return;
 
     DeviceMemory* dm = buffer->getDeviceMemory(deviceID);
     if (dm)
     {
-
+        // the Buffer may be bound at an offset within a DeviceMemory block shared with other Buffers
         void* buffer_data;
-        dm->map(offset, range, 0, &buffer_data);
+        dm->map(buffer->getMemoryOffset(deviceID) + offset, range, 0, &buffer_data);
 
-        char* ptr = reinterpret_cast<char*>(buffer_data);
-        std::memcpy(ptr, data->dataPointer(), data->dataSize());
+        copyModifiedData(*this, deviceID, reinterpret_cast<char*>(buffer_data));
 
         dm->unmap();
     }
@@ -61,6 +100,13 @@ BufferInfo vsg::copyDataToStagingBuffer(Context& context, const Data* data)
     VkDeviceSize imageTotalSize = data->dataSize();
 
     VkDeviceSize alignment = std::max(VkDeviceSize(4), VkDeviceSize(data->valueSize()));
+
+    // copy directly into the Context's persistently mapped ring when it has space available
+    if (auto stagingRing = context.getOrCreateStagingRing())
+    {
+        if (auto ringBufferInfo = stagingRing->copy(data, alignment); ringBufferInfo.buffer) return ringBufferInfo;
+    }
+
     BufferInfo stagingBufferInfo = context.stagingMemoryBufferPools->reserveBuffer(imageTotalSize, alignment, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
     stagingBufferInfo.data = const_cast<Data*>(data);
 
@@ -130,6 +176,7 @@ BufferInfoList vsg::createBufferAndTransferData(Context& context, const DataList
     VkBufferUsageFlags bufferUsageFlags = VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
 
     BufferInfo deviceBufferInfo = context.deviceMemoryBufferPools->reserveBuffer(totalSize, alignment, bufferUsageFlags, sharingMode, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (deviceBufferInfo.buffer) context.deviceMemoryReserved += totalSize;
 
     //std::cout<<"deviceBufferInfo.buffer "<<deviceBufferInfo.buffer.get()<<", "<<deviceBufferInfo.offset<<", "<<deviceBufferInfo.range<<")"<<std::endl;
 
@@ -140,21 +187,36 @@ BufferInfoList vsg::createBufferAndTransferData(Context& context, const DataList
         bufferData.offset += deviceBufferInfo.offset;
     }
 
-    BufferInfo stagingBufferInfo = context.stagingMemoryBufferPools->reserveBuffer(totalSize, alignment, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, sharingMode, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    //std::cout<<"stagingBufferInfo.buffer "<<stagingBufferInfo.buffer.get()<<", "<<stagingBufferInfo.offset<<", "<<stagingBufferInfo.range<<")"<<std::endl;
+    BufferInfo stagingBufferInfo;
+    ref_ptr<DeviceMemory> stagingMemory;
+    char* ptr = nullptr;
 
-    ref_ptr<Buffer> stagingBuffer(stagingBufferInfo.buffer);
-    ref_ptr<DeviceMemory> stagingMemory(stagingBuffer->getDeviceMemory(context.deviceID));
+    // use the Context's persistently mapped ring when it has space available, otherwise fallback to reserving and mapping a staging buffer
+    auto stagingRing = context.getOrCreateStagingRing();
+    if (stagingRing) stagingBufferInfo = stagingRing->reserve(totalSize, alignment);
 
-    if (!stagingMemory)
+    if (stagingBufferInfo.buffer)
     {
-        return BufferInfoList();
+        ptr = static_cast<char*>(stagingRing->dataPointer(stagingBufferInfo.offset));
     }
+    else
+    {
+        stagingBufferInfo = context.stagingMemoryBufferPools->reserveBuffer(totalSize, alignment, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, sharingMode, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        //std::cout<<"stagingBufferInfo.buffer "<<stagingBufferInfo.buffer.get()<<", "<<stagingBufferInfo.offset<<", "<<stagingBufferInfo.range<<")"<<std::endl;
+
+        ref_ptr<Buffer> stagingBuffer(stagingBufferInfo.buffer);
+        stagingMemory = stagingBuffer->getDeviceMemory(context.deviceID);
+
+        if (!stagingMemory)
+        {
+            return BufferInfoList();
+        }
 
-    void* buffer_data;
-    stagingMemory->map(stagingBuffer->getMemoryOffset(context.deviceID) + stagingBufferInfo.offset, stagingBufferInfo.range, 0, &buffer_data);
-    char* ptr = reinterpret_cast<char*>(buffer_data);
+        void* buffer_data;
+        stagingMemory->map(stagingBuffer->getMemoryOffset(context.deviceID) + stagingBufferInfo.offset, stagingBufferInfo.range, 0, &buffer_data);
+        ptr = reinterpret_cast<char*>(buffer_data);
+    }
 
     //std::cout<<"    buffer_data " <<buffer_data<<", stagingBufferInfo.offset="<<stagingBufferInfo.offset<<", "<<totalSize<< std::endl;
 
@@ -164,25 +226,11 @@ BufferInfoList vsg::createBufferAndTransferData(Context& context, const DataList
         std::memcpy(ptr + bufferInfoList[i].offset - deviceBufferInfo.offset, data->dataPointer(), data->dataSize());
     }
 
-    stagingMemory->unmap();
+    if (stagingMemory) stagingMemory->unmap();
 
-#if 0 // merging of ByfferDataCommands caused problems with later release of individual parts of the buffers copied, so removing this optimization
-    CopyAndReleaseBufferInfoCommand* previous = context.copyBufferInfoCommands.empty() ? nullptr : context.copyBufferInfoCommands.back().get();
-    if (previous)
-    {
-        bool sourceMatched = (previous->source._buffer == stagingBufferInfo.buffer) && ((previous->source.offset + previous->source.range) == stagingBufferInfo.offset);
-        bool destinationMatched = (previous->destination._buffer == deviceBufferInfo.buffer) && ((previous->destination.offset + previous->destination.range) == deviceBufferInfo.offset);
-
-        if (sourceMatched && destinationMatched)
-        {
-            //std::cout<<"Source matched = "<<sourceMatched<<" destinationMatched = "<<destinationMatched<<std::endl;
-            previous->source.range += stagingBufferInfo.range;
-            previous->destination.range += stagingBufferInfo.range;
-            return bufferInfoList;
-        }
-    }
-#endif
-    context.commands.emplace_back(CopyAndReleaseBuffer::create(stagingBufferInfo, deviceBufferInfo));
+    // batch the copies so that all the transfers between the same staging and device buffers are recorded with a single vkCmdCopyBuffer,
+    // CopyAndReleaseBuffer releases each staging range individually.
+    context.copy(stagingBufferInfo, deviceBufferInfo);
 
     return bufferInfoList;
 }
@@ -224,10 +272,60 @@ BufferInfoList vsg::createHostVisibleBuffer(Device* device, const DataList& data
     return bufferInfoList;
 }
 
-void vsg::copyDataListToBuffers(Device* device, BufferInfoList& bufferInfoList)
+void vsg::copyDataListToBuffers(uint32_t deviceID, BufferInfoList& bufferInfoList)
 {
-    for (auto& bufferData : bufferInfoList)
+    // position of a modified BufferInfo's range within the DeviceMemory its Buffer is bound to
+    struct MemoryRange
+    {
+        DeviceMemory* deviceMemory;
+        VkDeviceSize offset;
+        BufferInfo* bufferInfo;
+    };
+
+    std::vector<MemoryRange> modified;
+    for (auto& bufferInfo : bufferInfoList)
+    {
+        if (!requiresCopy(bufferInfo, deviceID)) continue;
+
+        if (auto dm = bufferInfo.buffer->getDeviceMemory(deviceID))
+        {
+            modified.push_back(MemoryRange{dm, bufferInfo.buffer->getMemoryOffset(deviceID) + bufferInfo.offset, &bufferInfo});
+        }
+    }
+
+    if (modified.empty()) return;
+
+    // group the ranges by DeviceMemory so that each DeviceMemory is mapped just once, even when shared by several Buffers
+    std::sort(modified.begin(), modified.end(), [](const MemoryRange& lhs, const MemoryRange& rhs) {
+        return (lhs.deviceMemory < rhs.deviceMemory) || (lhs.deviceMemory == rhs.deviceMemory && lhs.offset < rhs.offset);
+    });
+
+    for (auto first = modified.begin(); first != modified.end();)
     {
-        bufferData.copyDataToBuffer(device->deviceID);
+        auto dm = first->deviceMemory;
+        VkDeviceSize start = first->offset;
+        VkDeviceSize end = start;
+
+        auto last = first;
+        for (; last != modified.end() && last->deviceMemory == dm; ++last)
+        {
+            end = std::max(end, last->offset + last->bufferInfo->range);
+        }
+
+        void* buffer_data;
+        dm->map(start, end - start, 0, &buffer_data);
+
+        char* ptr = reinterpret_cast<char*>(buffer_data);
+        for (; first != last; ++first)
+        {
+            copyModifiedData(*(first->bufferInfo), deviceID, ptr + (first->offset - start));
+        }
+
+        dm->unmap();
     }
 }
+
+void vsg::copyDataListToBuffers(Device* device, BufferInfoList& bufferInfoList)
+{
+    copyDataListToBuffers(device->deviceID, bufferInfoList);
+}
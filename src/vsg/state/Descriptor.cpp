@@ -15,6 +15,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/traversals/CompileTraversal.h>
 #include <vsg/vk/CommandBuffer.h>
 
+#include <cstring>
+
 using namespace vsg;
 
 Descriptor::Descriptor(uint32_t in_dstBinding, uint32_t in_dstArrayElement, VkDescriptorType in_descriptorType) :
@@ -48,3 +50,16 @@ void Descriptor::assignTo(Context& /*context*/, VkWriteDescriptorSet& wds) const
     wds.dstArrayElement = dstArrayElement;
     wds.descriptorType = descriptorType;
 }
+
+void Descriptor::assignToTemplateData(Context& context, void* data) const
+{
+    VkWriteDescriptorSet wds;
+    assignTo(context, wds);
+
+    if (wds.pImageInfo)
+        std::memcpy(data, wds.pImageInfo, wds.descriptorCount * sizeof(VkDescriptorImageInfo));
+    else if (wds.pBufferInfo)
+        std::memcpy(data, wds.pBufferInfo, wds.descriptorCount * sizeof(VkDescriptorBufferInfo));
+    else if (wds.pTexelBufferView)
+        std::memcpy(data, wds.pTexelBufferView, wds.descriptorCount * sizeof(VkBufferView));
+}
@@ -10,11 +10,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/core/Exception.h>
 #include <vsg/io/Options.h>
 #include <vsg/state/DescriptorBuffer.h>
 #include <vsg/traversals/CompileTraversal.h>
 #include <vsg/vk/CommandBuffer.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 using namespace vsg;
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +58,27 @@ DescriptorBuffer::DescriptorBuffer(const BufferInfoList& in_bufferInfoList, uint
 
 DescriptorBuffer::~DescriptorBuffer()
 {
+    _releaseBuffers();
+}
+
+void DescriptorBuffer::_releaseBuffers()
+{
+    if (dynamicUniformRing)
+    {
+        // the ring's buffer isn't sub-allocated so just return the reserved space to the ring
+        dynamicUniformRing->release(_dynamicUniformRingReservedSize);
+        dynamicUniformRing = {};
+        _dynamicUniformRingReservedSize = 0;
+
+        for (auto& bufferInfo : bufferInfoList)
+        {
+            bufferInfo.buffer = nullptr;
+            bufferInfo.offset = 0;
+            bufferInfo.range = 0;
+        }
+        return;
+    }
+
     for (auto& bufferInfo : bufferInfoList)
     {
         bufferInfo.release();
@@ -61,10 +87,7 @@ DescriptorBuffer::~DescriptorBuffer()
 
 void DescriptorBuffer::read(Input& input)
 {
-    for (auto& bufferInfo : bufferInfoList)
-    {
-        bufferInfo.release();
-    }
+    _releaseBuffers();
 
     Descriptor::read(input);
 
@@ -99,6 +122,34 @@ void DescriptorBuffer::compile(Context& context)
         if (bufferInfo.buffer == nullptr) requiresAssingmentOfBuffers = true;
     }
 
+    if (requiresAssingmentOfBuffers && getNumDynamicOffsets() > 0 && context.dynamicUniformRing && !dynamicUniformRing)
+    {
+        // reserve space for the data in each of the ring's regions, if the ring is full fall back to the descriptor's own buffers
+        VkDeviceSize reservedSize = 0;
+        for (auto& bufferInfo : bufferInfoList)
+        {
+            if (bufferInfo.data) reservedSize += context.dynamicUniformRing->alignedSize(bufferInfo.data->dataSize());
+        }
+
+        if (context.dynamicUniformRing->reserve(reservedSize))
+        {
+            // the descriptor references the start of the ring's buffer, with the dynamic offsets selecting where each frame's copy of the data resides
+            dynamicUniformRing = context.dynamicUniformRing;
+            _dynamicUniformRingReservedSize = reservedSize;
+            for (auto& bufferInfo : bufferInfoList)
+            {
+                bufferInfo.buffer = dynamicUniformRing->getBuffer();
+                bufferInfo.offset = 0;
+                bufferInfo.range = bufferInfo.data ? bufferInfo.data->dataSize() : 0;
+            }
+            _dynamicOffsets.resize(bufferInfoList.size());
+            _dynamicOffsetsFrameCount = std::numeric_limits<uint64_t>::max();
+        }
+    }
+
+    // data is copied to the dynamicUniformRing as the descriptor is bound
+    if (dynamicUniformRing) return;
+
     if (requiresAssingmentOfBuffers)
     {
         VkDeviceSize alignment = 4;
@@ -135,11 +186,14 @@ void DescriptorBuffer::compile(Context& context)
 
     if (needToCopyDataToBuffer)
     {
+        // newly created VkBuffer need all their data copied
         for (auto& bufferInfo : bufferInfoList)
         {
-            bufferInfo.copyDataToBuffer(context.deviceID);
+            bufferInfo.copyState[context.deviceID] = {};
         }
     }
+
+    vsg::copyDataListToBuffers(context.deviceID, bufferInfoList);
 }
 
 void DescriptorBuffer::assignTo(Context& context, VkWriteDescriptorSet& wds) const
@@ -161,6 +215,18 @@ void DescriptorBuffer::assignTo(Context& context, VkWriteDescriptorSet& wds) con
     }
 }
 
+void DescriptorBuffer::assignToTemplateData(Context& context, void* data) const
+{
+    auto pBufferInfo = reinterpret_cast<VkDescriptorBufferInfo*>(data);
+    for (auto& bufferInfo : bufferInfoList)
+    {
+        VkDescriptorBufferInfo& info = *(pBufferInfo++);
+        info.buffer = bufferInfo.buffer->vk(context.deviceID);
+        info.offset = bufferInfo.offset;
+        info.range = bufferInfo.range;
+    }
+}
+
 uint32_t DescriptorBuffer::getNumDescriptors() const
 {
     return static_cast<uint32_t>(bufferInfoList.size());
@@ -168,8 +234,52 @@ uint32_t DescriptorBuffer::getNumDescriptors() const
 
 void DescriptorBuffer::copyDataListToBuffers()
 {
+    // data is copied to the dynamicUniformRing as the descriptor is bound
+    if (dynamicUniformRing) return;
+
+    uint32_t numDevices = 0;
     for (auto& bufferInfo : bufferInfoList)
     {
-        bufferInfo.copyDataToBuffer();
+        if (bufferInfo.buffer) numDevices = std::max(numDevices, bufferInfo.buffer->sizeVulkanData());
     }
+
+    for (uint32_t deviceID = 0; deviceID < numDevices; ++deviceID)
+    {
+        vsg::copyDataListToBuffers(deviceID, bufferInfoList);
+    }
+}
+
+uint32_t DescriptorBuffer::getNumDynamicOffsets() const
+{
+    if (descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) return static_cast<uint32_t>(bufferInfoList.size());
+    return 0;
+}
+
+void DescriptorBuffer::recordDynamicOffsets(uint32_t* dynamicOffsets)
+{
+    if (!dynamicUniformRing)
+    {
+        for (uint32_t i = 0; i < getNumDynamicOffsets(); ++i) dynamicOffsets[i] = 0;
+        return;
+    }
+
+    std::scoped_lock<std::mutex> lock(_dynamicOffsetsMutex);
+
+    if (uint64_t frameCount = dynamicUniformRing->frameCount(); _dynamicOffsetsFrameCount != frameCount)
+    {
+        _dynamicOffsetsFrameCount = frameCount;
+        for (size_t i = 0; i < bufferInfoList.size(); ++i)
+        {
+            auto& bufferInfo = bufferInfoList[i];
+            if (!bufferInfo.data) continue;
+
+            // the space was reserved by compile(..), so the allocation only fails if the ring is misused
+            void* ptr = dynamicUniformRing->allocate(bufferInfo.range, _dynamicOffsets[i]);
+            if (!ptr) throw Exception{"Error: DescriptorBuffer::recordDynamicOffsets() allocation from DynamicUniformRing exceeded its reserved space."};
+
+            std::memcpy(ptr, bufferInfo.data->dataPointer(), std::min(bufferInfo.range, VkDeviceSize(bufferInfo.data->dataSize())));
+        }
+    }
+
+    std::copy(_dynamicOffsets.begin(), _dynamicOffsets.end(), dynamicOffsets);
 }
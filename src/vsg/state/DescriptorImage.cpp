@@ -176,7 +176,7 @@ void DescriptorImage::compile(Context& context)
                     auto stagingBufferInfo = copyDataToStagingBuffer(context, image->data);
                     if (stagingBufferInfo)
                     {
-                        context.commands.emplace_back(new CopyAndReleaseImage(stagingBufferInfo, imageData, image->mipLevels));
+                        context.copy(stagingBufferInfo, imageData, image->mipLevels);
                     }
                 }
             }
@@ -215,6 +215,18 @@ void DescriptorImage::assignTo(Context& context, VkWriteDescriptorSet& wds) cons
     }
 }
 
+void DescriptorImage::assignToTemplateData(Context& context, void* data) const
+{
+    auto pImageInfo = reinterpret_cast<VkDescriptorImageInfo*>(data);
+    for (auto& imageInfo : imageInfoList)
+    {
+        VkDescriptorImageInfo& info = *(pImageInfo++);
+        info.sampler = imageInfo.sampler ? imageInfo.sampler->vk(context.deviceID) : VK_NULL_HANDLE;
+        info.imageView = imageInfo.imageView ? imageInfo.imageView->vk(context.deviceID) : VK_NULL_HANDLE;
+        info.imageLayout = imageInfo.imageLayout;
+    }
+}
+
 uint32_t DescriptorImage::getNumDescriptors() const
 {
     return static_cast<uint32_t>(imageInfoList.size());
@@ -12,14 +12,50 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/core/Exception.h>
 #include <vsg/io/Options.h>
+#include <vsg/state/DescriptorBuffer.h>
 #include <vsg/state/DescriptorSet.h>
 #include <vsg/traversals/CompileTraversal.h>
 #include <vsg/vk/CommandBuffer.h>
 
+#include <algorithm>
+
 using namespace vsg;
 
 #define USE_MUTEX 0
 
+// append the DescriptorBuffer that require dynamic offsets, sorted by binding as vkCmdBindDescriptorSets expects the offsets of each set in binding order
+static void collectDynamicDescriptorBuffers(const DescriptorSet& descriptorSet, std::vector<DescriptorBuffer*>& dynamicDescriptorBuffers, uint32_t& numDynamicOffsets)
+{
+    auto first = dynamicDescriptorBuffers.size();
+    for (auto& descriptor : descriptorSet.descriptors)
+    {
+        if (auto descriptorBuffer = descriptor->cast<DescriptorBuffer>(); descriptorBuffer && descriptorBuffer->getNumDynamicOffsets() > 0)
+        {
+            dynamicDescriptorBuffers.push_back(descriptorBuffer);
+            numDynamicOffsets += descriptorBuffer->getNumDynamicOffsets();
+        }
+    }
+
+    std::sort(dynamicDescriptorBuffers.begin() + first, dynamicDescriptorBuffers.end(), [](const DescriptorBuffer* lhs, const DescriptorBuffer* rhs) {
+        return (lhs->dstBinding < rhs->dstBinding) || (lhs->dstBinding == rhs->dstBinding && lhs->dstArrayElement < rhs->dstArrayElement);
+    });
+}
+
+// fill in the dynamic offsets using the CommandBuffer's scratch memory, the caller releases the scratch memory once the offsets have been recorded
+static uint32_t* recordDynamicOffsets(CommandBuffer& commandBuffer, const std::vector<DescriptorBuffer*>& dynamicDescriptorBuffers, uint32_t numDynamicOffsets)
+{
+    if (numDynamicOffsets == 0) return nullptr;
+
+    auto dynamicOffsets = commandBuffer.scratchMemory->allocate<uint32_t>(numDynamicOffsets);
+    auto ptr = dynamicOffsets;
+    for (auto& descriptorBuffer : dynamicDescriptorBuffers)
+    {
+        descriptorBuffer->recordDynamicOffsets(ptr);
+        ptr += descriptorBuffer->getNumDynamicOffsets();
+    }
+    return dynamicOffsets;
+}
+
 DescriptorSet::DescriptorSet()
 {
 }
@@ -68,30 +104,62 @@ void DescriptorSet::compile(Context& context)
         if (setLayout) setLayout->compile(context);
         for (auto& descriptor : descriptors) descriptor->compile(context);
 
-#if USE_MUTEX
-        std::scoped_lock<std::mutex> lock(context.descriptorPool->getMutex());
-#endif
-        _implementation[context.deviceID] = DescriptorSet::Implementation::create(context.device, context.descriptorPool, setLayout);
+        _implementation[context.deviceID] = DescriptorSet::Implementation::create(context, setLayout);
         _implementation[context.deviceID]->assign(context, descriptors);
+
+        // DescriptorBuffer that reference ranges of the device MemoryBufferPools may be relocated when the pools are compacted
+        if (context.deviceMemoryBufferPools) context.deviceMemoryBufferPools->addRelocatable(this);
     }
 }
 
+void DescriptorSet::rewrite(Context& context)
+{
+    // descriptor sets not yet compiled are written with the current descriptors when compiled
+    if (!_implementation[context.deviceID]) return;
+
+    auto implementation = DescriptorSet::Implementation::create(context, setLayout);
+    implementation->assign(context, descriptors);
+    _rewrittenImplementation[context.deviceID] = implementation;
+}
+
+ref_ptr<Object> DescriptorSet::switchToRewrite(uint32_t deviceID)
+{
+    auto& rewritten = _rewrittenImplementation[deviceID];
+    if (!rewritten) return {};
+
+    ref_ptr<Object> previous(_implementation[deviceID]);
+    _implementation[deviceID] = rewritten;
+    rewritten = {};
+    return previous;
+}
+
 DescriptorSet::Implementation::Implementation(Device* device, DescriptorPool* descriptorPool, DescriptorSetLayout* descriptorSetLayout) :
     _device(device),
     _descriptorPool(descriptorPool),
     _descriptorSetLayout(descriptorSetLayout)
 {
-    VkDescriptorSetLayout vkdescriptorSetLayout = descriptorSetLayout->vk(device->deviceID);
+    _descriptorSet = descriptorPool->allocateDescriptorSet(descriptorSetLayout->vk(device->deviceID));
+    if (!_descriptorSet)
+    {
+        throw Exception{"Error: Failed to create DescriptorSet.", VK_ERROR_OUT_OF_POOL_MEMORY};
+    }
+}
 
-    VkDescriptorSetAllocateInfo descriptSetAllocateInfo = {};
-    descriptSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    descriptSetAllocateInfo.descriptorPool = *descriptorPool;
-    descriptSetAllocateInfo.descriptorSetCount = 1;
-    descriptSetAllocateInfo.pSetLayouts = &vkdescriptorSetLayout;
+DescriptorSet::Implementation::Implementation(Context& context, DescriptorSetLayout* descriptorSetLayout) :
+    _device(context.device),
+    _descriptorSetLayout(descriptorSetLayout)
+{
+    // the shared descriptorPool isn't created with VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT so can only be used for regular layouts
+    if (context.descriptorPool && (descriptorSetLayout->flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT) == 0)
+    {
+        _descriptorSet = context.descriptorPool->allocateDescriptorSet(descriptorSetLayout->vk(context.deviceID));
+        if (_descriptorSet) _descriptorPool = context.descriptorPool;
+    }
 
-    if (VkResult result = vkAllocateDescriptorSets(*device, &descriptSetAllocateInfo, &_descriptorSet); result != VK_SUCCESS)
+    if (!_descriptorSet)
     {
-        throw Exception{"Error: Failed to create DescriptorSet.", result};
+        if (!context.descriptorPools) context.descriptorPools = DescriptorPools::create(context.device);
+        _descriptorPool = context.descriptorPools->allocate(descriptorSetLayout, _descriptorSet);
     }
 }
 
@@ -99,10 +167,7 @@ DescriptorSet::Implementation::~Implementation()
 {
     if (_descriptorSet)
     {
-#if USE_MUTEX
-        std::scoped_lock<std::mutex> lock(_descriptorPool->getMutex());
-#endif
-        vkFreeDescriptorSets(*_device, *_descriptorPool, 1, &_descriptorSet);
+        _descriptorPool->freeDescriptorSet(_descriptorSet);
     }
 }
 
@@ -113,6 +178,9 @@ void DescriptorSet::Implementation::assign(Context& context, const Descriptors&
 
     if (_descriptors.empty()) return;
 
+    // use the layout's VkDescriptorUpdateTemplate when available to write all the descriptors in one packed block
+    if (_descriptorSetLayout && _descriptorSetLayout->updateDescriptorSet(context, _descriptorSet, descriptors)) return;
+
     VkWriteDescriptorSet* descriptorWrites = context.scratchMemory->allocate<VkWriteDescriptorSet>(_descriptors.size());
 
     for (size_t i = 0; i < _descriptors.size(); ++i)
@@ -181,17 +249,30 @@ void BindDescriptorSets::compile(Context& context)
     vkd._vkPipelineLayout = layout->vk(context.deviceID);
 
     vkd._vkDescriptorSets.resize(descriptorSets.size());
+    vkd._dynamicDescriptorBuffers.clear();
+    vkd._numDynamicOffsets = 0;
     for (size_t i = 0; i < descriptorSets.size(); ++i)
     {
         descriptorSets[i]->compile(context);
         vkd._vkDescriptorSets[i] = descriptorSets[i]->vk(context.deviceID);
+        collectDynamicDescriptorBuffers(*descriptorSets[i], vkd._dynamicDescriptorBuffers, vkd._numDynamicOffsets);
     }
 }
 
 void BindDescriptorSets::record(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
-    vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, vkd._vkPipelineLayout, firstSet, static_cast<uint32_t>(vkd._vkDescriptorSets.size()), vkd._vkDescriptorSets.data(), 0, nullptr);
+
+    // use the current descriptor sets rather than those assigned at compile time as compaction of the MemoryBufferPools may have switched them to rewritten descriptor sets
+    auto vkDescriptorSets = commandBuffer.scratchMemory->allocate<VkDescriptorSet>(descriptorSets.size());
+    for (size_t i = 0; i < descriptorSets.size(); ++i)
+    {
+        vkDescriptorSets[i] = descriptorSets[i]->vk(commandBuffer.deviceID);
+    }
+
+    auto dynamicOffsets = recordDynamicOffsets(commandBuffer, vkd._dynamicDescriptorBuffers, vkd._numDynamicOffsets);
+    vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, vkd._vkPipelineLayout, firstSet, static_cast<uint32_t>(descriptorSets.size()), vkDescriptorSets, vkd._numDynamicOffsets, dynamicOffsets);
+    commandBuffer.scratchMemory->release();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -240,11 +321,26 @@ void BindDescriptorSet::compile(Context& context)
 
     vkd._vkPipelineLayout = layout->vk(context.deviceID);
     vkd._vkDescriptorSet = descriptorSet->vk(context.deviceID);
+
+    vkd._dynamicDescriptorBuffers.clear();
+    vkd._numDynamicOffsets = 0;
+    collectDynamicDescriptorBuffers(*descriptorSet, vkd._dynamicDescriptorBuffers, vkd._numDynamicOffsets);
 }
 
 void BindDescriptorSet::record(CommandBuffer& commandBuffer) const
 {
     auto& vkd = _vulkanData[commandBuffer.deviceID];
 
-    vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, vkd._vkPipelineLayout, firstSet, 1, &(vkd._vkDescriptorSet), 0, nullptr);
+    // use the current descriptor set rather than the one assigned at compile time as compaction of the MemoryBufferPools may have switched it to a rewritten descriptor set
+    VkDescriptorSet vkDescriptorSet = descriptorSet->vk(commandBuffer.deviceID);
+
+    if (vkd._numDynamicOffsets == 0)
+    {
+        vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, vkd._vkPipelineLayout, firstSet, 1, &vkDescriptorSet, 0, nullptr);
+        return;
+    }
+
+    auto dynamicOffsets = recordDynamicOffsets(commandBuffer, vkd._dynamicDescriptorBuffers, vkd._numDynamicOffsets);
+    vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, vkd._vkPipelineLayout, firstSet, 1, &vkDescriptorSet, vkd._numDynamicOffsets, dynamicOffsets);
+    commandBuffer.scratchMemory->release();
 }
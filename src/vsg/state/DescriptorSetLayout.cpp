@@ -14,6 +14,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Options.h>
 #include <vsg/state/DescriptorSetLayout.h>
 #include <vsg/traversals/CompileTraversal.h>
+#include <vsg/vk/Extensions.h>
+
+#include <algorithm>
 
 using namespace vsg;
 
@@ -46,6 +49,16 @@ void DescriptorSetLayout::read(Input& input)
         input.read("descriptorCount", dslb.descriptorCount);
         dslb.stageFlags = input.readValue<uint32_t>("stageFlags");
     }
+
+    if (input.version_greater_equal(0, 0, 3))
+    {
+        flags = input.readValue<uint32_t>("flags");
+        bindingFlags.resize(input.readValue<uint32_t>("NumBindingFlags"));
+        for (auto& bindingFlag : bindingFlags)
+        {
+            bindingFlag = input.readValue<uint32_t>("bindingFlags");
+        }
+    }
 }
 
 void DescriptorSetLayout::write(Output& output) const
@@ -60,34 +73,181 @@ void DescriptorSetLayout::write(Output& output) const
         output.write("descriptorCount", dslb.descriptorCount);
         output.writeValue<uint32_t>("stageFlags", dslb.stageFlags);
     }
+
+    if (output.version_greater_equal(0, 0, 3))
+    {
+        output.writeValue<uint32_t>("flags", flags);
+        output.writeValue<uint32_t>("NumBindingFlags", bindingFlags.size());
+        for (auto& bindingFlag : bindingFlags)
+        {
+            output.writeValue<uint32_t>("bindingFlags", bindingFlag);
+        }
+    }
 }
 
 void DescriptorSetLayout::compile(Context& context)
 {
-    if (!_implementation[context.deviceID]) _implementation[context.deviceID] = DescriptorSetLayout::Implementation::create(context.device, bindings);
+    if (!_implementation[context.deviceID]) _implementation[context.deviceID] = DescriptorSetLayout::Implementation::create(context.device, bindings, flags, bindingFlags);
+}
+
+bool DescriptorSetLayout::updateDescriptorSet(Context& context, VkDescriptorSet descriptorSet, const Descriptors& descriptors) const
+{
+    auto& implementation = _implementation[context.deviceID];
+    if (!implementation || !implementation->_updateTemplate) return false;
+
+    auto& entries = implementation->_templateEntries;
+
+    uint8_t* data = context.scratchMemory->allocate<uint8_t>(implementation->_templateDataSize);
+    bool* writtenElements = context.scratchMemory->allocate<bool>(implementation->_templateNumElements);
+    std::fill(writtenElements, writtenElements + implementation->_templateNumElements, false);
+
+    // each descriptor writes a range of array elements of one binding, every array element of every binding must be written exactly once
+    uint32_t numWrittenElements = 0;
+    bool covered = true;
+    for (auto& descriptor : descriptors)
+    {
+        size_t i = 0;
+        while (i < entries.size() && entries[i].binding != descriptor->dstBinding) ++i;
+
+        uint32_t numDescriptors = descriptor->getNumDescriptors();
+        if (i == entries.size() ||
+            descriptor->descriptorType != entries[i].descriptorType ||
+            numDescriptors == 0 ||
+            descriptor->dstArrayElement + numDescriptors > entries[i].descriptorCount)
+        {
+            covered = false;
+            break;
+        }
+
+        bool* elements = writtenElements + entries[i].firstElement + descriptor->dstArrayElement;
+        if (std::find(elements, elements + numDescriptors, true) != elements + numDescriptors)
+        {
+            covered = false;
+            break;
+        }
+        std::fill(elements, elements + numDescriptors, true);
+        numWrittenElements += numDescriptors;
+
+        descriptor->assignToTemplateData(context, data + entries[i].offset + descriptor->dstArrayElement * entries[i].stride);
+    }
+
+    // fall back when any array element is missing
+    if (numWrittenElements != implementation->_templateNumElements) covered = false;
+
+    if (covered) implementation->_vkUpdateDescriptorSetWithTemplate(*context.device, descriptorSet, implementation->_updateTemplate, data);
+
+    // clean up scratch memory so it can be reused.
+    context.scratchMemory->release();
+
+    return covered;
 }
 
 //////////////////////////////////////
 //
 // DescriptorSetLayout::Implementation
 //
-DescriptorSetLayout::Implementation::Implementation(Device* device, const DescriptorSetLayoutBindings& descriptorSetLayoutBindings) :
+DescriptorSetLayout::Implementation::Implementation(Device* device, const DescriptorSetLayoutBindings& descriptorSetLayoutBindings, VkDescriptorSetLayoutCreateFlags flags, const std::vector<VkDescriptorBindingFlagsEXT>& bindingFlags) :
     _device(device)
 {
     VkDescriptorSetLayoutCreateInfo layoutInfo = {};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.flags = flags;
     layoutInfo.bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
     layoutInfo.pBindings = descriptorSetLayoutBindings.data();
     layoutInfo.pNext = nullptr;
 
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {};
+    if (!bindingFlags.empty())
+    {
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        bindingFlagsInfo.pNext = nullptr;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+        layoutInfo.pNext = &bindingFlagsInfo;
+    }
+
     if (VkResult result = vkCreateDescriptorSetLayout(*device, &layoutInfo, _device->getAllocationCallbacks(), &_descriptorSetLayout); result != VK_SUCCESS)
     {
         throw Exception{"Error: Failed to create DescriptorSetLayout.", result};
     }
+
+    auto extensions = Extensions::Get(device, true);
+    if (!extensions->vkCreateDescriptorUpdateTemplateKHR || descriptorSetLayoutBindings.empty()) return;
+
+    // set up a template entry for each binding with the descriptor infos tightly packed in binding order
+    std::vector<VkDescriptorUpdateTemplateEntryKHR> templateEntries;
+    for (auto& binding : descriptorSetLayoutBindings)
+    {
+        size_t stride = 0;
+        switch (binding.descriptorType)
+        {
+        case (VK_DESCRIPTOR_TYPE_SAMPLER):
+        case (VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER):
+        case (VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE):
+        case (VK_DESCRIPTOR_TYPE_STORAGE_IMAGE):
+        case (VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT):
+            stride = sizeof(VkDescriptorImageInfo);
+            break;
+        case (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER):
+        case (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER):
+        case (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC):
+        case (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC):
+            stride = sizeof(VkDescriptorBufferInfo);
+            break;
+        case (VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER):
+        case (VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER):
+            stride = sizeof(VkBufferView);
+            break;
+        default:
+            // descriptor types such as acceleration structures aren't supported by the template path
+            _templateEntries.clear();
+            return;
+        }
+
+        if (binding.descriptorCount == 0) continue;
+
+        VkDescriptorUpdateTemplateEntryKHR entry = {};
+        entry.dstBinding = binding.binding;
+        entry.dstArrayElement = 0;
+        entry.descriptorCount = binding.descriptorCount;
+        entry.descriptorType = binding.descriptorType;
+        entry.offset = _templateDataSize;
+        entry.stride = stride;
+        templateEntries.push_back(entry);
+
+        _templateEntries.push_back(TemplateEntry{binding.binding, binding.descriptorCount, binding.descriptorType, _templateDataSize, stride, _templateNumElements});
+        _templateDataSize += stride * binding.descriptorCount;
+        _templateNumElements += binding.descriptorCount;
+    }
+
+    VkDescriptorUpdateTemplateCreateInfoKHR templateInfo = {};
+    templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+    templateInfo.pNext = nullptr;
+    templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size());
+    templateInfo.pDescriptorUpdateEntries = templateEntries.data();
+    templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+    templateInfo.descriptorSetLayout = _descriptorSetLayout;
+
+    if (extensions->vkCreateDescriptorUpdateTemplateKHR(*device, &templateInfo, _device->getAllocationCallbacks(), &_updateTemplate) == VK_SUCCESS)
+    {
+        _vkUpdateDescriptorSetWithTemplate = extensions->vkUpdateDescriptorSetWithTemplateKHR;
+        _vkDestroyDescriptorUpdateTemplate = extensions->vkDestroyDescriptorUpdateTemplateKHR;
+    }
+    else
+    {
+        // fallback to vkUpdateDescriptorSets
+        _updateTemplate = VK_NULL_HANDLE;
+        _templateEntries.clear();
+    }
 }
 
 DescriptorSetLayout::Implementation::~Implementation()
 {
+    if (_updateTemplate)
+    {
+        _vkDestroyDescriptorUpdateTemplate(*_device, _updateTemplate, _device->getAllocationCallbacks());
+    }
+
     if (_descriptorSetLayout)
     {
         vkDestroyDescriptorSetLayout(*_device, _descriptorSetLayout, _device->getAllocationCallbacks());
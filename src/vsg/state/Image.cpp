@@ -136,5 +136,7 @@ void Image::compile(Context& context)
         throw Exception{"Error: allocate memory to reserve slot.", VK_ERROR_OUT_OF_DEVICE_MEMORY};
     }
 
+    context.deviceMemoryReserved += memRequirements.size;
+
     bind(deviceMemory, offset);
 }
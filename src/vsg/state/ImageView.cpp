@@ -123,6 +123,8 @@ ref_ptr<ImageView> vsg::createImageView(vsg::Context& context, ref_ptr<Image> im
         throw Exception{"Error: Failed allocate memory for image.", 0};
     }
 
+    context.deviceMemoryReserved += memRequirements.size;
+
     image->bind(deviceMemory, offset);
 
     auto imageView = ImageView::create(image, aspectFlags);
@@ -18,8 +18,185 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/state/GraphicsPipeline.h>
 #include <vsg/traversals/ArrayState.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
 using namespace vsg;
 
+namespace
+{
+    // branchless conversions so the decode loops can be vectorized by the compiler
+    inline float halfToFloat(uint16_t h)
+    {
+        const uint32_t shifted_exp = 0x7c00 << 13;
+        const float magic = 6.10351562e-05f; // 2^-14, the smallest normalized half
+
+        uint32_t bits = static_cast<uint32_t>(h & 0x7fff) << 13;
+        uint32_t exp = shifted_exp & bits;
+        bits += (127 - 15) << 23;
+
+        // inf/nan need the exponent adjusting further, denormals need renormalizing
+        bits += (exp == shifted_exp) ? ((128 - 16) << 23) : 0;
+        bits += (exp == 0) ? (1 << 23) : 0;
+
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        f -= (exp == 0) ? magic : 0.0f;
+
+        uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+        std::memcpy(&bits, &f, sizeof(f));
+        bits |= sign;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    struct HalfFloat
+    {
+        using value_type = uint16_t;
+        static float convert(value_type v) { return halfToFloat(v); }
+    };
+
+    template<typename T>
+    struct SignedNormalized
+    {
+        using value_type = T;
+        static float convert(value_type v) { return std::max(static_cast<float>(v) / static_cast<float>(std::numeric_limits<T>::max()), -1.0f); }
+    };
+
+    template<typename T>
+    struct UnsignedNormalized
+    {
+        using value_type = T;
+        static float convert(value_type v) { return static_cast<float>(v) / static_cast<float>(std::numeric_limits<T>::max()); }
+    };
+
+    struct Double
+    {
+        using value_type = double;
+        static float convert(value_type v) { return static_cast<float>(v); }
+    };
+
+    template<class C>
+    void decodeVertices(const uint8_t* src, uint32_t stride, vec3* dest, uint32_t numVertices)
+    {
+        using value_type = typename C::value_type;
+        for (uint32_t i = 0; i < numVertices; ++i)
+        {
+            // copy the components to handle source attributes that aren't aligned to value_type
+            value_type components[3];
+            std::memcpy(components, src + i * stride, sizeof(components));
+            dest[i].set(C::convert(components[0]), C::convert(components[1]), C::convert(components[2]));
+        }
+    }
+
+    uint32_t vertexSize(VkFormat format)
+    {
+        switch (format)
+        {
+        case (VK_FORMAT_R16G16B16_SFLOAT):
+        case (VK_FORMAT_R16G16B16A16_SFLOAT):
+        case (VK_FORMAT_R16G16B16_SNORM):
+        case (VK_FORMAT_R16G16B16A16_SNORM):
+        case (VK_FORMAT_R16G16B16_UNORM):
+        case (VK_FORMAT_R16G16B16A16_UNORM): return 6;
+        case (VK_FORMAT_R8G8B8_SNORM):
+        case (VK_FORMAT_R8G8B8A8_SNORM):
+        case (VK_FORMAT_R8G8B8_UNORM):
+        case (VK_FORMAT_R8G8B8A8_UNORM): return 3;
+        case (VK_FORMAT_R64G64B64_SFLOAT):
+        case (VK_FORMAT_R64G64B64A64_SFLOAT): return 24;
+        default: return 0;
+        }
+    }
+} // namespace
+
+DecodedVertices::DecodedVertices()
+{
+}
+
+DecodedVertices::~DecodedVertices()
+{
+}
+
+bool DecodedVertices::supported(VkFormat in_format)
+{
+    return vertexSize(in_format) > 0;
+}
+
+bool DecodedVertices::decode(const Data& source, uint32_t in_offset, uint32_t in_stride, VkFormat in_format)
+{
+    uint32_t size = vertexSize(in_format);
+    if (size == 0 || in_stride == 0) return false;
+
+    offset = in_offset;
+    stride = in_stride;
+    format = in_format;
+    sourceModifiedCount = source.getModifiedCount();
+
+    uint32_t dataSize = static_cast<uint32_t>(source.dataSize());
+    uint32_t numVertices = (dataSize >= (offset + size)) ? ((dataSize - offset - size) / stride + 1) : 0;
+
+    if (!vertices || vertices->size() != numVertices) vertices = vec3Array::create(numVertices);
+    if (numVertices == 0) return true;
+
+    auto src = static_cast<const uint8_t*>(source.dataPointer()) + offset;
+    auto dest = vertices->data();
+
+    switch (format)
+    {
+    case (VK_FORMAT_R16G16B16_SFLOAT):
+    case (VK_FORMAT_R16G16B16A16_SFLOAT): decodeVertices<HalfFloat>(src, stride, dest, numVertices); break;
+    case (VK_FORMAT_R16G16B16_SNORM):
+    case (VK_FORMAT_R16G16B16A16_SNORM): decodeVertices<SignedNormalized<int16_t>>(src, stride, dest, numVertices); break;
+    case (VK_FORMAT_R16G16B16_UNORM):
+    case (VK_FORMAT_R16G16B16A16_UNORM): decodeVertices<UnsignedNormalized<uint16_t>>(src, stride, dest, numVertices); break;
+    case (VK_FORMAT_R8G8B8_SNORM):
+    case (VK_FORMAT_R8G8B8A8_SNORM): decodeVertices<SignedNormalized<int8_t>>(src, stride, dest, numVertices); break;
+    case (VK_FORMAT_R8G8B8_UNORM):
+    case (VK_FORMAT_R8G8B8A8_UNORM): decodeVertices<UnsignedNormalized<uint8_t>>(src, stride, dest, numVertices); break;
+    default: decodeVertices<Double>(src, stride, dest, numVertices); break;
+    }
+
+    return true;
+}
+
+bool DecodedVertices::valid(const Data& source, uint32_t in_offset, uint32_t in_stride, VkFormat in_format) const
+{
+    return offset == in_offset && stride == in_stride && format == in_format && !source.differentModifiedCount(sourceModifiedCount);
+}
+
+ref_ptr<const DecodedVertices> DecodedVertices::getOrCreate(const Data& source, uint32_t in_offset, uint32_t in_stride, VkFormat in_format)
+{
+    if (!supported(in_format)) return {};
+
+    ref_ptr<DecodedVertices> decoded;
+    {
+        // the Auxiliary ObjectMap isn't thread safe, so serialize the lookup and insertion of the cached DecodedVertices
+        static std::mutex s_cacheMutex;
+        std::scoped_lock<std::mutex> lock(s_cacheMutex);
+
+        // hacky but better to reuse results, same approach as used for caching the "bound" on VertexIndexDraw
+        decoded = const_cast<DecodedVertices*>(source.getObject<DecodedVertices>("DecodedVertices"));
+        if (!decoded || !decoded->valid(source, in_offset, in_stride, in_format))
+        {
+            // decode into a new object as other threads may still be using the previously decoded vertices
+            decoded = DecodedVertices::create();
+            decoded->offset = in_offset;
+            decoded->stride = in_stride;
+            decoded->format = in_format;
+            decoded->sourceModifiedCount = source.getModifiedCount();
+
+            const_cast<Data&>(source).setObject("DecodedVertices", decoded);
+        }
+    }
+
+    std::call_once(decoded->_decoded, [&]() { decoded->decode(source, in_offset, in_stride, in_format); });
+
+    return decoded;
+}
+
 void ArrayState::apply(const vsg::BindGraphicsPipeline& bpg)
 {
     for (auto& pipelineState : bpg.pipeline->pipelineStates)
@@ -87,7 +264,7 @@ void ArrayState::apply(const vsg::vec3Array& array)
 void ArrayState::apply(const vsg::Data& array)
 {
     // array hasn't been matched to vec3Array so fallback to using a proxy array to adapt it
-    if (vertexAttribute.stride > 0 && (vertexAttribute.format == VK_FORMAT_R32G32B32_SFLOAT))
+    if (vertexAttribute.stride > 0 && (vertexAttribute.format == VK_FORMAT_R32G32B32_SFLOAT || vertexAttribute.format == VK_FORMAT_R32G32B32A32_SFLOAT))
     {
         if (!proxy_vertices) proxy_vertices = vsg::vec3Array::create();
 
@@ -96,6 +273,10 @@ void ArrayState::apply(const vsg::Data& array)
 
         vertices = proxy_vertices;
     }
+    else if (auto decoded = DecodedVertices::getOrCreate(array, vertexAttribute.offset, vertexAttribute.stride, vertexAttribute.format))
+    {
+        vertices = decoded->vertices;
+    }
     else
     {
         vertices = nullptr;
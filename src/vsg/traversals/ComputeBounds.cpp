@@ -27,11 +27,49 @@ ComputeBounds::ComputeBounds()
     arrayStateStack.emplace_back(ArrayState());
 }
 
+ref_ptr<ComputeBounds> ComputeBounds::fork() const
+{
+    auto forked = ComputeBounds::create();
+    forked->parallelTraversal = parallelTraversal;
+    forked->traversalMask = traversalMask;
+
+    // the proxy_vertices are updated in place so each forked ArrayState needs its own
+    forked->arrayStateStack.back() = arrayStateStack.back();
+    forked->arrayStateStack.back().proxy_vertices = nullptr;
+
+    if (!matrixStack.empty()) forked->matrixStack.push_back(matrixStack.back());
+
+    return forked;
+}
+
+void ComputeBounds::join(const ComputeBounds& forked)
+{
+    if (forked.bounds.valid())
+    {
+        bounds.add(forked.bounds.min);
+        bounds.add(forked.bounds.max);
+    }
+}
+
 void ComputeBounds::apply(const vsg::Node& node)
 {
     node.traverse(*this);
 }
 
+void ComputeBounds::apply(const vsg::Group& group)
+{
+    if (parallelTraversal && parallelTraversal->traverse(group, *this)) return;
+
+    group.traverse(*this);
+}
+
+void ComputeBounds::apply(const vsg::QuadGroup& group)
+{
+    if (parallelTraversal && parallelTraversal->traverse(group, *this)) return;
+
+    group.traverse(*this);
+}
+
 void ComputeBounds::apply(const StateGroup& stategroup)
 {
     ArrayState arrayState(arrayStateStack.back());
@@ -88,7 +88,7 @@ void Intersector::apply(const LOD& lod)
         {
             if (child.node)
             {
-                child.node->accept(*this);
+                if (child.node->validMask(traversalMask)) child.node->accept(*this);
                 break;
             }
         }
@@ -105,7 +105,7 @@ void Intersector::apply(const PagedLOD& plod)
         {
             if (child.node)
             {
-                child.node->accept(*this);
+                if (child.node->validMask(traversalMask)) child.node->accept(*this);
                 break;
             }
         }
@@ -11,8 +11,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/io/Options.h>
+#include <vsg/nodes/CullNode.h>
+#include <vsg/nodes/Group.h>
+#include <vsg/nodes/LOD.h>
+#include <vsg/nodes/PagedLOD.h>
 #include <vsg/traversals/LineSegmentIntersector.h>
 
+#include <algorithm>
+
 using namespace vsg;
 
 template<typename V>
@@ -83,7 +89,7 @@ struct TriangleIntersector
 
             value_type inv_det = 1.0 / det;
             value_type t = dot(Q, E2) * inv_det;
-            if (t < 0.0 || t > _length) return false;
+            if (t < 0.0 || t > _length * intersector.maximumRatio()) return false;
 
             u *= inv_det;
             v *= inv_det;
@@ -106,7 +112,7 @@ struct TriangleIntersector
 
             value_type inv_det = 1.0 / det;
             value_type t = dot(Q, E2) * inv_det;
-            if (t < 0.0 || t > _length) return false;
+            if (t < 0.0 || t > _length * intersector.maximumRatio()) return false;
 
             u *= inv_det;
             v *= inv_det;
@@ -124,9 +130,7 @@ struct TriangleIntersector
         // TODO : handle hit
 
         dvec3 intersection = dvec3(dvec3(v0) * double(r0) + dvec3(v1) * double(r1) + dvec3(v2) * double(r2));
-        intersector.add(intersection, double(r), {{i0, r0}, {i1, r1}, {i2, r2}});
-
-        return true;
+        return intersector.add(intersection, double(r), {{i0, r0}, {i1, r1}, {i2, r2}});
     }
 };
 
@@ -162,8 +166,54 @@ LineSegmentIntersector::LineSegmentIntersector(const Camera& camera, int32_t x,
     _lineSegmentStack.push_back(LineSegment{world_near, world_far});
 }
 
-void LineSegmentIntersector::add(const dvec3& intersection, double ratio, const IndexRatios& indexRatios)
+void LineSegmentIntersector::setIntersectionMode(IntersectionMode mode)
+{
+    _intersectionMode = mode;
+    reset();
+}
+
+void LineSegmentIntersector::setLineSegment(const dvec3& s, const dvec3& e)
+{
+    _lineSegmentStack.clear();
+    _lineSegmentStack.push_back(LineSegment{s, e});
+    reset();
+}
+
+void LineSegmentIntersector::reset()
+{
+    intersections.clear();
+    _maximumRatio = 1.0;
+}
+
+bool LineSegmentIntersector::add(const dvec3& intersection, double ratio, const IndexRatios& indexRatios)
 {
+    if (_intersectionMode == NEAREST_INTERSECTION)
+    {
+        if (!intersections.empty() && ratio >= _maximumRatio) return false;
+
+        _maximumRatio = ratio;
+
+        // reuse the single Intersection entry so its containers keep their capacity rather than allocating for every new nearest hit
+        intersections.resize(1);
+        auto& nearest = intersections.front();
+        nearest.localIntersection = intersection;
+        nearest.ratio = ratio;
+        if (_matrixStack.empty())
+        {
+            nearest.worldIntersection = intersection;
+            nearest.localToWord = dmat4();
+        }
+        else
+        {
+            nearest.localToWord = _matrixStack.back();
+            nearest.worldIntersection = nearest.localToWord * intersection;
+        }
+        nearest.nodePath = _nodePath;
+        nearest.arrays = arrayStateStack.back().arrays;
+        nearest.indexRatios = indexRatios;
+        return true;
+    }
+
     if (_matrixStack.empty())
     {
         intersections.emplace_back(Intersection{intersection, intersection, ratio, {}, _nodePath, arrayStateStack.back().arrays, indexRatios});
@@ -173,6 +223,7 @@ void LineSegmentIntersector::add(const dvec3& intersection, double ratio, const
         auto& localToWorld = _matrixStack.back();
         intersections.emplace_back(Intersection{intersection, localToWorld * intersection, ratio, localToWorld, _nodePath, arrayStateStack.back().arrays, indexRatios});
     }
+    return true;
 }
 
 void LineSegmentIntersector::pushTransform(const dmat4& m)
@@ -192,18 +243,21 @@ void LineSegmentIntersector::popTransform()
     _matrixStack.pop_back();
 }
 
-bool LineSegmentIntersector::intersects(const dsphere& bs)
+bool LineSegmentIntersector::entryRatio(const dsphere& bs, double& ratio) const
 {
-    //std::cout<<"intersects( center = "<<bs.center<<", radius = "<<bs.radius<<")"<<std::endl;
     if (!bs.valid()) return false;
 
     auto& lineSegment = _lineSegmentStack.back();
-    dvec3& start = lineSegment.start;
-    dvec3& end = lineSegment.end;
+    const dvec3& start = lineSegment.start;
+    const dvec3& end = lineSegment.end;
 
     dvec3 sm = start - bs.center;
     double c = length2(sm) - bs.radius * bs.radius;
-    if (c < 0.0) return true;
+    if (c < 0.0)
+    {
+        ratio = 0.0;
+        return true;
+    }
 
     dvec3 se = end - start;
     double a = length2(se);
@@ -220,12 +274,66 @@ bool LineSegmentIntersector::intersects(const dsphere& bs)
     double r2 = (-b + d) * div;
 
     if (r1 <= 0.0 && r2 <= 0.0) return false;
-    if (r1 >= 1.0 && r2 >= 1.0) return false;
+    if (r1 >= _maximumRatio && r2 >= _maximumRatio) return false;
 
-    // passed all the rejection tests so line must intersect bounding sphere, return true.
+    // passed all the rejection tests so line must intersect bounding sphere.
+    ratio = std::max(std::min(r1, r2), 0.0);
     return true;
 }
 
+bool LineSegmentIntersector::intersects(const dsphere& bs)
+{
+    double ratio;
+    return entryRatio(bs, ratio);
+}
+
+void LineSegmentIntersector::apply(const Group& group)
+{
+    auto& children = group.getChildren();
+    if (_intersectionMode != NEAREST_INTERSECTION || children.size() < 2)
+    {
+        Intersector::apply(static_cast<const Node&>(group));
+        return;
+    }
+
+    _nodePath.push_back(&group);
+
+    size_t begin = _orderedChildren.size();
+    for (auto& child : children)
+    {
+        if (!child->validMask(traversalMask)) continue;
+
+        // children without a bound have to be visited, so visit them first
+        dsphere bound;
+        if (auto cullNode = dynamic_cast<const CullNode*>(child.get())) bound = cullNode->getBound();
+        else if (auto lod = dynamic_cast<const LOD*>(child.get())) bound = lod->getBound();
+        else if (auto plod = dynamic_cast<const PagedLOD*>(child.get())) bound = plod->getBound();
+        else
+        {
+            _orderedChildren.emplace_back(0.0, child.get());
+            continue;
+        }
+
+        double ratio;
+        if (entryRatio(bound, ratio)) _orderedChildren.emplace_back(ratio, child.get());
+    }
+
+    std::sort(_orderedChildren.begin() + begin, _orderedChildren.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    // index rather than iterate as nested groups append to _orderedChildren
+    size_t end = _orderedChildren.size();
+    for (size_t i = begin; i < end; ++i)
+    {
+        // children are in front to back order, so once a child's bound starts beyond the nearest hit so do all the following children
+        if (_orderedChildren[i].first >= _maximumRatio) break;
+        _orderedChildren[i].second->accept(*this);
+    }
+
+    _orderedChildren.resize(begin);
+
+    _nodePath.pop_back();
+}
+
 bool LineSegmentIntersector::intersectDraw(uint32_t firstVertex, uint32_t vertexCount)
 {
     auto& arrayState = arrayStateStack.back();
@@ -236,15 +344,30 @@ bool LineSegmentIntersector::intersectDraw(uint32_t firstVertex, uint32_t vertex
     TriangleIntersector<double> triIntsector(*this, ls.start, ls.end, arrayState.vertices);
     if (!triIntsector.vertices) return false;
 
-    size_t previous_size = intersections.size();
+    // in NEAREST_INTERSECTION mode a nearer hit replaces the existing intersection so the number of intersections can't be used to detect hits
+    bool hit = false;
     uint32_t endVertex = firstVertex + vertexCount;
 
+    if (triangleBVHThreshold > 0 && (vertexCount / 3) >= triangleBVHThreshold && (firstVertex % 3) == 0)
+    {
+        if (auto bvh = TriangleBVH::getOrCreate(arrayState, nullptr))
+        {
+            uint32_t firstTriangle = firstVertex / 3;
+            uint32_t endTriangle = endVertex / 3;
+            bvh->intersect(ls.start, ls.start + (ls.end - ls.start) * _maximumRatio, [&](uint32_t triangle) {
+                if (triangle >= firstTriangle && triangle < endTriangle && triIntsector.intersect(triangle * 3, triangle * 3 + 1, triangle * 3 + 2)) hit = true;
+            });
+
+            return hit;
+        }
+    }
+
     for (uint32_t i = firstVertex; i < endVertex; i += 3)
     {
-        triIntsector.intersect(i, i + 1, i + 2);
+        if (triIntsector.intersect(i, i + 1, i + 2)) hit = true;
     }
 
-    return intersections.size() != previous_size;
+    return hit;
 }
 
 bool LineSegmentIntersector::intersectDrawIndexed(uint32_t firstIndex, uint32_t indexCount)
@@ -257,23 +380,43 @@ bool LineSegmentIntersector::intersectDrawIndexed(uint32_t firstIndex, uint32_t
     TriangleIntersector<double> triIntsector(*this, ls.start, ls.end, arrayState.vertices);
     if (!triIntsector.vertices) return false;
 
-    size_t previous_size = intersections.size();
+    // in NEAREST_INTERSECTION mode a nearer hit replaces the existing intersection so the number of intersections can't be used to detect hits
+    bool hit = false;
     uint32_t endIndex = firstIndex + indexCount;
 
+    const Data* indices = ushort_indices ? static_cast<const Data*>(ushort_indices.get()) : static_cast<const Data*>(uint_indices.get());
+    if (indices && triangleBVHThreshold > 0 && (indexCount / 3) >= triangleBVHThreshold && (firstIndex % 3) == 0)
+    {
+        if (auto bvh = TriangleBVH::getOrCreate(arrayState, indices))
+        {
+            uint32_t firstTriangle = firstIndex / 3;
+            uint32_t endTriangle = endIndex / 3;
+            bvh->intersect(ls.start, ls.start + (ls.end - ls.start) * _maximumRatio, [&](uint32_t triangle) {
+                if (triangle >= firstTriangle && triangle < endTriangle)
+                {
+                    const uint32_t* tri = &(bvh->indices[triangle * 3]);
+                    if (triIntsector.intersect(tri[0], tri[1], tri[2])) hit = true;
+                }
+            });
+
+            return hit;
+        }
+    }
+
     if (ushort_indices)
     {
         for (uint32_t i = firstIndex; i < endIndex; i += 3)
         {
-            triIntsector.intersect(ushort_indices->at(i), ushort_indices->at(i + 1), ushort_indices->at(i + 2));
+            if (triIntsector.intersect(ushort_indices->at(i), ushort_indices->at(i + 1), ushort_indices->at(i + 2))) hit = true;
         }
     }
     else if (uint_indices)
     {
         for (uint32_t i = firstIndex; i < endIndex; i += 3)
         {
-            triIntsector.intersect(uint_indices->at(i), uint_indices->at(i + 1), uint_indices->at(i + 2));
+            if (triIntsector.intersect(uint_indices->at(i), uint_indices->at(i + 1), uint_indices->at(i + 2))) hit = true;
         }
     }
 
-    return intersections.size() != previous_size;
+    return hit;
 }
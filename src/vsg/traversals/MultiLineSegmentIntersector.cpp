@@ -0,0 +1,355 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/Options.h>
+#include <vsg/nodes/CullNode.h>
+#include <vsg/nodes/LOD.h>
+#include <vsg/nodes/PagedLOD.h>
+#include <vsg/nodes/VertexIndexDraw.h>
+#include <vsg/traversals/MultiLineSegmentIntersector.h>
+
+using namespace vsg;
+
+void MultiLineSegmentIntersector::LineSegmentArrays::resize(size_t size)
+{
+    sx.resize(size);
+    sy.resize(size);
+    sz.resize(size);
+    dx.resize(size);
+    dy.resize(size);
+    dz.resize(size);
+}
+
+void MultiLineSegmentIntersector::LineSegmentArrays::set(size_t i, const dvec3& start, const dvec3& end)
+{
+    sx[i] = start.x;
+    sy[i] = start.y;
+    sz[i] = start.z;
+    dx[i] = end.x - start.x;
+    dy[i] = end.y - start.y;
+    dz[i] = end.z - start.z;
+}
+
+MultiLineSegmentIntersector::PushPopActive::PushPopActive(MultiLineSegmentIntersector& in_intersector) :
+    intersector(in_intersector)
+{
+    auto& activeStack = intersector._activeStack;
+    size_t depth = ++intersector._activeDepth;
+    if (depth >= activeStack.size()) activeStack.resize(depth + 1);
+
+    // assign rather than copy construct so the capacity of the list at this depth is reused
+    activeStack[depth].assign(activeStack[depth - 1].begin(), activeStack[depth - 1].end());
+}
+
+MultiLineSegmentIntersector::MultiLineSegmentIntersector(const LineSegments& lineSegments)
+{
+    intersections.resize(lineSegments.size());
+
+    _lineSegmentStack.resize(1);
+    _lineSegmentStack[0].resize(lineSegments.size());
+    for (size_t i = 0; i < lineSegments.size(); ++i)
+    {
+        _lineSegmentStack[0].set(i, lineSegments[i].start, lineSegments[i].end);
+    }
+
+    _activeStack.resize(1);
+    auto& rootActive = _activeStack[0];
+    rootActive.resize(lineSegments.size());
+    for (size_t i = 0; i < lineSegments.size(); ++i) rootActive[i] = static_cast<uint32_t>(i);
+}
+
+static MultiLineSegmentIntersector::LineSegments computeLineSegments(const Camera& camera, const std::vector<ivec2>& windowCoordinates)
+{
+    auto viewport = camera.getViewport();
+
+    dmat4 projectionMatrix;
+    camera.getProjectionMatrix()->get(projectionMatrix);
+
+    dmat4 viewMatrix;
+    camera.getViewMatrix()->get(viewMatrix);
+
+    auto inv_projectionViewMatrix = inverse(projectionMatrix * viewMatrix);
+
+    MultiLineSegmentIntersector::LineSegments lineSegments;
+    lineSegments.reserve(windowCoordinates.size());
+    for (auto& coord : windowCoordinates)
+    {
+        vec2 ndc(0.0f, 0.0f);
+        if ((viewport.width > 0) && (viewport.height > 0))
+        {
+            ndc.set((static_cast<float>(coord.x) - viewport.x) / viewport.width, (static_cast<float>(coord.y) - viewport.y) / viewport.height);
+        }
+
+        dvec3 ndc_near(ndc.x * 2.0 - 1.0, ndc.y * 2.0 - 1.0, viewport.minDepth * 2.0 - 1.0);
+        dvec3 ndc_far(ndc.x * 2.0 - 1.0, ndc.y * 2.0 - 1.0, viewport.maxDepth * 2.0 - 1.0);
+
+        lineSegments.push_back(MultiLineSegmentIntersector::LineSegment{inv_projectionViewMatrix * ndc_near, inv_projectionViewMatrix * ndc_far});
+    }
+    return lineSegments;
+}
+
+MultiLineSegmentIntersector::MultiLineSegmentIntersector(const Camera& camera, const std::vector<ivec2>& windowCoordinates) :
+    MultiLineSegmentIntersector(computeLineSegments(camera, windowCoordinates))
+{
+}
+
+void MultiLineSegmentIntersector::add(uint32_t lineSegmentIndex, const dvec3& intersection, double ratio, const IndexRatios& indexRatios)
+{
+    ++_numIntersections;
+
+    auto& lineSegmentIntersections = intersections[lineSegmentIndex];
+    if (_matrixStack.empty())
+    {
+        lineSegmentIntersections.emplace_back(Intersection{intersection, intersection, ratio, {}, _nodePath, arrayStateStack.back().arrays, indexRatios});
+    }
+    else
+    {
+        auto& localToWorld = _matrixStack.back();
+        lineSegmentIntersections.emplace_back(Intersection{intersection, localToWorld * intersection, ratio, localToWorld, _nodePath, arrayStateStack.back().arrays, indexRatios});
+    }
+}
+
+void MultiLineSegmentIntersector::apply(const LOD& lod)
+{
+    PushPopActive ppa(*this);
+    Intersector::apply(lod);
+}
+
+void MultiLineSegmentIntersector::apply(const PagedLOD& plod)
+{
+    PushPopActive ppa(*this);
+    Intersector::apply(plod);
+}
+
+void MultiLineSegmentIntersector::apply(const CullNode& cn)
+{
+    PushPopActive ppa(*this);
+    Intersector::apply(cn);
+}
+
+void MultiLineSegmentIntersector::apply(const VertexIndexDraw& vid)
+{
+    PushPopActive ppa(*this);
+    Intersector::apply(vid);
+}
+
+void MultiLineSegmentIntersector::pushTransform(const dmat4& m)
+{
+    dmat4 localToWorld = _matrixStack.empty() ? m : (_matrixStack.back() * m);
+    dmat4 worldToLocal = inverse(localToWorld);
+
+    _matrixStack.push_back(localToWorld);
+
+    size_t depth = ++_lineSegmentDepth;
+    if (depth >= _lineSegmentStack.size()) _lineSegmentStack.resize(depth + 1);
+
+    // only the active line segments need transforming into the local coordinate frame as inactive ones can't be reactivated within this subtree
+    auto& world = _lineSegmentStack[0];
+    auto& local = _lineSegmentStack[depth];
+    local.resize(world.sx.size());
+    for (auto i : active())
+    {
+        dvec3 start(world.sx[i], world.sy[i], world.sz[i]);
+        dvec3 end(start.x + world.dx[i], start.y + world.dy[i], start.z + world.dz[i]);
+        local.set(i, worldToLocal * start, worldToLocal * end);
+    }
+}
+
+void MultiLineSegmentIntersector::popTransform()
+{
+    --_lineSegmentDepth;
+    _matrixStack.pop_back();
+}
+
+bool MultiLineSegmentIntersector::intersects(const dsphere& bs)
+{
+    auto& activeLineSegments = active();
+    if (!bs.valid())
+    {
+        activeLineSegments.clear();
+        return false;
+    }
+
+    auto& ls = _lineSegmentStack[_lineSegmentDepth];
+    const double cx = bs.center.x, cy = bs.center.y, cz = bs.center.z;
+    const double radius2 = bs.radius * bs.radius;
+
+    // compact the active list in place, keeping the line segments that intersect the sphere
+    size_t numActive = 0;
+    for (auto i : activeLineSegments)
+    {
+        double smx = ls.sx[i] - cx, smy = ls.sy[i] - cy, smz = ls.sz[i] - cz;
+        double c = smx * smx + smy * smy + smz * smz - radius2;
+
+        bool hit = (c < 0.0);
+        if (!hit)
+        {
+            double a = ls.dx[i] * ls.dx[i] + ls.dy[i] * ls.dy[i] + ls.dz[i] * ls.dz[i];
+            double b = (smx * ls.dx[i] + smy * ls.dy[i] + smz * ls.dz[i]) * 2.0;
+            double d = b * b - 4.0 * a * c;
+            if (d >= 0.0 && a > 0.0)
+            {
+                d = sqrt(d);
+                double div = 1.0 / (2.0 * a);
+                double r1 = (-b - d) * div;
+                double r2 = (-b + d) * div;
+                hit = !(r1 <= 0.0 && r2 <= 0.0) && !(r1 >= 1.0 && r2 >= 1.0);
+            }
+        }
+
+        if (hit) activeLineSegments[numActive++] = i;
+    }
+
+    activeLineSegments.resize(numActive);
+    return numActive > 0;
+}
+
+void MultiLineSegmentIntersector::intersectTriangle(uint32_t i0, uint32_t i1, uint32_t i2)
+{
+    for (auto i : active())
+    {
+        intersectTriangle(i, i0, i1, i2);
+    }
+}
+
+void MultiLineSegmentIntersector::intersectTriangle(uint32_t lineSegmentIndex, uint32_t i0, uint32_t i1, uint32_t i2)
+{
+    auto& vertices = *arrayStateStack.back().vertices;
+    auto& ls = _lineSegmentStack[_lineSegmentDepth];
+
+    const vec3& v0 = vertices.at(i0);
+    const vec3& v1 = vertices.at(i1);
+    const vec3& v2 = vertices.at(i2);
+
+    double e1x = double(v1.x) - v0.x, e1y = double(v1.y) - v0.y, e1z = double(v1.z) - v0.z;
+    double e2x = double(v2.x) - v0.x, e2y = double(v2.y) - v0.y, e2z = double(v2.z) - v0.z;
+
+    const double dx = ls.dx[lineSegmentIndex], dy = ls.dy[lineSegmentIndex], dz = ls.dz[lineSegmentIndex];
+    const double tx = ls.sx[lineSegmentIndex] - v0.x, ty = ls.sy[lineSegmentIndex] - v0.y, tz = ls.sz[lineSegmentIndex] - v0.z;
+
+    // P = d x e2
+    double px = dy * e2z - dz * e2y;
+    double py = dz * e2x - dx * e2z;
+    double pz = dx * e2y - dy * e2x;
+
+    double det = px * e1x + py * e1y + pz * e1z;
+
+    // scale the epsilon by the length of the line segment as d isn't normalized
+    const double epsilon = 1e-10 * sqrt(dx * dx + dy * dy + dz * dz);
+    if (det <= epsilon && det >= -epsilon) return;
+
+    double inv_det = 1.0 / det;
+
+    double u = (px * tx + py * ty + pz * tz) * inv_det;
+    if (u < 0.0 || u > 1.0) return;
+
+    // Q = T x e1
+    double qx = ty * e1z - tz * e1y;
+    double qy = tz * e1x - tx * e1z;
+    double qz = tx * e1y - ty * e1x;
+
+    double v = (qx * dx + qy * dy + qz * dz) * inv_det;
+    if (v < 0.0 || (u + v) > 1.0) return;
+
+    // as d isn't normalized t is the ratio along the line segment
+    double r = (qx * e2x + qy * e2y + qz * e2z) * inv_det;
+    if (r < 0.0 || r > 1.0) return;
+
+    double r0 = 1.0 - u - v;
+    dvec3 intersection = dvec3(v0) * r0 + dvec3(v1) * u + dvec3(v2) * v;
+    add(lineSegmentIndex, intersection, r, {{i0, r0}, {i1, u}, {i2, v}});
+}
+
+bool MultiLineSegmentIntersector::intersectDraw(uint32_t firstVertex, uint32_t vertexCount)
+{
+    auto& arrayState = arrayStateStack.back();
+    if (!arrayState.vertices || arrayState.topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST || vertexCount == 0 || active().empty()) return false;
+
+    size_t previous_numIntersections = _numIntersections;
+    uint32_t endVertex = firstVertex + vertexCount;
+
+    if (triangleBVHThreshold > 0 && (vertexCount / 3) >= triangleBVHThreshold && (firstVertex % 3) == 0)
+    {
+        if (auto bvh = TriangleBVH::getOrCreate(arrayState, nullptr))
+        {
+            auto& ls = _lineSegmentStack[_lineSegmentDepth];
+            uint32_t firstTriangle = firstVertex / 3;
+            uint32_t endTriangle = endVertex / 3;
+            for (auto i : active())
+            {
+                dvec3 start(ls.sx[i], ls.sy[i], ls.sz[i]);
+                dvec3 end(start.x + ls.dx[i], start.y + ls.dy[i], start.z + ls.dz[i]);
+                bvh->intersect(start, end, [&](uint32_t triangle) {
+                    if (triangle >= firstTriangle && triangle < endTriangle) intersectTriangle(i, triangle * 3, triangle * 3 + 1, triangle * 3 + 2);
+                });
+            }
+            return _numIntersections != previous_numIntersections;
+        }
+    }
+
+    for (uint32_t i = firstVertex; i < endVertex; i += 3)
+    {
+        intersectTriangle(i, i + 1, i + 2);
+    }
+
+    return _numIntersections != previous_numIntersections;
+}
+
+bool MultiLineSegmentIntersector::intersectDrawIndexed(uint32_t firstIndex, uint32_t indexCount)
+{
+    auto& arrayState = arrayStateStack.back();
+    if (!arrayState.vertices || arrayState.topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST || indexCount == 0 || active().empty()) return false;
+
+    size_t previous_numIntersections = _numIntersections;
+    uint32_t endIndex = firstIndex + indexCount;
+
+    const Data* indices = ushort_indices ? static_cast<const Data*>(ushort_indices.get()) : static_cast<const Data*>(uint_indices.get());
+    if (indices && triangleBVHThreshold > 0 && (indexCount / 3) >= triangleBVHThreshold && (firstIndex % 3) == 0)
+    {
+        if (auto bvh = TriangleBVH::getOrCreate(arrayState, indices))
+        {
+            auto& ls = _lineSegmentStack[_lineSegmentDepth];
+            uint32_t firstTriangle = firstIndex / 3;
+            uint32_t endTriangle = endIndex / 3;
+            for (auto i : active())
+            {
+                dvec3 start(ls.sx[i], ls.sy[i], ls.sz[i]);
+                dvec3 end(start.x + ls.dx[i], start.y + ls.dy[i], start.z + ls.dz[i]);
+                bvh->intersect(start, end, [&](uint32_t triangle) {
+                    if (triangle >= firstTriangle && triangle < endTriangle)
+                    {
+                        const uint32_t* tri = &(bvh->indices[triangle * 3]);
+                        intersectTriangle(i, tri[0], tri[1], tri[2]);
+                    }
+                });
+            }
+            return _numIntersections != previous_numIntersections;
+        }
+    }
+
+    if (ushort_indices)
+    {
+        for (uint32_t i = firstIndex; i < endIndex; i += 3)
+        {
+            intersectTriangle(ushort_indices->at(i), ushort_indices->at(i + 1), ushort_indices->at(i + 2));
+        }
+    }
+    else if (uint_indices)
+    {
+        for (uint32_t i = firstIndex; i < endIndex; i += 3)
+        {
+            intersectTriangle(uint_indices->at(i), uint_indices->at(i + 1), uint_indices->at(i + 2));
+        }
+    }
+
+    return _numIntersections != previous_numIntersections;
+}
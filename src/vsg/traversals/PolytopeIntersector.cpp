@@ -0,0 +1,278 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/Options.h>
+#include <vsg/traversals/PolytopeIntersector.h>
+
+#include <algorithm>
+
+using namespace vsg;
+
+PolytopeIntersector::PolytopeIntersector(const Polytope& polytope)
+{
+    _polytopeStack.push_back(polytope);
+}
+
+PolytopeIntersector::PolytopeIntersector(const Camera& camera, double xMin, double yMin, double xMax, double yMax)
+{
+    auto viewport = camera.getViewport();
+
+    dvec2 ndcMin(-1.0, -1.0);
+    dvec2 ndcMax(1.0, 1.0);
+    if ((viewport.width > 0) && (viewport.height > 0))
+    {
+        ndcMin.set((std::min(xMin, xMax) - viewport.x) / viewport.width * 2.0 - 1.0, (std::min(yMin, yMax) - viewport.y) / viewport.height * 2.0 - 1.0);
+        ndcMax.set((std::max(xMin, xMax) - viewport.x) / viewport.width * 2.0 - 1.0, (std::max(yMin, yMax) - viewport.y) / viewport.height * 2.0 - 1.0);
+    }
+
+    dmat4 projectionMatrix;
+    camera.getProjectionMatrix()->get(projectionMatrix);
+
+    dmat4 viewMatrix;
+    camera.getViewMatrix()->get(viewMatrix);
+
+    auto projectionViewMatrix = projectionMatrix * viewMatrix;
+
+    // side planes in clip space, transformed into world coordinates
+    Polytope polytope{
+        dplane(1.0, 0.0, 0.0, -ndcMin.x) * projectionViewMatrix, // left plane
+        dplane(-1.0, 0.0, 0.0, ndcMax.x) * projectionViewMatrix, // right plane
+        dplane(0.0, 1.0, 0.0, -ndcMin.y) * projectionViewMatrix, // bottom plane
+        dplane(0.0, -1.0, 0.0, ndcMax.y) * projectionViewMatrix  // top plane
+    };
+
+    _polytopeStack.push_back(polytope);
+}
+
+void PolytopeIntersector::add(const dvec3& intersection, const uint32_t* primitiveIndices, uint32_t numIndices)
+{
+    std::vector<uint32_t> indices(primitiveIndices, primitiveIndices + numIndices);
+    if (_matrixStack.empty())
+    {
+        intersections.emplace_back(Intersection{intersection, intersection, {}, _nodePath, arrayStateStack.back().arrays, indices});
+    }
+    else
+    {
+        auto& localToWorld = _matrixStack.back();
+        intersections.emplace_back(Intersection{intersection, localToWorld * intersection, localToWorld, _nodePath, arrayStateStack.back().arrays, indices});
+    }
+}
+
+void PolytopeIntersector::pushTransform(const dmat4& m)
+{
+    dmat4 localToWorld = _matrixStack.empty() ? m : (_matrixStack.back() * m);
+
+    _matrixStack.push_back(localToWorld);
+
+    // planes transform by the transpose of the inverse of the transform applied to points, so world planes map to local planes with localToWorld
+    auto& worldPolytope = _polytopeStack.front();
+    Polytope localPolytope;
+    localPolytope.reserve(worldPolytope.size());
+    for (auto& pl : worldPolytope)
+    {
+        localPolytope.push_back(pl * localToWorld);
+    }
+
+    _polytopeStack.push_back(localPolytope);
+}
+
+void PolytopeIntersector::popTransform()
+{
+    _polytopeStack.pop_back();
+    _matrixStack.pop_back();
+}
+
+bool PolytopeIntersector::intersects(const dsphere& bs)
+{
+    if (!bs.valid()) return false;
+
+    return intersect(_polytopeStack.back(), bs);
+}
+
+bool PolytopeIntersector::intersectPrimitive(const uint32_t* primitiveIndices, uint32_t numIndices, dvec3& center)
+{
+    auto& vertices = *arrayStateStack.back().vertices;
+    auto& polytope = _polytopeStack.back();
+
+    _clipBuffer.clear();
+    for (uint32_t i = 0; i < numIndices; ++i)
+    {
+        _clipBuffer.emplace_back(vertices.at(primitiveIndices[i]));
+    }
+
+    // trivially accept primitives wholly inside the polytope and trivially reject those wholly outside any one plane
+    bool allInside = true;
+    for (auto& pl : polytope)
+    {
+        uint32_t numOutside = 0;
+        for (auto& v : _clipBuffer)
+        {
+            if (distance(pl, v) < 0.0) ++numOutside;
+        }
+
+        if (numOutside == numIndices) return false;
+        if (numOutside > 0) allInside = false;
+    }
+
+    // points can't be partially inside so only lines and triangles need clipping against each of the planes in turn
+    if (!allInside && numIndices == 2)
+    {
+        dvec3& v0 = _clipBuffer[0];
+        dvec3& v1 = _clipBuffer[1];
+        for (auto& pl : polytope)
+        {
+            double d0 = distance(pl, v0);
+            double d1 = distance(pl, v1);
+            if (d0 < 0.0 && d1 < 0.0) return false;
+            if (d0 < 0.0) v0 = v0 + (v1 - v0) * (d0 / (d0 - d1));
+            else if (d1 < 0.0) v1 = v0 + (v1 - v0) * (d0 / (d0 - d1));
+        }
+    }
+    else if (!allInside)
+    {
+        for (auto& pl : polytope)
+        {
+            _clipResult.clear();
+            size_t numVertices = _clipBuffer.size();
+            for (size_t i = 0; i < numVertices; ++i)
+            {
+                const dvec3& v0 = _clipBuffer[i];
+                const dvec3& v1 = _clipBuffer[(i + 1) % numVertices];
+                double d0 = distance(pl, v0);
+                double d1 = distance(pl, v1);
+
+                if (d0 >= 0.0) _clipResult.push_back(v0);
+                if ((d0 < 0.0 && d1 > 0.0) || (d0 > 0.0 && d1 < 0.0)) _clipResult.push_back(v0 + (v1 - v0) * (d0 / (d0 - d1)));
+            }
+
+            if (_clipResult.empty()) return false;
+            _clipBuffer.swap(_clipResult);
+        }
+    }
+
+    center.set(0.0, 0.0, 0.0);
+    for (auto& v : _clipBuffer) center += v;
+    center /= static_cast<double>(_clipBuffer.size());
+
+    return true;
+}
+
+template<typename GetIndex>
+bool PolytopeIntersector::intersectsDrawBound(uint32_t first, uint32_t count, GetIndex getIndex)
+{
+    // the bound isn't cached on the draw node as the node can be used with different vertex arrays, and the arrays may be modified
+    auto& vertices = *arrayStateStack.back().vertices;
+    uint32_t numVertices = static_cast<uint32_t>(vertices.size());
+
+    box bb;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        uint32_t index = getIndex(i);
+        if (index < numVertices) bb.add(vertices.at(index));
+    }
+
+    if (!bb.valid()) return false;
+
+    sphere bound((bb.min + bb.max) * 0.5f, length(bb.max - bb.min) * 0.5f);
+    return intersects(bound);
+}
+
+template<typename GetIndex>
+bool PolytopeIntersector::intersectPrimitives(uint32_t first, uint32_t count, GetIndex getIndex)
+{
+    auto& arrayState = arrayStateStack.back();
+
+    uint32_t primitiveSize = 0;
+    switch (arrayState.topology)
+    {
+    case (VK_PRIMITIVE_TOPOLOGY_POINT_LIST): primitiveSize = 1; break;
+    case (VK_PRIMITIVE_TOPOLOGY_LINE_LIST): primitiveSize = 2; break;
+    case (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST): primitiveSize = 3; break;
+    default: return false;
+    }
+
+    size_t previous_size = intersections.size();
+    uint32_t end = first + count;
+    uint32_t primitiveIndices[3];
+    dvec3 center;
+
+    for (uint32_t i = first; i + primitiveSize <= end; i += primitiveSize)
+    {
+        for (uint32_t j = 0; j < primitiveSize; ++j) primitiveIndices[j] = getIndex(i + j);
+
+        if (intersectPrimitive(primitiveIndices, primitiveSize, center))
+        {
+            add(center, primitiveIndices, primitiveSize);
+            if (intersectionMode == FIRST_PRIMITIVE) break;
+        }
+    }
+
+    return intersections.size() != previous_size;
+}
+
+bool PolytopeIntersector::intersectDraw(uint32_t firstVertex, uint32_t vertexCount)
+{
+    auto& arrayState = arrayStateStack.back();
+    if (!arrayState.vertices || vertexCount == 0) return false;
+
+    if (intersectionMode == BOUNDING_SPHERES)
+    {
+        // report the draw without testing its primitives if the bound of the vertices it covers intersects the polytope
+        uint32_t numVertices = static_cast<uint32_t>(arrayState.vertices->size());
+        if (firstVertex >= numVertices || !intersectsDrawBound(firstVertex, std::min(vertexCount, numVertices - firstVertex), [](uint32_t i) { return i; })) return false;
+
+        add(dvec3(arrayState.vertices->at(firstVertex)), nullptr, 0);
+        return true;
+    }
+
+    return intersectPrimitives(firstVertex, vertexCount, [](uint32_t i) { return i; });
+}
+
+bool PolytopeIntersector::intersectDrawIndexed(uint32_t firstIndex, uint32_t indexCount)
+{
+    auto& arrayState = arrayStateStack.back();
+    if (!arrayState.vertices || indexCount == 0 || (!ushort_indices && !uint_indices)) return false;
+
+    if (intersectionMode == BOUNDING_SPHERES)
+    {
+        uint32_t numIndices = static_cast<uint32_t>(ushort_indices ? ushort_indices->size() : uint_indices->size());
+        if (firstIndex >= numIndices) return false;
+
+        indexCount = std::min(indexCount, numIndices - firstIndex);
+
+        bool intersected = false;
+        if (ushort_indices)
+        {
+            intersected = intersectsDrawBound(firstIndex, indexCount, [this](uint32_t i) { return static_cast<uint32_t>(ushort_indices->at(i)); });
+        }
+        else
+        {
+            intersected = intersectsDrawBound(firstIndex, indexCount, [this](uint32_t i) { return uint_indices->at(i); });
+        }
+        if (!intersected) return false;
+
+        uint32_t index = ushort_indices ? ushort_indices->at(firstIndex) : uint_indices->at(firstIndex);
+        if (index >= arrayState.vertices->size()) return false;
+
+        add(dvec3(arrayState.vertices->at(index)), nullptr, 0);
+        return true;
+    }
+
+    if (ushort_indices)
+    {
+        return intersectPrimitives(firstIndex, indexCount, [this](uint32_t i) { return static_cast<uint32_t>(ushort_indices->at(i)); });
+    }
+    else
+    {
+        return intersectPrimitives(firstIndex, indexCount, [this](uint32_t i) { return uint_indices->at(i); });
+    }
+}
@@ -12,19 +12,24 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/commands/Command.h>
 #include <vsg/commands/Commands.h>
+#include <vsg/commands/Draw.h>
+#include <vsg/commands/DrawIndexed.h>
 #include <vsg/io/DatabasePager.h>
 #include <vsg/io/Options.h>
 #include <vsg/maths/plane.h>
 #include <vsg/nodes/CullGroup.h>
 #include <vsg/nodes/CullNode.h>
+#include <vsg/nodes/Geometry.h>
 #include <vsg/nodes/Group.h>
 #include <vsg/nodes/LOD.h>
 #include <vsg/nodes/MatrixTransform.h>
 #include <vsg/nodes/PagedLOD.h>
 #include <vsg/nodes/QuadGroup.h>
+#include <vsg/nodes/VertexIndexDraw.h>
 #include <vsg/state/StateGroup.h>
 #include <vsg/threading/atomics.h>
 #include <vsg/traversals/RecordTraversal.h>
+#include <vsg/traversals/TraversalStack.h>
 #include <vsg/ui/ApplicationEvent.h>
 #include <vsg/vk/CommandBuffer.h>
 #include <vsg/vk/RenderPass.h>
@@ -32,8 +37,32 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace vsg;
 
+#include <algorithm>
 #include <iostream>
 
+namespace
+{
+    /// count the draws and triangles of a Geometry's commands, dispatched through accept() so no runtime type checks are required
+    class CountDraws : public ConstVisitor
+    {
+    public:
+        uint64_t numDraws = 0;
+        uint64_t numTriangles = 0;
+
+        void apply(const Draw& draw) override
+        {
+            ++numDraws;
+            numTriangles += static_cast<uint64_t>(draw.vertexCount / 3) * draw.instanceCount;
+        }
+
+        void apply(const DrawIndexed& drawIndexed) override
+        {
+            ++numDraws;
+            numTriangles += static_cast<uint64_t>(drawIndexed.indexCount / 3) * drawIndexed.instanceCount;
+        }
+    };
+} // namespace
+
 #define INLINE_TRAVERSE 1
 #define USE_FRUSTUM_ARRAY 1
 
@@ -43,16 +72,40 @@ RecordTraversal::RecordTraversal(CommandBuffer* commandBuffer, uint32_t maxSlot,
 {
     if (_frameStamp) _frameStamp->ref();
     if (_state) _state->ref();
+
+    _views.push_back(_state);
 }
 
 RecordTraversal::~RecordTraversal()
 {
+    for (size_t i = 1; i < _views.size(); ++i) _views[i]->unref();
+
     if (_culledPagedLODs) _culledPagedLODs->unref();
     if (_databasePager) _databasePager->unref();
     if (_state) _state->unref();
     if (_frameStamp) _frameStamp->unref();
 }
 
+void RecordTraversal::setNumViews(uint32_t numViews)
+{
+    numViews = std::max(1u, std::min(numViews, 32u));
+
+    uint32_t maxSlot = static_cast<uint32_t>(_state->stateStacks.size()) - 1;
+    while (_views.size() < numViews)
+    {
+        auto state = new State(nullptr, maxSlot);
+        state->ref();
+        _views.push_back(state);
+    }
+    while (_views.size() > numViews)
+    {
+        _views.back()->unref();
+        _views.pop_back();
+    }
+
+    _viewMask = (numViews == 32) ? 0xffffffff : ((1u << numViews) - 1);
+}
+
 void RecordTraversal::setFrameStamp(FrameStamp* fs)
 {
     if (fs == _frameStamp) return;
@@ -83,15 +136,146 @@ void RecordTraversal::setProjectionAndViewMatrix(const dmat4& projMatrix, const
     _state->setProjectionAndViewMatrix(projMatrix, viewMatrix);
 }
 
+void RecordTraversal::setProjectionAndViewMatrix(uint32_t viewIndex, const dmat4& projMatrix, const dmat4& viewMatrix)
+{
+    _views[viewIndex]->setProjectionAndViewMatrix(projMatrix, viewMatrix);
+}
+
+RecordStatistics& RecordTraversal::getStatistics()
+{
+    return _state->statistics;
+}
+
+const RecordStatistics& RecordTraversal::getStatistics() const
+{
+    return _state->statistics;
+}
+
+RecordTraversal::ViewMask RecordTraversal::_visibleViews(const dsphere& bound)
+{
+    if (_views.size() == 1) return _state->intersect(bound) ? 1 : 0;
+
+    ViewMask visible = 0;
+    for (uint32_t i = 0; i < _views.size(); ++i)
+    {
+        ViewMask bit = 1u << i;
+        if ((_viewMask & bit) && _views[i]->intersect(bound)) visible |= bit;
+    }
+    return visible;
+}
+
+void RecordTraversal::_traverse(const Node& node, const ref_ptr<Node>* children, std::size_t numChildren, ViewMask viewMask)
+{
+    if (viewMask == _viewMask)
+    {
+        if (traversalStack)
+            traversalStack->push(node, children, numChildren);
+        else
+            node.traverse(*this);
+        return;
+    }
+
+    // subgraph only visible in some of the views so narrow the view mask until it's been visited
+    ViewMask previousViewMask = _viewMask;
+    _viewMask = viewMask;
+
+    if (traversalStack)
+        traversalStack->traverseChildren(node, children, numChildren, *this);
+    else
+        node.traverse(*this);
+
+    _viewMask = previousViewMask;
+}
+
+void RecordTraversal::_traverseChild(const Node& parent, const ref_ptr<Node>& child, ViewMask viewMask)
+{
+    if (viewMask == _viewMask)
+    {
+        if (traversalStack)
+            traversalStack->push(parent, &child, 1);
+        else if (child->validMask(traversalMask))
+            child->accept(*this);
+        return;
+    }
+
+    ViewMask previousViewMask = _viewMask;
+    _viewMask = viewMask;
+
+    if (traversalStack)
+        traversalStack->traverseChild(parent, child, *this);
+    else if (child->validMask(traversalMask))
+        child->accept(*this);
+
+    _viewMask = previousViewMask;
+}
+
+uint32_t RecordTraversal::_record(const Command& command)
+{
+    if (_views.size() == 1 || multiview)
+    {
+        _state->record();
+        command.record(*(_state->_commandBuffer));
+        return 1;
+    }
+
+    uint32_t numRecorded = 0;
+    for (uint32_t i = 0; i < _views.size(); ++i)
+    {
+        if (_viewMask & (1u << i))
+        {
+            auto state = _views[i];
+            state->record();
+            command.record(*(state->_commandBuffer));
+            ++numRecorded;
+        }
+    }
+    return numRecorded;
+}
+
+void RecordTraversal::restore(const Node& node, uint32_t restoreMarker)
+{
+    ViewMask stateViews = _stateViews();
+    for (uint32_t i = 0; i < _views.size(); ++i)
+    {
+        if ((stateViews & (1u << i)) == 0) continue;
+
+        auto state = _views[i];
+        if (restoreMarker & RESTORE_STATE)
+        {
+            for (auto& command : static_cast<const StateGroup&>(node).getStateCommands())
+            {
+                auto& stateStack = state->stateStacks[command->getSlot()];
+
+                // a state command still dirty when popped was never needed by a draw so its recording was elided
+                if (stateStack.dirty) ++state->statistics.numStateCommandsSkipped;
+
+                stateStack.pop();
+            }
+        }
+        if (restoreMarker & RESTORE_MATRIX) state->modelviewMatrixStack.pop();
+        if (restoreMarker & RESTORE_FRUSTUM) state->popFrustum();
+        state->dirty = true;
+    }
+}
+
 void RecordTraversal::apply(const Object& object)
 {
     //    std::cout<<"Visiting object"<<std::endl;
+    ++_state->statistics.numNodes;
     object.traverse(*this);
 }
 
 void RecordTraversal::apply(const Group& group)
 {
-//    std::cout<<"Visiting Group "<<std::endl;
+    //    std::cout<<"Visiting Group "<<std::endl;
+    ++_state->statistics.numNodes;
+
+    if (traversalStack)
+    {
+        traversalStack->push(group, group.getChildren().data(), group.getNumChildren());
+        return;
+    }
+
 #if INLINE_TRAVERSE
     vsg::Group::t_traverse(group, *this);
 #else
@@ -101,7 +285,15 @@ void RecordTraversal::apply(const Group& group)
 
 void RecordTraversal::apply(const QuadGroup& group)
 {
-//    std::cout<<"Visiting QuadGroup "<<std::endl;
+    //    std::cout<<"Visiting QuadGroup "<<std::endl;
+    ++_state->statistics.numNodes;
+
+    if (traversalStack)
+    {
+        traversalStack->push(group, group.getChildren(), 4);
+        return;
+    }
+
 #if INLINE_TRAVERSE
     vsg::QuadGroup::t_traverse(group, *this);
 #else
@@ -109,43 +301,98 @@ void RecordTraversal::apply(const QuadGroup& group)
 #endif
 }
 
+// return the projected height of the sphere and its distance from the eye point, used for LOD selection
+static inline std::pair<double, double> screenHeightAndDistance(const State& state, const dsphere& sphere)
+{
+    const auto& proj = state.projectionMatrixStack.top();
+    const auto& mv = state.modelviewMatrixStack.top();
+    auto f = -proj[1][1];
+
+    auto distance = std::abs(mv[0][2] * sphere.x + mv[1][2] * sphere.y + mv[2][2] * sphere.z + mv[3][2]);
+    auto rf = sphere.r * f;
+    return {rf, distance};
+}
+
+static inline RecordTraversal::ViewMask firstView(RecordTraversal::ViewMask viewMask)
+{
+    return viewMask & (~viewMask + 1);
+}
+
 void RecordTraversal::apply(const LOD& lod)
 {
+    ++_state->statistics.numNodes;
+
     auto sphere = lod.getBound();
 
     // check if lod bounding sphere is in view frustum.
-    if (!_state->intersect(sphere))
+    ViewMask visible = _visibleViews(sphere);
+    if (visible == 0)
     {
+        ++_state->statistics.numCulledByFrustum;
         return;
     }
 
-    const auto& proj = _state->projectionMatrixStack.top();
-    const auto& mv = _state->modelviewMatrixStack.top();
-    auto f = -proj[1][1];
+    if (_views.size() == 1 || shareLODSelection)
+    {
+        // select the child using the first visible view and traverse it for all the visible views
+        uint32_t viewIndex = 0;
+        while ((visible & (1u << viewIndex)) == 0) ++viewIndex;
 
-    auto distance = std::abs(mv[0][2] * sphere.x + mv[1][2] * sphere.y + mv[2][2] * sphere.z + mv[3][2]);
-    auto rf = sphere.r * f;
+        auto [rf, distance] = screenHeightAndDistance(*_views[viewIndex], sphere);
 
-    for (auto child : lod.getChildren())
+        for (auto& child : lod.getChildren())
+        {
+            bool child_visible = rf > (child.minimumScreenHeightRatio * distance);
+            if (child_visible)
+            {
+                _traverseChild(lod, child.node, visible);
+                return;
+            }
+        }
+
+        ++_state->statistics.numCulledByLOD;
+        return;
+    }
+
+    // select the child for each view, then traverse each selected child once for all the views that selected it
+    ViewMask remaining = visible;
+    for (auto& child : lod.getChildren())
     {
-        bool child_visible = rf > (child.minimumScreenHeightRatio * distance);
-        if (child_visible)
+        ViewMask selectedViews = 0;
+        for (uint32_t i = 0; i < _views.size(); ++i)
         {
-            child.node->accept(*this);
-            return;
+            ViewMask bit = 1u << i;
+            if ((remaining & bit) == 0) continue;
+
+            auto [rf, distance] = screenHeightAndDistance(*_views[i], sphere);
+            if (rf > (child.minimumScreenHeightRatio * distance)) selectedViews |= bit;
+        }
+
+        if (selectedViews != 0)
+        {
+            remaining &= ~selectedViews;
+            _traverseChild(lod, child.node, selectedViews);
+            if (remaining == 0) return;
         }
     }
+
+    if (remaining == visible) ++_state->statistics.numCulledByLOD;
 }
 
 void RecordTraversal::apply(const PagedLOD& plod)
 {
+    ++_state->statistics.numNodes;
+
     auto sphere = plod.getBound();
 
     auto frameCount = _frameStamp->frameCount;
 
     // check if lod bounding sphere is in view frustum.
-    if (!_state->intersect(sphere))
+    ViewMask visible = _visibleViews(sphere);
+    if (visible == 0)
     {
+        ++_state->statistics.numCulledByFrustum;
+
         if ((frameCount - plod.frameHighResLastUsed) > 1 && _culledPagedLODs)
         {
             _culledPagedLODs->highresCulled.emplace_back(&plod);
@@ -154,105 +401,130 @@ void RecordTraversal::apply(const PagedLOD& plod)
         return;
     }
 
-    const auto& proj = _state->projectionMatrixStack.top();
-    const auto& mv = _state->modelviewMatrixStack.top();
-    auto f = -proj[1][1];
+    const auto& highResChild = plod.getChild(0);
+    const auto& lowResChild = plod.getChild(1);
 
-    auto distance = std::abs(mv[0][2] * sphere.x + mv[1][2] * sphere.y + mv[2][2] * sphere.z + mv[3][2]);
-    auto rf = sphere.r * f;
+    // decide which views the high res and low res children are visible in, so that the children are traversed,
+    // and any request for the high res child made, once for all the views.
+    ViewMask highResViews = 0;
+    ViewMask lowResViews = 0;
+    double priority = 0.0;
+
+    ViewMask selectionViews = shareLODSelection ? firstView(visible) : visible;
+    for (uint32_t i = 0; i < _views.size(); ++i)
+    {
+        ViewMask bit = 1u << i;
+        if ((selectionViews & bit) == 0) continue;
+
+        auto [rf, distance] = screenHeightAndDistance(*_views[i], sphere);
+
+        auto cutoff = highResChild.minimumScreenHeightRatio * distance;
+        if (rf > cutoff)
+        {
+            highResViews |= bit;
+            priority = std::max(priority, rf / cutoff);
+        }
+
+        if (rf > lowResChild.minimumScreenHeightRatio * distance) lowResViews |= bit;
+    }
+
+    if (selectionViews != visible)
+    {
+        if (highResViews) highResViews = visible;
+        if (lowResViews) lowResViews = visible;
+    }
 
     // check the high res child to see if it's visible
+    if (highResViews)
     {
-        const auto& child = plod.getChild(0);
-        auto cutoff = child.minimumScreenHeightRatio * distance;
-        bool child_visible = rf > cutoff;
-        if (child_visible)
+        auto previousHighResUsed = plod.frameHighResLastUsed.exchange(frameCount);
+        if (_culledPagedLODs && ((frameCount - previousHighResUsed) > 1))
         {
-            auto previousHighResUsed = plod.frameHighResLastUsed.exchange(frameCount);
-            if (_culledPagedLODs && ((frameCount - previousHighResUsed) > 1))
-            {
-                _culledPagedLODs->newHighresRequired.emplace_back(&plod);
-            }
+            _culledPagedLODs->newHighresRequired.emplace_back(&plod);
+        }
+
+        if (highResChild.node)
+        {
+            // high res visible and availably so traverse it, the low res child is then only required by the views that don't use the high res child
+            lowResViews &= ~highResViews;
+            _traverseChild(plod, highResChild.node, highResViews);
+        }
+        else if (_databasePager)
+        {
+            exchange_if_greater(plod.priority, priority);
 
-            if (child.node)
+            auto previousRequestCount = plod.requestCount.fetch_add(1);
+            if (previousRequestCount == 0)
             {
-                // high res visible and availably so traverse it
-                child.node->accept(*this);
-                return;
+                // we are first request so tell the databasePager about it
+                ++_state->statistics.numPagedLODRequests;
+                _databasePager->request(ref_ptr<PagedLOD>(const_cast<PagedLOD*>(&plod)));
             }
-            else if (_databasePager)
+            else
             {
-                auto priority = rf / cutoff;
-                exchange_if_greater(plod.priority, priority);
-
-                auto previousRequestCount = plod.requestCount.fetch_add(1);
-                if (previousRequestCount == 0)
-                {
-                    // we are first request so tell the databasePager about it
-                    _databasePager->request(ref_ptr<PagedLOD>(const_cast<PagedLOD*>(&plod)));
-                }
-                else
-                {
-                    //std::cout<<"repeat request "<<&plod<<", "<<plod.requestCount.load()<<std::endl;;
-                }
+                //std::cout<<"repeat request "<<&plod<<", "<<plod.requestCount.load()<<std::endl;;
             }
         }
-        else
+    }
+    else
+    {
+        if (_culledPagedLODs && ((frameCount - plod.frameHighResLastUsed) <= 1))
         {
-            if (_culledPagedLODs && ((frameCount - plod.frameHighResLastUsed) <= 1))
-            {
-                _culledPagedLODs->highresCulled.emplace_back(&plod);
-            }
+            _culledPagedLODs->highresCulled.emplace_back(&plod);
         }
     }
 
     // check the low res child to see if it's visible
+    if (lowResViews)
     {
-        const auto& child = plod.getChild(1);
-        auto cutoff = child.minimumScreenHeightRatio * distance;
-        bool child_visible = rf > cutoff;
-        if (child_visible)
-        {
-            if (child.node)
-            {
-                child.node->accept(*this);
-            }
-        }
+        if (lowResChild.node) _traverseChild(plod, lowResChild.node, lowResViews);
+    }
+    else if (!highResViews || !highResChild.node)
+    {
+        ++_state->statistics.numCulledByLOD;
     }
 }
 
 void RecordTraversal::apply(const CullGroup& cullGroup)
 {
+    ++_state->statistics.numNodes;
+
 #if 0
     // no culling
     cullGroup.traverse(*this);
 #else
-    if (_state->intersect(cullGroup.getBound()))
+    ViewMask visible = _visibleViews(cullGroup.getBound());
+    if (visible != 0)
     {
         //std::cout<<"Passed node"<<std::endl;
-        cullGroup.traverse(*this);
+        _traverse(cullGroup, cullGroup.getChildren().data(), cullGroup.getNumChildren(), visible);
     }
     else
     {
         //std::cout<<"Culling node"<<std::endl;
+        ++_state->statistics.numCulledByFrustum;
     }
 #endif
 }
 
 void RecordTraversal::apply(const CullNode& cullNode)
 {
+    ++_state->statistics.numNodes;
+
 #if 0
     // no culling
     cullNode.traverse(*this);
 #else
-    if (_state->intersect(cullNode.getBound()))
+    ViewMask visible = _visibleViews(cullNode.getBound());
+    if (visible != 0)
     {
         //std::cout<<"Passed node"<<std::endl;
-        cullNode.traverse(*this);
+        _traverse(cullNode, &cullNode.getChildRef(), 1, visible);
     }
     else
     {
         //std::cout<<"Culling node"<<std::endl;
+        ++_state->statistics.numCulledByFrustum;
     }
 #endif
 }
@@ -260,62 +532,137 @@ void RecordTraversal::apply(const CullNode& cullNode)
 void RecordTraversal::apply(const StateGroup& stateGroup)
 {
     //    std::cout<<"Visiting StateGroup "<<std::endl;
+    ++_state->statistics.numNodes;
 
     const StateGroup::StateCommands& stateCommands = stateGroup.getStateCommands();
-    for (auto& command : stateCommands)
+
+    ViewMask stateViews = _stateViews();
+    for (uint32_t i = 0; i < _views.size(); ++i)
     {
-        _state->stateStacks[command->getSlot()].push(command);
-    }
-    _state->dirty = true;
+        if ((stateViews & (1u << i)) == 0) continue;
 
-    stateGroup.traverse(*this);
+        auto state = _views[i];
+        for (auto& command : stateCommands)
+        {
+            // subgraphs compiled after the State was sized by Viewer::compile(), such as paged tiles, may use slots beyond the end of its stateStacks
+            uint32_t slot = command->getSlot();
+            if (slot >= state->stateStacks.size()) state->stateStacks.resize(slot + 1);
 
-    for (auto& command : stateCommands)
+            state->stateStacks[slot].push(command);
+        }
+        state->dirty = true;
+    }
+
+    if (traversalStack)
     {
-        _state->stateStacks[command->getSlot()].pop();
+        // state is popped in restore() once the children have been visited
+        traversalStack->push(stateGroup, stateGroup.getChildren().data(), stateGroup.getNumChildren(), sizeof(ref_ptr<Node>), RESTORE_STATE);
+        return;
     }
-    _state->dirty = true;
+
+    stateGroup.traverse(*this);
+
+    restore(stateGroup, RESTORE_STATE);
 }
 
 void RecordTraversal::apply(const MatrixTransform& mt)
 {
-    if (mt.getSubgraphRequiresLocalFrustum())
-    {
-        _state->modelviewMatrixStack.pushAndPostMult(mt.getMatrix());
-        _state->pushFrustum();
-        _state->dirty = true;
+    ++_state->statistics.numNodes;
 
-        mt.traverse(*this);
+    uint32_t restoreMarker = mt.getSubgraphRequiresLocalFrustum() ? (RESTORE_MATRIX | RESTORE_FRUSTUM) : RESTORE_MATRIX;
 
-        _state->modelviewMatrixStack.pop();
-        _state->popFrustum();
-        _state->dirty = true;
-    }
-    else
+    ViewMask stateViews = _stateViews();
+    for (uint32_t i = 0; i < _views.size(); ++i)
     {
-        _state->modelviewMatrixStack.pushAndPostMult(mt.getMatrix());
-        _state->dirty = true;
+        if ((stateViews & (1u << i)) == 0) continue;
 
-        mt.traverse(*this);
+        auto state = _views[i];
+        state->modelviewMatrixStack.pushAndPostMult(mt.getMatrix());
+        if (restoreMarker & RESTORE_FRUSTUM) state->pushFrustum();
+        state->dirty = true;
+    }
 
-        _state->modelviewMatrixStack.pop();
-        _state->dirty = true;
+    if (traversalStack)
+    {
+        // matrices and frustum are popped in restore() once the children have been visited
+        traversalStack->push(mt, mt.getChildren().data(), mt.getNumChildren(), sizeof(ref_ptr<Node>), restoreMarker);
+        return;
     }
+
+    mt.traverse(*this);
+
+    restore(mt, restoreMarker);
 }
 
 // Vulkan nodes
 void RecordTraversal::apply(const Commands& commands)
 {
-    _state->record();
-    for (auto& command : commands.getChildren())
+    ++_state->statistics.numNodes;
+
+    // with multiview all the views are recorded into view 0's CommandBuffer
+    ViewMask recordViews = (multiview) ? 1 : _viewMask;
+    for (uint32_t i = 0; i < _views.size(); ++i)
     {
-        command->record(*(_state->_commandBuffer));
+        if ((recordViews & (1u << i)) == 0) continue;
+
+        auto state = _views[i];
+        state->record();
+        for (auto& command : commands.getChildren())
+        {
+            if (command->validMask(traversalMask)) command->record(*(state->_commandBuffer));
+        }
     }
 }
 
 void RecordTraversal::apply(const Command& command)
 {
     //    std::cout<<"Visiting Command "<<std::endl;
-    _state->record();
-    command.record(*(_state->_commandBuffer));
+    ++_state->statistics.numNodes;
+
+    _record(command);
+}
+
+void RecordTraversal::apply(const Draw& draw)
+{
+    auto& statistics = _state->statistics;
+    ++statistics.numNodes;
+
+    uint32_t numRecorded = _record(draw);
+    statistics.numDraws += numRecorded;
+    statistics.numTriangles += static_cast<uint64_t>(draw.vertexCount / 3) * draw.instanceCount * numRecorded;
+}
+
+void RecordTraversal::apply(const DrawIndexed& drawIndexed)
+{
+    auto& statistics = _state->statistics;
+    ++statistics.numNodes;
+
+    uint32_t numRecorded = _record(drawIndexed);
+    statistics.numDraws += numRecorded;
+    statistics.numTriangles += static_cast<uint64_t>(drawIndexed.indexCount / 3) * drawIndexed.instanceCount * numRecorded;
+}
+
+void RecordTraversal::apply(const VertexIndexDraw& vid)
+{
+    auto& statistics = _state->statistics;
+    ++statistics.numNodes;
+
+    uint32_t numRecorded = _record(vid);
+    statistics.numDraws += numRecorded;
+    statistics.numTriangles += static_cast<uint64_t>(vid.indexCount / 3) * vid.instanceCount * numRecorded;
+}
+
+void RecordTraversal::apply(const Geometry& geometry)
+{
+    auto& statistics = _state->statistics;
+    ++statistics.numNodes;
+
+    uint32_t numRecorded = _record(geometry);
+    if (numRecorded == 0) return;
+
+    CountDraws countDraws;
+    for (auto& command : geometry.commands) command->accept(countDraws);
+
+    statistics.numDraws += countDraws.numDraws * numRecorded;
+    statistics.numTriangles += countDraws.numTriangles * numRecorded;
 }
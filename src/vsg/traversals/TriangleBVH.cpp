@@ -0,0 +1,281 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/Options.h>
+#include <vsg/traversals/ArrayState.h>
+#include <vsg/traversals/TriangleBVH.h>
+
+#include <algorithm>
+#include <mutex>
+
+using namespace vsg;
+
+TriangleBVH::TriangleBVH()
+{
+}
+
+TriangleBVH::~TriangleBVH()
+{
+}
+
+bool TriangleBVH::builtFrom(const Data* in_sourceVertices, const Data* in_sourceIndices) const
+{
+    // a deleted source array converts to null so can't match a new array allocated at the same address
+    ref_ptr<Data> vertices = sourceVertices;
+    ref_ptr<Data> indices_ = sourceIndices;
+    return vertices.get() == in_sourceVertices && indices_.get() == in_sourceIndices;
+}
+
+bool TriangleBVH::valid(const Data* in_sourceVertices, const Data* in_sourceIndices, uint32_t in_numVertices) const
+{
+    if (!builtFrom(in_sourceVertices, in_sourceIndices) || numVertices != in_numVertices) return false;
+    if (in_sourceVertices && in_sourceVertices->differentModifiedCount(sourceVerticesModifiedCount)) return false;
+    if (in_sourceIndices && in_sourceIndices->differentModifiedCount(sourceIndicesModifiedCount)) return false;
+    return true;
+}
+
+namespace
+{
+    /// TriangleBVH cached on an array, one for each combination of vertex and index arrays the array has been used with
+    class CachedTriangleBVHs : public Inherit<Object, CachedTriangleBVHs>
+    {
+    public:
+        static constexpr size_t maxNumCached = 4;
+
+        std::vector<ref_ptr<TriangleBVH>> bvhs;
+    };
+
+    /// serializes access to the Auxiliary ObjectMap of the arrays holding cached TriangleBVH, held only for lookup and insertion
+    std::mutex s_cacheMutex;
+} // namespace
+
+ref_ptr<const TriangleBVH> TriangleBVH::getOrCreate(const ArrayState& arrayState, const Data* indices)
+{
+    // use the source array rather than any proxy vertex array as the proxy is rebuilt on each traversal
+    const Data* sourceVertices = arrayState.vertices;
+    if (arrayState.vertexAttribute.binding < arrayState.arrays.size() && arrayState.arrays[arrayState.vertexAttribute.binding])
+    {
+        sourceVertices = arrayState.arrays[arrayState.vertexAttribute.binding];
+    }
+
+    // the TriangleBVH is cached on the index array when there is one, otherwise on the vertex array
+    const Data* cacheHolder = indices ? indices : sourceVertices;
+    uint32_t numVertices = static_cast<uint32_t>(arrayState.vertices->valueCount());
+
+    ref_ptr<TriangleBVH> bvh;
+    {
+        std::scoped_lock<std::mutex> lock(s_cacheMutex);
+
+        // hacky but better to reuse results, same approach as used for caching the "bound" on VertexIndexDraw
+        auto cached = const_cast<CachedTriangleBVHs*>(cacheHolder->getObject<CachedTriangleBVHs>("TriangleBVH"));
+        if (!cached)
+        {
+            auto new_cached = CachedTriangleBVHs::create();
+            const_cast<Data*>(cacheHolder)->setObject("TriangleBVH", new_cached);
+            cached = new_cached.get();
+        }
+
+        auto itr = std::find_if(cached->bvhs.begin(), cached->bvhs.end(), [&](const ref_ptr<TriangleBVH>& candidate) {
+            return candidate->builtFrom(sourceVertices, indices);
+        });
+
+        if (itr != cached->bvhs.end() && (*itr)->valid(sourceVertices, indices, numVertices))
+        {
+            bvh = *itr;
+        }
+        else
+        {
+            // build into a new TriangleBVH as other threads may still be using the previous one
+            bvh = TriangleBVH::create();
+            bvh->sourceVertices = const_cast<Data*>(sourceVertices);
+            bvh->sourceIndices = const_cast<Data*>(indices);
+            bvh->sourceVerticesModifiedCount = sourceVertices->getModifiedCount();
+            bvh->sourceIndicesModifiedCount = indices ? indices->getModifiedCount() : 0;
+            bvh->numVertices = numVertices;
+
+            if (itr != cached->bvhs.end())
+            {
+                *itr = bvh;
+            }
+            else
+            {
+                if (cached->bvhs.size() >= CachedTriangleBVHs::maxNumCached) cached->bvhs.erase(cached->bvhs.begin());
+                cached->bvhs.push_back(bvh);
+            }
+        }
+    }
+
+    std::call_once(bvh->_built, [&]() { bvh->build(*arrayState.vertices, indices); });
+
+    return bvh;
+}
+
+void TriangleBVH::build(const vec3Array& vertices, const Data* in_indices)
+{
+    nodes.clear();
+    packets.clear();
+    indices.clear();
+
+    numVertices = static_cast<uint32_t>(vertices.valueCount());
+
+    if (auto ushort_indices = dynamic_cast<const ushortArray*>(in_indices))
+    {
+        indices.reserve(ushort_indices->valueCount());
+        for (auto index : *ushort_indices) indices.push_back(index);
+    }
+    else if (auto uint_indices = dynamic_cast<const uintArray*>(in_indices))
+    {
+        indices.reserve(uint_indices->valueCount());
+        for (auto index : *uint_indices) indices.push_back(index);
+    }
+    else
+    {
+        indices.resize(numVertices);
+        for (uint32_t i = 0; i < numVertices; ++i) indices[i] = i;
+    }
+
+    indices.resize((indices.size() / 3) * 3);
+
+    uint32_t numTriangles = static_cast<uint32_t>(indices.size() / 3);
+    if (numTriangles == 0) return;
+
+    std::vector<uint32_t> order;
+    std::vector<box> triangleBounds(numTriangles);
+    std::vector<vec3> centers(numTriangles);
+
+    order.reserve(numTriangles);
+    for (uint32_t t = 0; t < numTriangles; ++t)
+    {
+        const uint32_t* tri = &indices[t * 3];
+
+        // triangles referencing vertices outside the vertex array are left out of the hierarchy
+        if (tri[0] >= numVertices || tri[1] >= numVertices || tri[2] >= numVertices) continue;
+
+        box& bb = triangleBounds[t];
+        bb.add(vertices.at(tri[0]));
+        bb.add(vertices.at(tri[1]));
+        bb.add(vertices.at(tri[2]));
+        centers[t] = (bb.min + bb.max) * 0.5f;
+
+        order.push_back(t);
+    }
+
+    if (order.empty()) return;
+
+    nodes.reserve(2 * (order.size() / (PacketSize * MaxPacketsPerLeaf) + 1));
+    packets.reserve(order.size() / PacketSize + 1);
+
+    _build(order, 0, static_cast<uint32_t>(order.size()), triangleBounds, centers, vertices);
+}
+
+uint32_t TriangleBVH::_build(std::vector<uint32_t>& order, uint32_t begin, uint32_t end, const std::vector<box>& triangleBounds, const std::vector<vec3>& centers, const vec3Array& vertices)
+{
+    uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    box bounds;
+    box centerBounds;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const box& bb = triangleBounds[order[i]];
+        bounds.add(bb.min);
+        bounds.add(bb.max);
+        centerBounds.add(centers[order[i]]);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    vec3 extents = centerBounds.max - centerBounds.min;
+    int axis = (extents.x >= extents.y && extents.x >= extents.z) ? 0 : ((extents.y >= extents.z) ? 1 : 2);
+
+    uint32_t count = end - begin;
+    if (count <= PacketSize * MaxPacketsPerLeaf || extents[axis] <= 0.0f)
+    {
+        // leaf node, pack the triangles into packets
+        Node& node = nodes[nodeIndex];
+        node.first = static_cast<uint32_t>(packets.size());
+        node.count = (count + PacketSize - 1) / PacketSize;
+
+        for (uint32_t i = begin; i < end; i += PacketSize)
+        {
+            Packet& packet = packets.emplace_back();
+            for (uint32_t lane = 0; lane < PacketSize; ++lane)
+            {
+                if ((i + lane) < end)
+                {
+                    uint32_t t = order[i + lane];
+                    const vec3& v0 = vertices.at(indices[t * 3]);
+                    vec3 e1 = vertices.at(indices[t * 3 + 1]) - v0;
+                    vec3 e2 = vertices.at(indices[t * 3 + 2]) - v0;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        packet.v0[c][lane] = v0[c];
+                        packet.e1[c][lane] = e1[c];
+                        packet.e2[c][lane] = e2[c];
+                    }
+                    packet.triangles[lane] = t;
+                }
+                else
+                {
+                    // pad with degenerate triangles that the packet test always rejects
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        packet.v0[c][lane] = 0.0f;
+                        packet.e1[c][lane] = 0.0f;
+                        packet.e2[c][lane] = 0.0f;
+                    }
+                    packet.triangles[lane] = InvalidTriangle;
+                }
+            }
+        }
+        return nodeIndex;
+    }
+
+    // split at the median of the triangle centers along the longest axis
+    uint32_t mid = begin + count / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](uint32_t lhs, uint32_t rhs) { return centers[lhs][axis] < centers[rhs][axis]; });
+
+    _build(order, begin, mid, triangleBounds, centers, vertices);
+    uint32_t secondChild = _build(order, mid, end, triangleBounds, centers, vertices);
+
+    nodes[nodeIndex].first = secondChild;
+    nodes[nodeIndex].count = 0;
+
+    return nodeIndex;
+}
+
+bool TriangleBVH::intersects(const box& bb, const dvec3& start, const dvec3& d)
+{
+    // slab test of the line segment start to start+d against the box, with the segment parameterized from 0 to 1
+    double tmin = 0.0;
+    double tmax = 1.0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        double s = start[axis];
+        double lo = bb.min[axis];
+        double hi = bb.max[axis];
+        if (d[axis] == 0.0)
+        {
+            if (s < lo || s > hi) return false;
+        }
+        else
+        {
+            double inv = 1.0 / d[axis];
+            double t0 = (lo - s) * inv;
+            double t1 = (hi - s) * inv;
+            if (t0 > t1) std::swap(t0, t1);
+            if (t0 > tmin) tmin = t0;
+            if (t1 < tmax) tmax = t1;
+            if (tmin > tmax) return false;
+        }
+    }
+    return true;
+}
@@ -49,37 +49,24 @@ CommandGraph::~CommandGraph()
 
 void CommandGraph::reset()
 {
-    for (auto& ec : _executeCommands) ec->reset();
+    for (auto& ec : _executeCommands) ec.first->reset();
 }
 
-void CommandGraph::_connect(ExecuteCommands* ec)
+void CommandGraph::_connect(ExecuteCommands* ec, uint32_t viewIndex)
 {
-    _executeCommands.emplace_back(ec);
+    _executeCommands.emplace_back(ec, viewIndex);
 }
 
 void CommandGraph::_disconnect(ExecuteCommands* ec)
 {
-    auto itr = std::find(_executeCommands.begin(), _executeCommands.end(), ec);
+    auto itr = std::find_if(_executeCommands.begin(), _executeCommands.end(), [ec](const std::pair<ExecuteCommands*, uint32_t>& value) { return value.first == ec; });
     if (itr != _executeCommands.end()) _executeCommands.erase(itr);
 }
 
-void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameStamp> frameStamp, ref_ptr<DatabasePager> databasePager)
+ref_ptr<CommandBuffer> CommandGraph::_getOrCreateCommandBuffer(CommandBuffers& commandBuffers)
 {
-    if (window && !window->visible())
-    {
-        return;
-    }
-
-    if (!recordTraversal)
-    {
-        recordTraversal = new RecordTraversal(nullptr, maxSlot);
-    }
-
-    recordTraversal->setFrameStamp(frameStamp);
-    recordTraversal->setDatabasePager(databasePager);
-
     ref_ptr<CommandBuffer> commandBuffer;
-    for (auto& cb : _commandBuffers)
+    for (auto& cb : commandBuffers)
     {
         if (cb->numDependentSubmissions() == 0)
         {
@@ -91,7 +78,7 @@ void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameS
     {
         ref_ptr<CommandPool> cp = CommandPool::create(device, queueFamily);
         commandBuffer = CommandBuffer::create(device, cp, level);
-        _commandBuffers.push_back(commandBuffer);
+        commandBuffers.push_back(commandBuffer);
     }
     else
     {
@@ -100,10 +87,16 @@ void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameS
 
     commandBuffer->numDependentSubmissions().fetch_add(1);
 
-    recordTraversal->getState()->_commandBuffer = commandBuffer;
+    return commandBuffer;
+}
 
+void CommandGraph::_beginCommandBuffer(CommandBuffer& commandBuffer)
+{
     // or select index when maps to a dormant CommandBuffer
-    VkCommandBuffer vk_commandBuffer = *commandBuffer;
+    VkCommandBuffer vk_commandBuffer = commandBuffer;
+
+    // no buffers are bound at the start of a command buffer
+    commandBuffer.boundGeometryHeapBlock = nullptr;
 
     // need to set up the command
     // if we are nested within a CommandBuffer already then use VkCommandBufferInheritanceInfo
@@ -137,6 +130,49 @@ void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameS
     }
 
     vkBeginCommandBuffer(vk_commandBuffer, &beginInfo);
+}
+
+void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameStamp> frameStamp, ref_ptr<DatabasePager> databasePager)
+{
+    if (window && !window->visible())
+    {
+        return;
+    }
+
+    if (!recordTraversal)
+    {
+        recordTraversal = new RecordTraversal(nullptr, maxSlot);
+    }
+
+    uint32_t numViews = 1 + static_cast<uint32_t>(additionalCameras.size());
+    recordTraversal->setNumViews(numViews);
+    recordTraversal->multiview = multiview;
+    recordTraversal->shareLODSelection = shareLODSelection;
+
+    recordTraversal->setFrameStamp(frameStamp);
+    recordTraversal->setDatabasePager(databasePager);
+    for (uint32_t viewIndex = 0; viewIndex < numViews; ++viewIndex)
+    {
+        recordTraversal->getState(viewIndex)->statistics.reset();
+    }
+
+    // view 0 and, unless recording multiview, a CommandBuffer for each additional view
+    CommandBuffers viewCommandBuffers;
+    viewCommandBuffers.push_back(_getOrCreateCommandBuffer(_commandBuffers));
+    if (!multiview)
+    {
+        _additionalViewCommandBuffers.resize(numViews - 1);
+        for (auto& commandBuffers : _additionalViewCommandBuffers)
+        {
+            viewCommandBuffers.push_back(_getOrCreateCommandBuffer(commandBuffers));
+        }
+    }
+
+    for (uint32_t viewIndex = 0; viewIndex < viewCommandBuffers.size(); ++viewIndex)
+    {
+        recordTraversal->getState(viewIndex)->_commandBuffer = viewCommandBuffers[viewIndex];
+        _beginCommandBuffer(*viewCommandBuffers[viewIndex]);
+    }
 
     if (camera)
     {
@@ -147,20 +183,43 @@ void CommandGraph::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameS
         recordTraversal->setProjectionAndViewMatrix(projMatrix, viewMatrix);
     }
 
-    accept(*recordTraversal);
+    for (uint32_t viewIndex = 1; viewIndex < numViews; ++viewIndex)
+    {
+        auto& additionalCamera = additionalCameras[viewIndex - 1];
+
+        dmat4 projMatrix, viewMatrix;
+        additionalCamera->getProjectionMatrix()->get(projMatrix);
+        additionalCamera->getViewMatrix()->get(viewMatrix);
+
+        recordTraversal->setProjectionAndViewMatrix(viewIndex, projMatrix, viewMatrix);
+    }
+
+    if (traversalStack)
+        traversalStack->traverse(*this, *recordTraversal);
+    else
+        accept(*recordTraversal);
 
-    vkEndCommandBuffer(vk_commandBuffer);
+    for (auto& commandBuffer : viewCommandBuffers)
+    {
+        vkEndCommandBuffer(*commandBuffer);
+    }
+
+    // gather the state statistics of the additional views
+    for (uint32_t viewIndex = 1; viewIndex < numViews; ++viewIndex)
+    {
+        recordTraversal->getStatistics() += recordTraversal->getState(viewIndex)->statistics;
+    }
 
     if (level == VK_COMMAND_BUFFER_LEVEL_SECONDARY)
     {
         // pass oon this command buffer to conencted ExecuteCommands nodes
-        for (auto& ec : _executeCommands)
+        for (auto& [ec, viewIndex] : _executeCommands)
         {
-            ec->completed(commandBuffer);
+            ec->completed(viewIndex < viewCommandBuffers.size() ? viewCommandBuffers[viewIndex] : ref_ptr<CommandBuffer>());
         }
     }
 
-    recordedCommandBuffers.push_back(commandBuffer);
+    recordedCommandBuffers.insert(recordedCommandBuffers.end(), viewCommandBuffers.begin(), viewCommandBuffers.end());
 }
 
 ref_ptr<CommandGraph> vsg::createCommandGraphForView(Window* window, Camera* camera, Node* scenegraph, VkSubpassContents contents)
@@ -28,10 +28,10 @@ ExecuteCommands::~ExecuteCommands()
     }
 }
 
-void ExecuteCommands::connect(ref_ptr<CommandGraph> commandGraph)
+void ExecuteCommands::connect(ref_ptr<CommandGraph> commandGraph, uint32_t viewIndex)
 {
     _commandGraphs.emplace_back(commandGraph);
-    commandGraph->_connect(this);
+    commandGraph->_connect(this, viewIndex);
 }
 
 void ExecuteCommands::reset()
@@ -65,8 +65,7 @@ VkResult RecordAndSubmitTask::start()
     auto current_fence = fence();
     if (current_fence->hasDependencies())
     {
-        uint64_t timeout = std::numeric_limits<uint64_t>::max();
-        if (VkResult result; (result = current_fence->wait(timeout)) != VK_SUCCESS) return result;
+        if (VkResult result; (result = current_fence->wait(waitTimeout)) != VK_SUCCESS) return result;
 
         current_fence->resetFenceAndDependencies();
     }
@@ -75,6 +74,11 @@ VkResult RecordAndSubmitTask::start()
 
 VkResult RecordAndSubmitTask::record(CommandBuffers& recordedCommandBuffers, ref_ptr<FrameStamp> frameStamp)
 {
+    if (dynamicUniformRing)
+    {
+        if (VkResult result = dynamicUniformRing->beginFrame(frameStamp ? frameStamp->frameCount : dynamicUniformRing->frameCount(), waitTimeout); result != VK_SUCCESS) return result;
+    }
+
     for (auto& commandGraph : commandGraphs)
     {
         commandGraph->record(recordedCommandBuffers, frameStamp, databasePager);
@@ -109,6 +113,8 @@ VkResult RecordAndSubmitTask::finish(CommandBuffers& recordedCommandBuffers)
 
     current_fence->dependentSemaphores() = signalSemaphores;
 
+    if (dynamicUniformRing) dynamicUniformRing->addFence(current_fence);
+
     for (auto& window : windows)
     {
         auto imageIndex = window->imageIndex();
@@ -147,13 +153,33 @@ VkResult RecordAndSubmitTask::finish(CommandBuffers& recordedCommandBuffers)
         }
     }
 
+    // timeline semaphores can be waited on by any number of submissions so don't need tracking, but require the value to wait on,
+    // with a value for each wait semaphore where the values of binary semaphores are ignored.
+    std::vector<uint64_t> vk_waitSemaphoreValues;
+    if (databasePager && !databasePager->getTimelineSemaphores().empty())
+    {
+        vk_waitSemaphoreValues.resize(vk_waitSemaphores.size(), 0);
+        for (auto& [semaphore, value] : databasePager->getTimelineSemaphores())
+        {
+            vk_waitSemaphores.emplace_back(*semaphore);
+            vk_waitStages.emplace_back(semaphore->pipelineStageFlags());
+            vk_waitSemaphoreValues.emplace_back(value);
+        }
+    }
+
     for (auto& semaphore : signalSemaphores)
     {
         vk_signalSemaphores.emplace_back(*(semaphore));
     }
 
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(vk_waitSemaphoreValues.size());
+    timelineInfo.pWaitSemaphoreValues = vk_waitSemaphoreValues.data();
+
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    if (!vk_waitSemaphoreValues.empty()) submitInfo.pNext = &timelineInfo;
 
     submitInfo.waitSemaphoreCount = static_cast<uint32_t>(vk_waitSemaphores.size());
     submitInfo.pWaitSemaphores = vk_waitSemaphores.data();
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Options.h>
 #include <vsg/state/StateGroup.h>
 #include <vsg/traversals/RecordTraversal.h>
+#include <vsg/traversals/TraversalStack.h>
 #include <vsg/viewer/RenderGraph.h>
 #include <vsg/vk/Context.h>
 #include <vsg/vk/State.h>
@@ -158,6 +159,21 @@ void RenderGraph::accept(RecordTraversal& recordTraversal) const
     VkCommandBuffer vk_commandBuffer = *(recordTraversal.getState()->_commandBuffer);
     vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, contents);
 
+    // additional views recording into their own primary CommandBuffers need the render pass begun in each of them
+    uint32_t numViewRenderPasses = 1;
+    if (!recordTraversal.multiview)
+    {
+        for (uint32_t viewIndex = 1; viewIndex < recordTraversal.getNumViews(); ++viewIndex)
+        {
+            auto commandBuffer = recordTraversal.getState(viewIndex)->_commandBuffer;
+            if (!commandBuffer || commandBuffer->level() != VK_COMMAND_BUFFER_LEVEL_PRIMARY || *commandBuffer == vk_commandBuffer) break;
+
+            renderPassInfo.renderArea = (viewIndex <= additionalRenderAreas.size()) ? additionalRenderAreas[viewIndex - 1] : renderArea;
+            vkCmdBeginRenderPass(*commandBuffer, &renderPassInfo, contents);
+            ++numViewRenderPasses;
+        }
+    }
+
     if (camera)
     {
         dmat4 projMatrix, viewMatrix;
@@ -168,9 +184,17 @@ void RenderGraph::accept(RecordTraversal& recordTraversal) const
     }
 
     // traverse the command buffer to place the commands into the command buffer.
-    traverse(recordTraversal);
+    if (recordTraversal.traversalStack)
+        recordTraversal.traversalStack->traverseChildren(*this, _children.data(), _children.size(), recordTraversal);
+    else
+        traverse(recordTraversal);
 
     vkCmdEndRenderPass(vk_commandBuffer);
+
+    for (uint32_t viewIndex = 1; viewIndex < numViewRenderPasses; ++viewIndex)
+    {
+        vkCmdEndRenderPass(*(recordTraversal.getState(viewIndex)->_commandBuffer));
+    }
 }
 
 ref_ptr<RenderGraph> vsg::createRenderGraphForView(Window* window, Camera* camera, Node* scenegraph, VkSubpassContents contents)
@@ -38,6 +38,16 @@ Viewer::~Viewer()
 
     // don't destroy viewer while devices are still active
     deviceWaitIdle();
+
+    savePipelineCaches();
+}
+
+void Viewer::savePipelineCaches() const
+{
+    for (auto& [device, pipelineCache] : _pipelineCaches)
+    {
+        if (!pipelineCache->filename.empty()) pipelineCache->save(pipelineCache->filename);
+    }
 }
 
 void Viewer::deviceWaitIdle() const
@@ -244,6 +254,39 @@ void Viewer::compile(BufferPreferences bufferPreferences)
         deviceResource.compile->context.commandPool = vsg::CommandPool::create(device, queueFamily);
         deviceResource.compile->context.graphicsQueue = device->getQueue(queueFamily);
 
+        // use the dedicated transfer queue for buffer uploads when the Device was created with one
+        auto transferQueueFamily = physicalDevice->getDedicatedQueueFamily(VK_QUEUE_TRANSFER_BIT);
+        if (transferQueueFamily >= 0 && device->hasQueueFamily(transferQueueFamily))
+        {
+            deviceResource.compile->context.transferCommandPool = vsg::CommandPool::create(device, transferQueueFamily);
+            deviceResource.compile->context.transferQueue = device->getQueue(transferQueueFamily);
+
+            // the pooled buffers and staging ring are sub-allocated between many uploads so are shared concurrently by the graphics and transfer queue families
+            std::vector<uint32_t> queueFamilyIndices{static_cast<uint32_t>(queueFamily), static_cast<uint32_t>(transferQueueFamily)};
+            deviceResource.compile->context.deviceMemoryBufferPools->concurrentQueueFamilyIndices = queueFamilyIndices;
+            deviceResource.compile->context.stagingMemoryBufferPools->concurrentQueueFamilyIndices = queueFamilyIndices;
+        }
+
+        // share a single PipelineCache per Device across compiles, loading it from file on first use when required
+        auto& pipelineCache = _pipelineCaches[device];
+        if (!pipelineCache)
+        {
+            if (options && !options->pipelineCacheFilename.empty())
+                pipelineCache = vsg::PipelineCache::load(device, vsg::PipelineCache::deviceFilename(options->pipelineCacheFilename, device->getPhysicalDevice()));
+            else
+                pipelineCache = vsg::PipelineCache::create(device);
+        }
+        deviceResource.compile->context.pipelineCache = pipelineCache;
+
+        // share a single DynamicUniformRing per Device between the RecordAndSubmitTask that record the dynamic uniforms compiled for it
+        bool usesDynamicBuffers = collectStats.descriptorTypeMap.count(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) > 0 || collectStats.descriptorTypeMap.count(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) > 0;
+        if (usesDynamicBuffers && bufferPreferences.dynamicUniformRingFrameSize > 0)
+        {
+            auto& dynamicUniformRing = _dynamicUniformRings[device];
+            if (!dynamicUniformRing) dynamicUniformRing = vsg::DynamicUniformRing::create(device, bufferPreferences.dynamicUniformRingFrameSize);
+            deviceResource.compile->context.dynamicUniformRing = dynamicUniformRing;
+        }
+
         if (descriptorPoolSizes.size() > 0) deviceResource.compile->context.descriptorPool = vsg::DescriptorPool::create(device, maxSets, descriptorPoolSizes);
     }
 
@@ -264,6 +307,8 @@ void Viewer::compile(BufferPreferences bufferPreferences)
             commandGraph->maxSlot = deviceResource.collectStats.maxSlot;
             commandGraph->accept(*deviceResource.compile);
 
+            if (deviceResource.compile->context.dynamicUniformRing) task->dynamicUniformRing = deviceResource.compile->context.dynamicUniformRing;
+
             if (deviceResource.collectStats.containsPagedLOD) task_containsPagedLOD = true;
         }
 
@@ -479,8 +524,9 @@ void Viewer::setupThreading()
                 // wait for this frame to be signalled
                 while (data->frameBlock->wait_for_change(frameStamp))
                 {
-                    // primary thread starts the task
+                    // primary thread starts the task, and the frame of its DynamicUniformRing before any of the task's threads record
                     data->task->start();
+                    if (data->task->dynamicUniformRing) data->task->dynamicUniformRing->beginFrame(frameStamp->frameCount, data->task->waitTimeout);
 
                     data->recordStartBarrier->arrive_and_wait();
 
@@ -596,3 +642,16 @@ void Viewer::present()
         presentation->present();
     }
 }
+
+RecordStatistics Viewer::getRecordStatistics() const
+{
+    RecordStatistics statistics;
+    for (auto& recordAndSubmitTask : recordAndSubmitTasks)
+    {
+        for (auto& commandGraph : recordAndSubmitTask->commandGraphs)
+        {
+            if (commandGraph->recordTraversal) statistics += commandGraph->recordTraversal->getStatistics();
+        }
+    }
+    return statistics;
+}
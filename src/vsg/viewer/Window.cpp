@@ -15,10 +15,13 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Options.h>
 #include <vsg/ui/ApplicationEvent.h>
 #include <vsg/viewer/Window.h>
+#include <vsg/vk/Extensions.h>
 #include <vsg/vk/SubmitCommands.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstring>
 
 using namespace vsg;
 
@@ -75,6 +78,9 @@ void Window::_initInstance()
         instanceExtensions.push_back("VK_KHR_surface");
         instanceExtensions.push_back(instanceExtensionSurfaceName());
 
+        // enable VK_KHR_get_physical_device_properties2 when available so that the extension features can be queried and enabled on the VK_API_VERSION_1_0 Instance
+        if (isExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
         vsg::Names requestedLayers;
         if (_traits->debugLayer || _traits->apiDumpLayer)
         {
@@ -149,7 +155,25 @@ void Window::_initDevice()
         auto [physicalDevice, queueFamily, presentFamily] = _instance->getPhysicalDeviceAndQueueFamily(_traits->queueFlags, _surface);
         if (!physicalDevice || queueFamily < 0 || presentFamily < 0) throw Exception{"Error: vsg::Window::create(...) failed to create Window, no Vulkan PhysicalDevice supported.", VK_ERROR_INVALID_EXTERNAL_HANDLE};
 
+        // enable VK_EXT_memory_budget when available so that the DatabasePager can track the device memory budget, it's queried via VK_KHR_get_physical_device_properties2 so requires that on the Instance
+        auto requested = [&deviceExtensions](const char* extensionName) {
+            return std::find_if(deviceExtensions.begin(), deviceExtensions.end(), [extensionName](const char* name) { return std::strcmp(name, extensionName) == 0; }) != deviceExtensions.end();
+        };
+        bool hasProperties2 = _instance->supportsInstanceExtension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        if (hasProperties2 && !requested(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) && physicalDevice->supportsDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        // enable VK_KHR_timeline_semaphore when available so that uploads can be synchronized with the frame and transfer queue submissions without blocking,
+        // it depends on VK_KHR_get_physical_device_properties2 and Device only enables it when the timelineSemaphore feature is supported
+        if (hasProperties2 && !requested(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) && physicalDevice->supportsDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+        // enable VK_KHR_descriptor_update_template when available so that DescriptorSets are written with a single templated update
+        if (!requested(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME) && physicalDevice->supportsDeviceExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)) deviceExtensions.push_back(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+
         vsg::QueueSettings queueSettings{vsg::QueueSetting{queueFamily, {1.0}}, vsg::QueueSetting{presentFamily, {1.0}}};
+
+        // request a queue from a dedicated transfer queue family when one exists, used for uploading buffers
+        int transferFamily = physicalDevice->getDedicatedQueueFamily(VK_QUEUE_TRANSFER_BIT);
+        if (transferFamily >= 0) queueSettings.push_back(vsg::QueueSetting{transferFamily, {1.0}});
         _device = vsg::Device::create(physicalDevice, queueSettings, validatedNames, deviceExtensions, _instance->getAllocationCallbacks());
         _physicalDevice = physicalDevice;
     }
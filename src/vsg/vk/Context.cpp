@@ -25,6 +25,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/vk/RenderPass.h>
 #include <vsg/vk/State.h>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace vsg;
@@ -66,6 +67,22 @@ void BuildAccelerationStructureCommand::record(CommandBuffer& commandBuffer) con
     vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_NV, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_NV, 0, 1, &memoryBarrier, 0, 0, 0, 0);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// vsg::createTimelineSemaphore
+//
+ref_ptr<Semaphore> vsg::createTimelineSemaphore(Device* device, VkPipelineStageFlags pipelineStageFlags, uint64_t initialValue)
+{
+    if (!device->supportsDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) return {};
+
+    VkSemaphoreTypeCreateInfoKHR semaphoreTypeCreateInfo = {};
+    semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    semaphoreTypeCreateInfo.initialValue = initialValue;
+
+    return Semaphore::create(device, pipelineStageFlags, &semaphoreTypeCreateInfo);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 //
 // vsg::Context
@@ -77,6 +94,13 @@ Context::Context(Device* in_device, BufferPreferences bufferPreferences) :
     stagingMemoryBufferPools(MemoryBufferPools::create("Staging_MemoryBufferPool", device, bufferPreferences)),
     scratchBufferSize(0)
 {
+    descriptorPools = DescriptorPools::create(device);
+
+    if (bufferPreferences.useGeometryHeap)
+    {
+        geometryHeap = GeometryHeap::create(bufferPreferences.geometryHeapVertexCapacity, bufferPreferences.geometryHeapIndexCapacity);
+    }
+
     //semaphore = vsg::Semaphore::create(device);
     scratchMemory = ScratchMemory::create(4096);
 }
@@ -87,13 +111,20 @@ Context::Context(const Context& context) :
     renderPass(context.renderPass),
     defaultPipelineStates(context.defaultPipelineStates),
     overridePipelineStates(context.overridePipelineStates),
+    pipelineCache(context.pipelineCache),
     descriptorPool(context.descriptorPool),
     graphicsQueue(context.graphicsQueue),
     commandPool(context.commandPool),
+    transferQueue(context.transferQueue),
+    transferCommandPool(context.transferCommandPool),
     deviceMemoryBufferPools(context.deviceMemoryBufferPools),
     stagingMemoryBufferPools(context.stagingMemoryBufferPools),
+    geometryHeap(context.geometryHeap),
+    dynamicUniformRing(context.dynamicUniformRing),
     scratchBufferSize(context.scratchBufferSize)
 {
+    descriptorPools = DescriptorPools::create(device);
+
     scratchMemory = ScratchMemory::create(4096);
 }
 
@@ -112,6 +143,51 @@ ref_ptr<CommandBuffer> Context::getOrCreateCommandBuffer()
     return commandBuffer;
 }
 
+ref_ptr<StagingRing> Context::getOrCreateStagingRing()
+{
+    if (!stagingRing)
+    {
+        VkDeviceSize stagingRingSize = stagingMemoryBufferPools->bufferPreferences.stagingRingSize;
+        if (stagingRingSize > 0) stagingRing = StagingRing::create(device, stagingRingSize, stagingMemoryBufferPools->concurrentQueueFamilyIndices);
+    }
+
+    return stagingRing;
+}
+
+void Context::copy(const BufferInfo& source, const BufferInfo& destination, bool releaseSource)
+{
+    if (!copyAndReleaseBuffer)
+    {
+        copyAndReleaseBuffer = CopyAndReleaseBuffer::create();
+        commands.emplace_back(copyAndReleaseBuffer);
+    }
+    // regions of the stagingRing are retired by the ring once the submission completes rather than released by the command
+    copyAndReleaseBuffer->add(source, destination, releaseSource && !(stagingRing && stagingRing->owns(source.buffer)));
+}
+
+void Context::copy(const BufferInfo& source, const ImageInfo& destination, uint32_t mipLevels)
+{
+    if (!copyAndReleaseImage)
+    {
+        copyAndReleaseImage = CopyAndReleaseImage::create();
+        commands.emplace_back(copyAndReleaseImage);
+    }
+    copyAndReleaseImage->add(source, destination, mipLevels, !(stagingRing && stagingRing->owns(source.buffer)));
+}
+
+bool Context::sharedWithTransferQueue() const
+{
+    if (!graphicsQueue || !transferQueue) return false;
+
+    auto shared = [&](const MemoryBufferPools* pools) {
+        if (!pools) return false;
+        auto& families = pools->concurrentQueueFamilyIndices;
+        return std::count(families.begin(), families.end(), graphicsQueue->queueFamilyIndex()) > 0 && std::count(families.begin(), families.end(), transferQueue->queueFamilyIndex()) > 0;
+    };
+
+    return shared(deviceMemoryBufferPools) && shared(stagingMemoryBufferPools);
+}
+
 void Context::record()
 {
     if (commands.empty() && buildAccelerationStructureCommands.empty()) return;
@@ -133,13 +209,53 @@ void Context::record()
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
+    // submit the batched buffer copies to the dedicated transfer queue, the pooled buffers and the stagingRing must be shared concurrently with the transfer queue's family
+    // as many uploads share each buffer, so ownership of individual ranges can't be transferred.
+    ref_ptr<CopyAndReleaseBuffer> transferCopies;
+    uint64_t transferValue = 0;
+    if (transferQueue && transferCommandPool && timelineSemaphore && copyAndReleaseBuffer && copyAndReleaseBuffer->size() > 0 && transferQueue->queueFamilyIndex() != graphicsQueue->queueFamilyIndex() && sharedWithTransferQueue())
+    {
+        transferCopies = copyAndReleaseBuffer;
+
+        if (!transferCommandBuffer) transferCommandBuffer = CommandBuffer::create(device, transferCommandPool);
+
+        vkBeginCommandBuffer(*transferCommandBuffer, &beginInfo);
+        transferCopies->record(*transferCommandBuffer);
+        vkEndCommandBuffer(*transferCommandBuffer);
+
+        transferValue = ++timelineValue;
+
+        VkTimelineSemaphoreSubmitInfoKHR transferTimelineInfo = {};
+        transferTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        transferTimelineInfo.signalSemaphoreValueCount = 1;
+        transferTimelineInfo.pSignalSemaphoreValues = &transferValue;
+
+        VkSubmitInfo transferSubmitInfo = {};
+        transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        transferSubmitInfo.pNext = &transferTimelineInfo;
+        transferSubmitInfo.commandBufferCount = 1;
+        transferSubmitInfo.pCommandBuffers = transferCommandBuffer->data();
+        transferSubmitInfo.signalSemaphoreCount = 1;
+        transferSubmitInfo.pSignalSemaphores = timelineSemaphore->data();
+
+        transferQueue->submit(transferSubmitInfo);
+    }
+
     vkBeginCommandBuffer(*commandBuffer, &beginInfo);
+    commandBuffer->boundGeometryHeapBlock = nullptr;
 
     // issue commands of interest
     {
-        for (auto& command : commands) command->record(*commandBuffer);
+        for (auto& command : commands)
+        {
+            if (command.get() != transferCopies.get()) command->record(*commandBuffer);
+        }
     }
 
+    // start new batches of buffer and image copies for the next submission
+    copyAndReleaseBuffer = {};
+    copyAndReleaseImage = {};
+
     // create scratch buffer and issue build acceleration sctructure commands
     ref_ptr<Buffer> scratchBuffer;
     ref_ptr<DeviceMemory> scratchBufferMemory;
@@ -160,12 +276,38 @@ void Context::record()
     vkEndCommandBuffer(*commandBuffer);
 
     VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    VkPipelineStageFlags transferWaitDstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    uint64_t signalValue = 0;
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = commandBuffer->data();
-    if (semaphore)
+    if (timelineSemaphore)
+    {
+        // wait on any transfer queue copies, then signal the next value that submissions using the uploaded data wait on
+        if (transferValue > 0)
+        {
+            timelineInfo.waitSemaphoreValueCount = 1;
+            timelineInfo.pWaitSemaphoreValues = &transferValue;
+
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = timelineSemaphore->data();
+            submitInfo.pWaitDstStageMask = &transferWaitDstStageMask;
+        }
+
+        signalValue = ++timelineValue;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = timelineSemaphore->data();
+    }
+    else if (semaphore)
     {
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = semaphore->data();
@@ -177,9 +319,18 @@ void Context::record()
         submitInfo.pSignalSemaphores = nullptr;
     }
 
+    if (stagingRing) stagingRingSubmission = stagingRing->submit();
+
     graphicsQueue->submit(submitInfo, fence);
 }
 
+bool Context::completed() const
+{
+    if (!fence || (commands.empty() && buildAccelerationStructureCommands.empty())) return true;
+
+    return fence->status() == VK_SUCCESS;
+}
+
 void Context::waitForCompletion()
 {
     if (!commandBuffer || !fence)
@@ -206,7 +357,13 @@ void Context::waitForCompletion()
         {
             std::cout << "Context::waitForCompletion()  " << this << " fence->wait() failed with error. VkResult = " << result << std::endl;
         }
+        else if (stagingRing)
+        {
+            stagingRing->retire(stagingRingSubmission);
+        }
     }
 
     commands.clear();
+    copyAndReleaseBuffer = {};
+    copyAndReleaseImage = {};
 }
@@ -16,7 +16,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace vsg;
 
-DescriptorPool::DescriptorPool(Device* device, uint32_t maxSets, const DescriptorPoolSizes& descriptorPoolSizes) :
+DescriptorPool::DescriptorPool(Device* device, uint32_t maxSets, const DescriptorPoolSizes& descriptorPoolSizes, VkDescriptorPoolCreateFlags flags) :
+    _maxSets(maxSets),
     _device(device)
 {
     VkDescriptorPoolCreateInfo poolInfo = {};
@@ -24,7 +25,7 @@ DescriptorPool::DescriptorPool(Device* device, uint32_t maxSets, const Descripto
     poolInfo.poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size());
     poolInfo.pPoolSizes = descriptorPoolSizes.data();
     poolInfo.maxSets = maxSets;
-    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; // will we need VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT later?
+    poolInfo.flags = flags;
     poolInfo.pNext = nullptr;
 
     if (VkResult result = vkCreateDescriptorPool(*device, &poolInfo, _device->getAllocationCallbacks(), &_descriptorPool); result != VK_SUCCESS)
@@ -40,3 +41,35 @@ DescriptorPool::~DescriptorPool()
         vkDestroyDescriptorPool(*_device, _descriptorPool, _device->getAllocationCallbacks());
     }
 }
+
+VkDescriptorSet DescriptorPool::allocateDescriptorSet(VkDescriptorSetLayout descriptorSetLayout)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_numAllocatedSets >= _maxSets) return VK_NULL_HANDLE;
+
+    VkDescriptorSetAllocateInfo descriptSetAllocateInfo = {};
+    descriptSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descriptSetAllocateInfo.descriptorPool = _descriptorPool;
+    descriptSetAllocateInfo.descriptorSetCount = 1;
+    descriptSetAllocateInfo.pSetLayouts = &descriptorSetLayout;
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    if (vkAllocateDescriptorSets(*_device, &descriptSetAllocateInfo, &descriptorSet) != VK_SUCCESS) return VK_NULL_HANDLE;
+
+    ++_numAllocatedSets;
+    return descriptorSet;
+}
+
+void DescriptorPool::freeDescriptorSet(VkDescriptorSet descriptorSet)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    vkFreeDescriptorSets(*_device, _descriptorPool, 1, &descriptorSet);
+
+    // once drained reset the pool so that it's free of any fragmentation when reused
+    if (--_numAllocatedSets == 0)
+    {
+        vkResetDescriptorPool(*_device, _descriptorPool, 0);
+    }
+}
@@ -0,0 +1,119 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Exception.h>
+#include <vsg/io/Options.h>
+#include <vsg/vk/DescriptorPools.h>
+
+#include <algorithm>
+
+using namespace vsg;
+
+DescriptorPools::DescriptorPools(Device* device) :
+    _device(device)
+{
+}
+
+DescriptorPools::~DescriptorPools()
+{
+}
+
+DescriptorPools::Signature DescriptorPools::_signature(const DescriptorSetLayout* descriptorSetLayout)
+{
+    Signature signature;
+    for (auto& binding : descriptorSetLayout->bindings)
+    {
+        if (binding.descriptorCount == 0) continue;
+
+        auto itr = std::find_if(signature.begin(), signature.end(), [&](const Signature::value_type& entry) { return entry.first == binding.descriptorType; });
+        if (itr != signature.end())
+            itr->second += binding.descriptorCount;
+        else
+            signature.emplace_back(binding.descriptorType, binding.descriptorCount);
+    }
+    std::sort(signature.begin(), signature.end());
+    return signature;
+}
+
+ref_ptr<DescriptorPool> DescriptorPools::allocate(DescriptorSetLayout* descriptorSetLayout, VkDescriptorSet& descriptorSet)
+{
+    VkDescriptorSetLayout vk_descriptorSetLayout = descriptorSetLayout->vk(_device->deviceID);
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // layouts created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT must be allocated from pools with the matching flag
+    VkDescriptorPoolCreateFlags poolFlags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    if (descriptorSetLayout->flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT) poolFlags |= VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+
+    auto& pools = _signaturePools[{poolFlags, _signature(descriptorSetLayout)}];
+
+    // search from the most recently created pool as it's the largest and least likely to be full
+    for (auto itr = pools.rbegin(); itr != pools.rend(); ++itr)
+    {
+        auto& pool = *itr;
+        if (pool->full()) continue;
+
+        descriptorSet = pool->allocateDescriptorSet(vk_descriptorSetLayout);
+        if (descriptorSet) return pool;
+    }
+
+    // all pools are full so add a new pool
+    uint32_t maxSets = minimumSetsPerPool;
+    for (size_t i = 0; i < pools.size() && maxSets < maximumSetsPerPool; ++i) maxSets *= 2;
+    maxSets = std::max(1u, std::min(maxSets, maximumSetsPerPool));
+
+    DescriptorPoolSizes poolSizes;
+    for (auto& [type, count] : _signature(descriptorSetLayout))
+    {
+        poolSizes.push_back(VkDescriptorPoolSize{type, count * maxSets});
+    }
+
+    // a pool must have at least one pool size, even for layouts without bindings
+    if (poolSizes.empty()) poolSizes.push_back(VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1});
+
+    auto pool = DescriptorPool::create(_device, maxSets, poolSizes, poolFlags);
+    pools.push_back(pool);
+
+    descriptorSet = pool->allocateDescriptorSet(vk_descriptorSetLayout);
+    if (!descriptorSet)
+    {
+        throw Exception{"Error: Failed to allocate DescriptorSet.", VK_ERROR_OUT_OF_POOL_MEMORY};
+    }
+    return pool;
+}
+
+void DescriptorPools::releaseUnusedPools()
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    for (auto& [key, pools] : _signaturePools)
+    {
+        pools.erase(std::remove_if(pools.begin(), pools.end(), [](const ref_ptr<DescriptorPool>& pool) { return pool->numAllocatedSets() == 0; }), pools.end());
+    }
+}
+
+DescriptorPools::Statistics DescriptorPools::getStatistics() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    Statistics statistics;
+    for (auto& [key, pools] : _signaturePools)
+    {
+        for (auto& pool : pools)
+        {
+            ++statistics.numPools;
+            statistics.maxSets += pool->maxSets();
+            statistics.numAllocatedSets += pool->numAllocatedSets();
+        }
+    }
+    return statistics;
+}
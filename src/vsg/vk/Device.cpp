@@ -16,6 +16,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/viewer/Window.h>
 #include <vsg/vk/Device.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <set>
 
@@ -96,33 +98,93 @@ Device::Device(PhysicalDevice* physicalDevice, const QueueSettings& queueSetting
 
         queueCreateInfo.pNext = nullptr;
         queueCreateInfos.push_back(queueCreateInfo);
+
+        _queueFamilyIndices.insert(queueCreateInfo.queueFamilyIndex);
     }
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+    Names extensionNames = deviceExtensions;
+    auto requested = [&extensionNames](const char* extensionName) {
+        return std::find_if(extensionNames.begin(), extensionNames.end(), [extensionName](const char* name) { return std::strcmp(name, extensionName) == 0; }) != extensionNames.end();
+    };
+
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = nullptr;
+
+    // enable the descriptor indexing features used by BindlessTextures that the physical device supports when VK_EXT_descriptor_indexing is requested
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures = {};
+    if (requested(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        // VK_EXT_descriptor_indexing depends on VK_KHR_maintenance3
+        if (!requested(VK_KHR_MAINTENANCE3_EXTENSION_NAME)) extensionNames.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedFeatures = {};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &supportedFeatures;
+
+        if (physicalDevice->getFeatures2(features2))
+        {
+            descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+            descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = supportedFeatures.shaderSampledImageArrayNonUniformIndexing;
+            descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = supportedFeatures.descriptorBindingSampledImageUpdateAfterBind;
+            descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = supportedFeatures.descriptorBindingUpdateUnusedWhilePending;
+            descriptorIndexingFeatures.descriptorBindingPartiallyBound = supportedFeatures.descriptorBindingPartiallyBound;
+            descriptorIndexingFeatures.runtimeDescriptorArray = supportedFeatures.runtimeDescriptorArray;
+            descriptorIndexingFeatures.pNext = const_cast<void*>(createInfo.pNext);
+            createInfo.pNext = &descriptorIndexingFeatures;
+        }
+    }
+
+    // enable timeline semaphores used by Context uploads when VK_KHR_timeline_semaphore is requested and the physical device supports the timelineSemaphore feature,
+    // otherwise the extension isn't enabled so that supportsDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) reports timeline semaphores as unavailable.
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {};
+    if (requested(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR supportedFeatures = {};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &supportedFeatures;
+
+        if (physicalDevice->getFeatures2(features2) && supportedFeatures.timelineSemaphore)
+        {
+            timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+            timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+            timelineSemaphoreFeatures.pNext = const_cast<void*>(createInfo.pNext);
+            createInfo.pNext = &timelineSemaphoreFeatures;
+        }
+        else
+        {
+            extensionNames.erase(std::remove_if(extensionNames.begin(), extensionNames.end(), [](const char* name) { return std::strcmp(name, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0; }), extensionNames.end());
+        }
+    }
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.empty() ? nullptr : queueCreateInfos.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.empty() ? nullptr : deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensionNames.size());
+    createInfo.ppEnabledExtensionNames = extensionNames.empty() ? nullptr : extensionNames.data();
 
     createInfo.enabledLayerCount = static_cast<uint32_t>(layers.size());
     createInfo.ppEnabledLayerNames = layers.empty() ? nullptr : layers.data();
 
-    createInfo.pNext = nullptr;
-
     VkResult result = vkCreateDevice(*physicalDevice, &createInfo, allocator, &_device);
     if (result != VK_SUCCESS)
     {
         releaseDeiviceID(deviceID);
         throw Exception{"Error: vsg::Device::create(...) failed to create logical device.", result};
     }
+
+    for (auto extensionName : extensionNames) _enabledExtensions.insert(extensionName);
 }
 
 Device::~Device()
@@ -155,3 +217,44 @@ ref_ptr<Queue> Device::getQueue(uint32_t queueFamilyIndex, uint32_t queueIndex)
 
     return queue;
 }
+
+Device::MemoryBudget Device::getDeviceLocalMemoryBudget() const
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {};
+    memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+
+    // the budget is returned through vkGetPhysicalDeviceMemoryProperties2KHR, so requires VK_KHR_get_physical_device_properties2 on the Instance as well as VK_EXT_memory_budget
+    bool hasMemoryBudget = false;
+    if (supportsDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        memoryProperties2.pNext = &budgetProperties;
+        hasMemoryBudget = _physicalDevice->getMemoryProperties2(memoryProperties2);
+    }
+
+    if (!hasMemoryBudget)
+    {
+        vkGetPhysicalDeviceMemoryProperties(*_physicalDevice, &memoryProperties2.memoryProperties);
+    }
+
+    MemoryBudget memoryBudget;
+    auto& memoryProperties = memoryProperties2.memoryProperties;
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+    {
+        if ((memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) continue;
+
+        if (hasMemoryBudget)
+        {
+            memoryBudget.budget += budgetProperties.heapBudget[i];
+            memoryBudget.usage += budgetProperties.heapUsage[i];
+        }
+        else
+        {
+            memoryBudget.budget += memoryProperties.memoryHeaps[i].size;
+        }
+    }
+
+    return memoryBudget;
+}
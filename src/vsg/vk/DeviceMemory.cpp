@@ -14,10 +14,15 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Options.h>
 #include <vsg/vk/DeviceMemory.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <iostream>
 
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
 using namespace vsg;
 
 #define DO_CHECK 0
@@ -26,51 +31,306 @@ using namespace vsg;
 //
 // MemorySlots
 //
-MemorySlots::MemorySlots(VkDeviceSize availableMemorySize)
+static inline uint32_t mostSignificantBit(uint64_t value)
 {
-    _availableMemory.insert(SizeOffset(availableMemorySize, 0));
-    _offsetSizes.insert(OffsetSize(0, availableMemorySize));
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+}
 
-    _totalMemorySize = availableMemorySize;
+static inline uint32_t leastSignificantBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
 }
 
-VkDeviceSize MemorySlots::totalAvailableSize() const
+MemorySlots::MemorySlots(VkDeviceSize availableMemorySize) :
+    _totalMemorySize(availableMemorySize)
 {
-    VkDeviceSize totalSize = 0;
-    for (const auto& sizeOffset : _availableMemory)
+    uint32_t firstLevel = 0, secondLevel = 0;
+    if (availableMemorySize > 0) mapping(availableMemorySize, firstLevel, secondLevel);
+
+    _numFirstLevels = firstLevel + 1;
+    _secondLevelBitmaps.resize(_numFirstLevels, 0);
+    _freeLists.resize(_numFirstLevels * SECOND_LEVEL_COUNT, INVALID_BLOCK);
+
+    if (availableMemorySize > 0)
     {
-        totalSize += sizeOffset.first;
+        uint32_t index = createBlock();
+        _blocks[index].size = availableMemorySize;
+        insertAvailableBlock(index);
+
+        _totalAvailableSize = availableMemorySize;
     }
-    return totalSize;
 }
 
-VkDeviceSize MemorySlots::totalReservedSize() const
+void MemorySlots::mapping(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel) const
 {
-    VkDeviceSize totalSize = 0;
-    for (const auto& sizeOffset : _reservedOffsetSizes)
+    if (size < SECOND_LEVEL_COUNT)
+    {
+        // small sizes are all held in the first level, one free list per size
+        firstLevel = 0;
+        secondLevel = static_cast<uint32_t>(size);
+    }
+    else
     {
-        totalSize += sizeOffset.second;
+        uint32_t msb = mostSignificantBit(size);
+        firstLevel = msb - SECOND_LEVEL_BITS + 1;
+        secondLevel = static_cast<uint32_t>(size >> (msb - SECOND_LEVEL_BITS)) & (SECOND_LEVEL_COUNT - 1);
     }
-    return totalSize;
 }
 
-bool MemorySlots::check() const
+uint32_t MemorySlots::findAvailableBlock(VkDeviceSize size) const
 {
-    if (_availableMemory.size() != _offsetSizes.size())
+    // round up the size to the next free list so that any block in the selected free list is large enough
+    if (size >= SECOND_LEVEL_COUNT) size += (VkDeviceSize(1) << (mostSignificantBit(size) - SECOND_LEVEL_BITS)) - 1;
+
+    uint32_t firstLevel, secondLevel;
+    mapping(size, firstLevel, secondLevel);
+    if (firstLevel >= _numFirstLevels) return INVALID_BLOCK;
+
+    uint32_t secondLevelBitmap = _secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelBitmap == 0)
     {
-        std::cout << "Warning: MemorySlots::check() _availableMemory.size() " << _availableMemory.size() << " != _offsetSizes.size() " << _offsetSizes.size() << std::endl;
+        if (firstLevel + 1 >= 64) return INVALID_BLOCK;
+
+        uint64_t firstLevelBitmap = _firstLevelBitmap & (~uint64_t(0) << (firstLevel + 1));
+        if (firstLevelBitmap == 0) return INVALID_BLOCK;
+
+        firstLevel = leastSignificantBit(firstLevelBitmap);
+        secondLevelBitmap = _secondLevelBitmaps[firstLevel];
     }
 
-    VkDeviceSize availableSize = 0;
-    for (auto& offsetSize : _offsetSizes)
+    secondLevel = leastSignificantBit(secondLevelBitmap);
+    return _freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+}
+
+void MemorySlots::insertAvailableBlock(uint32_t index)
+{
+    uint32_t firstLevel, secondLevel;
+    mapping(_blocks[index].size, firstLevel, secondLevel);
+
+    uint32_t& head = _freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+
+    auto& block = _blocks[index];
+    block.available = true;
+    block.previousFree = INVALID_BLOCK;
+    block.nextFree = head;
+    if (head != INVALID_BLOCK) _blocks[head].previousFree = index;
+    head = index;
+
+    _firstLevelBitmap |= (uint64_t(1) << firstLevel);
+    _secondLevelBitmaps[firstLevel] |= (1u << secondLevel);
+
+    ++_numAvailableBlocks;
+}
+
+void MemorySlots::removeAvailableBlock(uint32_t index)
+{
+    uint32_t firstLevel, secondLevel;
+    mapping(_blocks[index].size, firstLevel, secondLevel);
+
+    auto& block = _blocks[index];
+    block.available = false;
+
+    if (block.previousFree != INVALID_BLOCK) _blocks[block.previousFree].nextFree = block.nextFree;
+    if (block.nextFree != INVALID_BLOCK) _blocks[block.nextFree].previousFree = block.previousFree;
+
+    uint32_t& head = _freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+    if (head == index)
+    {
+        head = block.nextFree;
+        if (head == INVALID_BLOCK)
+        {
+            _secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (_secondLevelBitmaps[firstLevel] == 0) _firstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+        }
+    }
+
+    block.previousFree = INVALID_BLOCK;
+    block.nextFree = INVALID_BLOCK;
+
+    --_numAvailableBlocks;
+}
+
+uint32_t MemorySlots::createBlock()
+{
+    uint32_t index = _unusedBlocks;
+    if (index != INVALID_BLOCK)
     {
-        availableSize += offsetSize.second;
+        _unusedBlocks = _blocks[index].nextFree;
+        _blocks[index] = Block{};
     }
+    else
+    {
+        index = static_cast<uint32_t>(_blocks.size());
+        _blocks.emplace_back();
+    }
+    return index;
+}
 
+void MemorySlots::destroyBlock(uint32_t index)
+{
+    _blocks[index] = Block{};
+    _blocks[index].nextFree = _unusedBlocks;
+    _unusedBlocks = index;
+}
+
+uint32_t MemorySlots::splitBlock(uint32_t index, VkDeviceSize size)
+{
+    // createBlock() may reallocate _blocks so only take references after it
+    uint32_t remainderIndex = createBlock();
+
+    auto& block = _blocks[index];
+    auto& remainder = _blocks[remainderIndex];
+
+    remainder.offset = block.offset + size;
+    remainder.size = block.size - size;
+    remainder.previousPhysical = index;
+    remainder.nextPhysical = block.nextPhysical;
+    if (block.nextPhysical != INVALID_BLOCK) _blocks[block.nextPhysical].previousPhysical = remainderIndex;
+
+    block.size = size;
+    block.nextPhysical = remainderIndex;
+
+    return remainderIndex;
+}
+
+size_t MemorySlots::reservedBlockHash(VkDeviceSize offset) const
+{
+    // Fibonacci hashing, reserved offsets are usually aligned so the low bits alone are a poor hash.
+    uint64_t hash = static_cast<uint64_t>(offset) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(hash >> 32) & (_reservedBlocks.size() - 1);
+}
+
+void MemorySlots::insertReservedBlock(uint32_t index)
+{
+    // keep the load factor at or below 1/2
+    if ((_numReservedBlocks + 1) * 2 > _reservedBlocks.size())
+    {
+        std::vector<uint32_t> previousReservedBlocks(std::max(size_t(16), _reservedBlocks.size() * 2), INVALID_BLOCK);
+        previousReservedBlocks.swap(_reservedBlocks);
+
+        for (auto reservedIndex : previousReservedBlocks)
+        {
+            if (reservedIndex == INVALID_BLOCK) continue;
+
+            size_t mask = _reservedBlocks.size() - 1;
+            size_t position = reservedBlockHash(_blocks[reservedIndex].offset);
+            while (_reservedBlocks[position] != INVALID_BLOCK) position = (position + 1) & mask;
+            _reservedBlocks[position] = reservedIndex;
+        }
+    }
+
+    size_t mask = _reservedBlocks.size() - 1;
+    size_t position = reservedBlockHash(_blocks[index].offset);
+    while (_reservedBlocks[position] != INVALID_BLOCK) position = (position + 1) & mask;
+    _reservedBlocks[position] = index;
+
+    ++_numReservedBlocks;
+}
+
+uint32_t MemorySlots::removeReservedBlock(VkDeviceSize offset)
+{
+    if (_numReservedBlocks == 0) return INVALID_BLOCK;
+
+    size_t mask = _reservedBlocks.size() - 1;
+    size_t position = reservedBlockHash(offset);
+    while (_reservedBlocks[position] != INVALID_BLOCK && _blocks[_reservedBlocks[position]].offset != offset) position = (position + 1) & mask;
+
+    uint32_t index = _reservedBlocks[position];
+    if (index == INVALID_BLOCK) return INVALID_BLOCK;
+
+    // backward shift deletion, move following entries of the probe sequence into the vacated position so that lookups don't need tombstones.
+    _reservedBlocks[position] = INVALID_BLOCK;
+    size_t next = position;
+    while (true)
+    {
+        next = (next + 1) & mask;
+        uint32_t nextIndex = _reservedBlocks[next];
+        if (nextIndex == INVALID_BLOCK) break;
+
+        size_t home = reservedBlockHash(_blocks[nextIndex].offset);
+        bool homeInRange = (position <= next) ? (position < home && home <= next) : (position < home || home <= next);
+        if (homeInRange) continue;
+
+        _reservedBlocks[position] = nextIndex;
+        _reservedBlocks[next] = INVALID_BLOCK;
+        position = next;
+    }
+
+    --_numReservedBlocks;
+    return index;
+}
+
+VkDeviceSize MemorySlots::maximumAvailableSpace() const
+{
+    if (_firstLevelBitmap == 0) return 0;
+
+    uint32_t firstLevel = mostSignificantBit(_firstLevelBitmap);
+    uint32_t secondLevel = mostSignificantBit(_secondLevelBitmaps[firstLevel]);
+
+    VkDeviceSize maximumSize = 0;
+    for (uint32_t index = _freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel]; index != INVALID_BLOCK; index = _blocks[index].nextFree)
+    {
+        maximumSize = std::max(maximumSize, _blocks[index].size);
+    }
+    return maximumSize;
+}
+
+bool MemorySlots::check() const
+{
+    VkDeviceSize availableSize = 0;
     VkDeviceSize reservedSize = 0;
-    for (auto& offsetSize : _reservedOffsetSizes)
+    VkDeviceSize expectedOffset = 0;
+    size_t numAvailableBlocks = 0;
+    size_t numReservedBlocks = 0;
+
+    if (!_blocks.empty())
     {
-        reservedSize += offsetSize.second;
+        for (uint32_t index = 0; index != INVALID_BLOCK; index = _blocks[index].nextPhysical)
+        {
+            auto& block = _blocks[index];
+            if (block.offset != expectedOffset)
+            {
+                std::cout << "Warning: MemorySlots::check() block " << index << " offset " << block.offset << " != expected offset " << expectedOffset << std::endl;
+            }
+            if (block.available && block.nextPhysical != INVALID_BLOCK && _blocks[block.nextPhysical].available)
+            {
+                std::cout << "Warning: MemorySlots::check() adjacent available blocks at offset " << block.offset << " not merged" << std::endl;
+            }
+
+            expectedOffset = block.offset + block.size;
+            if (block.available)
+            {
+                availableSize += block.size;
+                ++numAvailableBlocks;
+            }
+            else
+            {
+                reservedSize += block.size;
+                ++numReservedBlocks;
+            }
+        }
+    }
+
+    if (numAvailableBlocks != _numAvailableBlocks || numReservedBlocks != _numReservedBlocks)
+    {
+        std::cout << "Warning: MemorySlots::check() number of available blocks " << numAvailableBlocks << " and reserved blocks " << numReservedBlocks << " inconsistent with _numAvailableBlocks " << _numAvailableBlocks << " and _numReservedBlocks " << _numReservedBlocks << std::endl;
+    }
+
+    if (availableSize != _totalAvailableSize || reservedSize != _totalReservedSize)
+    {
+        std::cout << "Warning: MemorySlots::check() computed availableSize (" << availableSize << ") and reservedSize (" << reservedSize << ") inconsistent with _totalAvailableSize (" << _totalAvailableSize << ") and _totalReservedSize (" << _totalReservedSize << ")" << std::endl;
     }
 
     VkDeviceSize computedSize = availableSize + reservedSize;
@@ -91,190 +351,174 @@ bool MemorySlots::check() const
 void MemorySlots::report() const
 {
     std::cout << "MemorySlots::report()" << std::endl;
-    for (auto& [offset, size] : _offsetSizes)
+    if (_blocks.empty()) return;
+
+    for (uint32_t index = 0; index != INVALID_BLOCK; index = _blocks[index].nextPhysical)
     {
-        std::cout << "    available " << offset << ", " << size << std::endl;
+        auto& block = _blocks[index];
+        std::cout << (block.available ? "    available " : "    reserved ") << std::dec << block.offset << ", " << block.size << std::endl;
     }
+}
 
-    for (auto& [offset, size] : _reservedOffsetSizes)
+MemorySlots::Ranges MemorySlots::reservedRanges() const
+{
+    Ranges ranges;
+    if (_blocks.empty()) return ranges;
+
+    ranges.reserve(_numReservedBlocks);
+    for (uint32_t index = 0; index != INVALID_BLOCK; index = _blocks[index].nextPhysical)
     {
-        std::cout << "    reserved " << std::dec << offset << ", " << size << std::endl;
+        auto& block = _blocks[index];
+        if (!block.available) ranges.emplace_back(block.offset, block.size);
     }
+    return ranges;
 }
 
 MemorySlots::OptionalOffset MemorySlots::reserve(VkDeviceSize size, VkDeviceSize alignment)
 {
     if (full()) return OptionalOffset(false, 0);
 
-    auto itr = _availableMemory.lower_bound(size);
-    while (itr != _availableMemory.end())
+    // reserved blocks are looked up by offset so each must occupy at least one byte
+    if (size == 0) size = 1;
+    if (alignment == 0) alignment = 1;
+
+    auto alignedStart = [&](uint32_t index) -> VkDeviceSize {
+        return ((_blocks[index].offset + alignment - 1) / alignment) * alignment;
+    };
+
+    auto fits = [&](uint32_t index) -> bool {
+        auto& block = _blocks[index];
+        return (alignedStart(index) + size) <= (block.offset + block.size);
+    };
+
+    // good fit search, the first block found is large enough for size but may not be large enough once aligned
+    uint32_t index = findAvailableBlock(size);
+    if (index != INVALID_BLOCK && !fits(index))
     {
-        SizeOffset slot(*itr);
-        VkDeviceSize slotStart = slot.second;
-        VkDeviceSize slotSize = slot.first;
-        VkDeviceSize slotEnd = slotStart + slotSize;
+        // any block large enough for the worst case alignment padding fits
+        index = findAvailableBlock(size + alignment - 1);
+    }
 
-        VkDeviceSize alignedStart = ((slotStart + alignment - 1) / alignment) * alignment;
-        VkDeviceSize alignedEnd = alignedStart + size;
-        VkDeviceSize alignedSize = alignedEnd - slotStart;
+    if (index == INVALID_BLOCK)
+    {
+        // fallback to an exhaustive search of the free lists that may contain a block large enough, only required when memory is close to full
+        uint32_t startFirstLevel, startSecondLevel;
+        mapping(size, startFirstLevel, startSecondLevel);
 
-        if (alignedSize <= slotSize)
+        for (uint32_t firstLevel = startFirstLevel; firstLevel < _numFirstLevels && index == INVALID_BLOCK; ++firstLevel)
         {
-            // remove slot
-            _availableMemory.erase(itr);
-            if (auto offsetSize_itr = _offsetSizes.find(slotStart); offsetSize_itr != _offsetSizes.end()) _offsetSizes.erase(offsetSize_itr);
+            uint32_t secondLevelBitmap = _secondLevelBitmaps[firstLevel];
+            if (firstLevel == startFirstLevel) secondLevelBitmap &= (~0u << startSecondLevel);
 
-            // check if there the front of the slot isn't used completely, if so generate an available space for it.
-            if (alignedStart > slotStart)
+            while (secondLevelBitmap != 0 && index == INVALID_BLOCK)
             {
-                // insert new slot with previous slots start and new end.
-                VkDeviceSize preAlignedStartSize = alignedStart - slotStart;
-                _availableMemory.insert(SizeOffset(preAlignedStartSize, slotStart));
-                _offsetSizes.insert(OffsetSize(slotStart, preAlignedStartSize));
+                uint32_t secondLevel = leastSignificantBit(secondLevelBitmap);
+                secondLevelBitmap &= ~(1u << secondLevel);
+
+                for (uint32_t candidate = _freeLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel]; candidate != INVALID_BLOCK; candidate = _blocks[candidate].nextFree)
+                {
+                    if (fits(candidate))
+                    {
+                        index = candidate;
+                        break;
+                    }
+                }
             }
+        }
+    }
 
-            // check if there is space at the end slot that isn't used completely, if so generate an available space for it.
-            if (alignedEnd < slotEnd)
-            {
-                // insert new slot with new end and new size
-                VkDeviceSize postAlignedEndSize = slotEnd - alignedEnd;
-                _availableMemory.insert(SizeOffset(postAlignedEndSize, alignedEnd));
-                _offsetSizes.insert(OffsetSize(alignedEnd, postAlignedEndSize));
-            }
-
-            _reservedOffsetSizes[alignedStart] = (alignedEnd - alignedStart);
-
-#if DO_CHECK
-            check();
-#endif
+    if (index == INVALID_BLOCK)
+    {
+        //std::cout<<"MemorySlots::reserve("<<std::dec<<size<<") with alingment "<<alignment<<" No slots available for this size, biggest available slot is : "<<maximumAvailableSpace()<<std::endl;
+        //report();
 
-            return OptionalOffset(true, alignedStart);
-        }
-        else
-        {
-            // std::cout << "    Slot slotStart = " << slotStart << ", slotSize = " << slotSize << " not big enough once for request size = " << size << std::endl;
-            ++itr;
-        }
+        return OptionalOffset(false, 0);
     }
 
-    //std::cout<<"MemorySlots::reserve("<<std::dec<<size<<") with alingment "<<alignment<<" No slots available for this size, biggest available slot is : "<<_availableMemory.rbegin()->first<<std::endl;
-    //report();
+    VkDeviceSize offset = alignedStart(index);
 
-    return OptionalOffset(false, 0);
-}
+    removeAvailableBlock(index);
 
-void MemorySlots::release(VkDeviceSize offset, VkDeviceSize size)
-{
-    auto reserved_itr = _reservedOffsetSizes.find(offset);
-    if (reserved_itr == _reservedOffsetSizes.end())
+    // check if there the front of the slot isn't used completely, if so keep it available
+    if (offset > _blocks[index].offset)
     {
-#if DO_CHECK
-        std::cout << "   MemorySlots::release() slot not found" << std::endl;
-#endif
-        return;
+        uint32_t alignedIndex = splitBlock(index, offset - _blocks[index].offset);
+        insertAvailableBlock(index);
+        index = alignedIndex;
     }
-    else
+
+    // check if there is space at the end slot that isn't used completely, if so generate an available space for it.
+    if (_blocks[index].size > size)
     {
+        uint32_t remainderIndex = splitBlock(index, size);
+        insertAvailableBlock(remainderIndex);
+    }
+
+    insertReservedBlock(index);
+
+    _totalAvailableSize -= size;
+    _totalReservedSize += size;
+
 #if DO_CHECK
-        if (reserved_itr->second != size)
-        {
-            std::cout << "    MemorySlots::release() slot found but sizes are inconsistent reserved_itr->second = " << std::dec << reserved_itr->second << ", size=" << size << std::endl;
-            if (size != 0) throw "MemorySlots::release() slot found but sizes are inconsistent reserved_itr->second";
-        }
-        else
-        {
-            std::cout << "    MemorySlots::release() slot found " << std::endl;
-        }
+    check();
 #endif
 
-        size = reserved_itr->second;
-
-        _reservedOffsetSizes.erase(reserved_itr);
-    }
+    return OptionalOffset(true, offset);
+}
 
-    if (_offsetSizes.empty())
+void MemorySlots::release(VkDeviceSize offset, VkDeviceSize size)
+{
+    uint32_t index = removeReservedBlock(offset);
+    if (index == INVALID_BLOCK)
     {
-        // first empty space
-        _availableMemory.insert(SizeOffset(size, offset));
-        _offsetSizes.insert(OffsetSize(offset, size));
-
 #if DO_CHECK
-        check();
+        std::cout << "   MemorySlots::release() slot not found" << std::endl;
 #endif
         return;
     }
 
-    // need to find adjacent blocks before and after to see if we can join them together options are:
-    //    abutes to neither before or after
-    //    abutes to before, so replace before with new combined length
-    //    abutes to after, so remove after entry and insert new entry with combined length
-    //    abutes to both before and after, so replace before with newly combined length of all three, remove after entry
-
-    auto slotAfter = _offsetSizes.upper_bound(offset);
-
-    auto slotBefore = slotAfter;
-    if (slotBefore != _offsetSizes.end())
-    {
-        if (slotBefore == _offsetSizes.begin())
-        {
-            slotBefore = _offsetSizes.end();
-        }
-        else
-        {
-            --slotBefore;
-        }
-    }
-    else
+#if DO_CHECK
+    if (_blocks[index].size != size)
     {
-        slotBefore = _offsetSizes.rbegin().base();
+        std::cout << "    MemorySlots::release() slot found but sizes are inconsistent reserved size = " << std::dec << _blocks[index].size << ", size=" << size << std::endl;
+        if (size != 0) throw "MemorySlots::release() slot found but sizes are inconsistent reserved_itr->second";
     }
+#else
+    (void)size;
+#endif
 
-    auto eraseSlot = [&](OffsetSizes::iterator offsetSizeItr) {
-        auto range = _availableMemory.equal_range(offsetSizeItr->second);
-        for (auto itr = range.first; itr != range.second; ++itr)
-        {
-            if (itr->second == offsetSizeItr->first)
-            {
-                _availableMemory.erase(itr);
-                _offsetSizes.erase(offsetSizeItr);
-                break;
-            }
-        }
-    };
+    _totalAvailableSize += _blocks[index].size;
+    _totalReservedSize -= _blocks[index].size;
 
-    if (slotBefore != _offsetSizes.end())
+    // merge with the adjacent blocks before and after if they are available
+    if (uint32_t previousIndex = _blocks[index].previousPhysical; previousIndex != INVALID_BLOCK && _blocks[previousIndex].available)
     {
-        VkDeviceSize endOfBeforeSlot = slotBefore->first + slotBefore->second;
-
-        if (endOfBeforeSlot == offset)
-        {
-            VkDeviceSize endOfReleasedSlot = offset + size;
-            VkDeviceSize totalSizeOfMergedSlots = endOfReleasedSlot - slotBefore->first;
+        removeAvailableBlock(previousIndex);
 
-            offset = slotBefore->first;
-            size = totalSizeOfMergedSlots;
+        auto& previous = _blocks[previousIndex];
+        auto& block = _blocks[index];
+        previous.size += block.size;
+        previous.nextPhysical = block.nextPhysical;
+        if (block.nextPhysical != INVALID_BLOCK) _blocks[block.nextPhysical].previousPhysical = previousIndex;
 
-            eraseSlot(slotBefore);
-        }
+        destroyBlock(index);
+        index = previousIndex;
     }
-    if (slotAfter != _offsetSizes.end())
+
+    if (uint32_t nextIndex = _blocks[index].nextPhysical; nextIndex != INVALID_BLOCK && _blocks[nextIndex].available)
     {
-        VkDeviceSize endOfReleasedSlot = offset + size;
+        removeAvailableBlock(nextIndex);
 
-        if (endOfReleasedSlot == slotAfter->first)
-        {
-            VkDeviceSize endOfSlotAfter = slotAfter->first + slotAfter->second;
-            VkDeviceSize totalSizeOfMergedSlots = endOfSlotAfter - offset;
-            size = totalSizeOfMergedSlots;
+        auto& block = _blocks[index];
+        auto& next = _blocks[nextIndex];
+        block.size += next.size;
+        block.nextPhysical = next.nextPhysical;
+        if (next.nextPhysical != INVALID_BLOCK) _blocks[next.nextPhysical].previousPhysical = index;
 
-            eraseSlot(slotAfter);
-        }
+        destroyBlock(nextIndex);
     }
 
-    _availableMemory.insert(SizeOffset(size, offset));
-    _offsetSizes.insert(OffsetSize(offset, size));
-
-    //report();
+    insertAvailableBlock(index);
 
 #if DO_CHECK
     check();
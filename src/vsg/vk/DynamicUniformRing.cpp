@@ -0,0 +1,119 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Exception.h>
+#include <vsg/io/Options.h>
+#include <vsg/vk/DynamicUniformRing.h>
+
+#include <algorithm>
+
+using namespace vsg;
+
+DynamicUniformRing::DynamicUniformRing(Device* device, VkDeviceSize in_frameSize, uint32_t in_numFrames) :
+    _numFrames(std::max(in_numFrames, 1u)),
+    _frameFences(_numFrames)
+{
+    // dynamic offsets of both uniform and storage buffers are taken from the ring so use the stricter of their alignments
+    auto& limits = device->getPhysicalDevice()->getProperties().limits;
+    _alignment = std::max({limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment, VkDeviceSize(4)});
+
+    // keep the start of each frame's region aligned so offsets within them only need aligning to the frame's start
+    _frameSize = alignedSize(in_frameSize);
+
+    _buffer = Buffer::create(device, _frameSize * _numFrames, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+
+    // Buffer(Device*, ..) allocates and binds dedicated host visible, coherent memory so it can be mapped once for the lifetime of the ring.
+    _deviceMemory = _buffer->getDeviceMemory(device->deviceID);
+
+    void* mappedData = nullptr;
+    if (VkResult result = _deviceMemory->map(_buffer->getMemoryOffset(device->deviceID), _frameSize * _numFrames, 0, &mappedData); result != VK_SUCCESS)
+    {
+        throw Exception{"Error: Failed to map DynamicUniformRing memory.", result};
+    }
+    _mappedData = static_cast<uint8_t*>(mappedData);
+}
+
+DynamicUniformRing::~DynamicUniformRing()
+{
+    if (_mappedData) _deviceMemory->unmap();
+}
+
+bool DynamicUniformRing::reserve(VkDeviceSize size)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_reservedSize + size > _frameSize) return false;
+
+    _reservedSize += size;
+    return true;
+}
+
+void DynamicUniformRing::release(VkDeviceSize size)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    _reservedSize -= std::min(size, _reservedSize);
+}
+
+VkResult DynamicUniformRing::beginFrame(uint64_t frameStampCount, uint64_t timeout)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_frameCount > 0 && frameStampCount == _frameStampCount) return VK_SUCCESS;
+
+    uint32_t nextFrame = static_cast<uint32_t>(_frameCount % _numFrames);
+
+    auto& fences = _frameFences[nextFrame];
+    for (auto& fence : fences)
+    {
+        // a fence without dependencies has already been waited on and reset by its RecordAndSubmitTask
+        if (fence->hasDependencies())
+        {
+            if (VkResult result = fence->wait(timeout); result != VK_SUCCESS) return result;
+        }
+    }
+    fences.clear();
+
+    _frameStampCount = frameStampCount;
+    _currentFrame = nextFrame;
+    ++_frameCount;
+    _head = 0;
+
+    return VK_SUCCESS;
+}
+
+void DynamicUniformRing::addFence(Fence* fence)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    auto& fences = _frameFences[_currentFrame];
+    if (std::find(fences.begin(), fences.end(), fence) == fences.end()) fences.emplace_back(fence);
+}
+
+void* DynamicUniformRing::allocate(VkDeviceSize size, uint32_t& dynamicOffset)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (_head + size > _frameSize) return nullptr;
+
+    VkDeviceSize bufferOffset = _currentFrame * _frameSize + _head;
+    _head += alignedSize(size);
+
+    dynamicOffset = static_cast<uint32_t>(bufferOffset);
+    return _mappedData + bufferOffset;
+}
+
+uint64_t DynamicUniformRing::frameCount() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _frameCount;
+}
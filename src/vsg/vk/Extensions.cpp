@@ -17,6 +17,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <cstring>
 
 #include <iostream>
+#include <mutex>
 
 using namespace vsg;
 
@@ -66,6 +67,10 @@ static BufferedExtensions s_extensions;
 
 Extensions* Extensions::Get(Device* device, bool createIfNotInitalized)
 {
+    // Extensions can be requested from compile threads so serialize access to the shared container
+    static std::mutex s_mutex;
+    std::scoped_lock<std::mutex> lock(s_mutex);
+
     if (!s_extensions[device] && createIfNotInitalized)
         s_extensions[device] = new Extensions(device);
 
@@ -84,4 +89,12 @@ Extensions::Extensions(Device* device)
     vkCreateRayTracingPipelinesNV = reinterpret_cast<PFN_vkCreateRayTracingPipelinesNV>(vkGetDeviceProcAddr(*device, "vkCreateRayTracingPipelinesNV"));
     vkGetRayTracingShaderGroupHandlesNV = reinterpret_cast<PFN_vkGetRayTracingShaderGroupHandlesNV>(vkGetDeviceProcAddr(*device, "vkGetRayTracingShaderGroupHandlesNV"));
     vkCmdTraceRaysNV = reinterpret_cast<PFN_vkCmdTraceRaysNV>(vkGetDeviceProcAddr(*device, "vkCmdTraceRaysNV"));
+
+    // VK_KHR_descriptor_update_template
+    if (device->supportsDeviceExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME))
+    {
+        vkCreateDescriptorUpdateTemplateKHR = reinterpret_cast<PFN_vkCreateDescriptorUpdateTemplateKHR>(vkGetDeviceProcAddr(*device, "vkCreateDescriptorUpdateTemplateKHR"));
+        vkDestroyDescriptorUpdateTemplateKHR = reinterpret_cast<PFN_vkDestroyDescriptorUpdateTemplateKHR>(vkGetDeviceProcAddr(*device, "vkDestroyDescriptorUpdateTemplateKHR"));
+        vkUpdateDescriptorSetWithTemplateKHR = reinterpret_cast<PFN_vkUpdateDescriptorSetWithTemplateKHR>(vkGetDeviceProcAddr(*device, "vkUpdateDescriptorSetWithTemplateKHR"));
+    }
 }
@@ -0,0 +1,178 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/commands/BindIndexBuffer.h>
+#include <vsg/io/Options.h>
+#include <vsg/vk/CommandBuffer.h>
+#include <vsg/vk/Context.h>
+#include <vsg/vk/GeometryHeap.h>
+
+using namespace vsg;
+
+static uint32_t indexSize(VkIndexType indexType)
+{
+    switch (indexType)
+    {
+    case (VK_INDEX_TYPE_UINT16): return 2;
+    case (VK_INDEX_TYPE_UINT32): return 4;
+    default: return 1;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// GeometryHeap::Block
+//
+GeometryHeap::Block::Block(Context& context, const std::vector<uint32_t>& in_strides, VkIndexType in_indexType, uint32_t vertexCapacity, uint32_t indexCapacity) :
+    strides(in_strides),
+    indexType(in_indexType),
+    _vertexSlots(vertexCapacity),
+    _indexSlots(indexCapacity),
+    _deviceID(context.deviceID)
+{
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    for (auto stride : strides)
+    {
+        auto bufferInfo = context.deviceMemoryBufferPools->reserveBuffer(VkDeviceSize(vertexCapacity) * stride, 4, usage, VK_SHARING_MODE_EXCLUSIVE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (!bufferInfo.buffer) return;
+
+        vertexBufferInfoList.push_back(bufferInfo);
+        _vkBuffers.push_back(bufferInfo.buffer->vk(_deviceID));
+        _offsets.push_back(bufferInfo.offset);
+    }
+
+    indexBufferInfo = context.deviceMemoryBufferPools->reserveBuffer(VkDeviceSize(indexCapacity) * indexSize(indexType), 4, usage, VK_SHARING_MODE_EXCLUSIVE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+GeometryHeap::Block::~Block()
+{
+    for (auto& bufferInfo : vertexBufferInfoList) bufferInfo.release();
+    indexBufferInfo.release();
+}
+
+bool GeometryHeap::Block::reserve(uint32_t vertexCount, uint32_t indexCount, uint32_t& vertexBase, uint32_t& indexBase)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    auto reservedVertices = _vertexSlots.reserve(vertexCount, 1);
+    if (!reservedVertices.first) return false;
+
+    auto reservedIndices = _indexSlots.reserve(indexCount, 1);
+    if (!reservedIndices.first)
+    {
+        _vertexSlots.release(reservedVertices.second, vertexCount);
+        return false;
+    }
+
+    vertexBase = static_cast<uint32_t>(reservedVertices.second);
+    indexBase = static_cast<uint32_t>(reservedIndices.second);
+    return true;
+}
+
+void GeometryHeap::Block::release(uint32_t vertexBase, uint32_t indexBase)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    _vertexSlots.release(vertexBase, 0);
+    _indexSlots.release(indexBase, 0);
+}
+
+void GeometryHeap::Block::bind(CommandBuffer& commandBuffer, uint32_t firstBinding) const
+{
+    if (commandBuffer.boundGeometryHeapBlock == this && commandBuffer.boundGeometryHeapFirstBinding == firstBinding) return;
+
+    vkCmdBindVertexBuffers(commandBuffer, firstBinding, static_cast<uint32_t>(_vkBuffers.size()), _vkBuffers.data(), _offsets.data());
+    vkCmdBindIndexBuffer(commandBuffer, indexBufferInfo.buffer->vk(_deviceID), indexBufferInfo.offset, indexType);
+
+    commandBuffer.boundGeometryHeapBlock = this;
+    commandBuffer.boundGeometryHeapFirstBinding = firstBinding;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// GeometryHeap
+//
+GeometryHeap::GeometryHeap(uint32_t in_vertexCapacity, uint32_t in_indexCapacity) :
+    vertexCapacity(in_vertexCapacity),
+    indexCapacity(in_indexCapacity)
+{
+}
+
+GeometryHeap::~GeometryHeap()
+{
+}
+
+GeometryHeap::Allocation GeometryHeap::allocate(Context& context, const DataList& arrays, const Data* indices)
+{
+    if (arrays.empty() || !indices) return {};
+
+    // all the arrays must be per vertex and tightly packed so that they can share the same vertex index
+    size_t vertexCount = arrays.front()->valueCount();
+    std::vector<uint32_t> strides;
+    strides.reserve(arrays.size());
+    for (auto& array : arrays)
+    {
+        if (!array || array->valueCount() != vertexCount || array->dataSize() != array->valueCount() * array->valueSize()) return {};
+        strides.push_back(static_cast<uint32_t>(array->valueSize()));
+    }
+
+    size_t indexCount = indices->valueCount();
+    if (vertexCount == 0 || indexCount == 0 || vertexCount > vertexCapacity || indexCount > indexCapacity) return {};
+
+    VkIndexType indexType = computeIndexType(indices);
+
+    Allocation allocation;
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+
+        for (auto& block : _blocks)
+        {
+            if (block->strides == strides && block->indexType == indexType && block->reserve(static_cast<uint32_t>(vertexCount), static_cast<uint32_t>(indexCount), allocation.vertexBase, allocation.indexBase))
+            {
+                allocation.block = block;
+                break;
+            }
+        }
+
+        if (!allocation)
+        {
+            auto block = Block::create(context, strides, indexType, vertexCapacity, indexCapacity);
+            if (!block->valid() || !block->reserve(static_cast<uint32_t>(vertexCount), static_cast<uint32_t>(indexCount), allocation.vertexBase, allocation.indexBase)) return {};
+
+            _blocks.push_back(block);
+            allocation.block = block;
+        }
+    }
+
+    // transfer the arrays and indices to their positions in the block
+    auto& block = *allocation.block;
+    for (auto stride : strides) context.deviceMemoryReserved += VkDeviceSize(vertexCount) * stride;
+    context.deviceMemoryReserved += VkDeviceSize(indexCount) * indexSize(indexType);
+    for (size_t i = 0; i < arrays.size(); ++i)
+    {
+        auto& vertexBufferInfo = block.vertexBufferInfoList[i];
+        auto stagingBufferInfo = copyDataToStagingBuffer(context, arrays[i]);
+        context.copy(stagingBufferInfo, BufferInfo(vertexBufferInfo.buffer, vertexBufferInfo.offset + VkDeviceSize(allocation.vertexBase) * block.strides[i], stagingBufferInfo.range));
+    }
+
+    auto stagingBufferInfo = copyDataToStagingBuffer(context, indices);
+    context.copy(stagingBufferInfo, BufferInfo(block.indexBufferInfo.buffer, block.indexBufferInfo.offset + VkDeviceSize(allocation.indexBase) * indexSize(indexType), stagingBufferInfo.range));
+
+    return allocation;
+}
+
+void GeometryHeap::release(Allocation& allocation)
+{
+    if (allocation.block) allocation.block->release(allocation.vertexBase, allocation.indexBase);
+    allocation = {};
+}
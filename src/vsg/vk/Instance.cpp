@@ -85,6 +85,8 @@ Instance::Instance(const Names& instanceExtensions, const Names& layers, Allocat
         _instance = instance;
         _allocator = allocator;
 
+        for (auto extensionName : instanceExtensions) _enabledExtensions.insert(extensionName);
+
         uint32_t deviceCount = 0;
         vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
 
@@ -10,10 +10,17 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/commands/CopyAndReleaseBuffer.h>
 #include <vsg/io/Options.h>
+#include <vsg/state/DescriptorBuffer.h>
+#include <vsg/state/DescriptorSet.h>
+#include <vsg/vk/Context.h>
 #include <vsg/vk/MemoryBufferPools.h>
 
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <set>
 
 #define REPORT_STATS 0
 
@@ -32,6 +39,8 @@ MemoryBufferPools::MemoryBufferPools(const std::string& in_name, Device* in_devi
 
 VkDeviceSize MemoryBufferPools::computeMemoryTotalAvailable() const
 {
+    std::scoped_lock<std::mutex> lock(_mutex);
+
     VkDeviceSize totalAvailableSize = 0;
     for (auto& deviceMemory : memoryPools)
     {
@@ -42,6 +51,8 @@ VkDeviceSize MemoryBufferPools::computeMemoryTotalAvailable() const
 
 VkDeviceSize MemoryBufferPools::computeMemoryTotalReserved() const
 {
+    std::scoped_lock<std::mutex> lock(_mutex);
+
     VkDeviceSize totalReservedSize = 0;
     for (auto& deviceMemory : memoryPools)
     {
@@ -52,6 +63,8 @@ VkDeviceSize MemoryBufferPools::computeMemoryTotalReserved() const
 
 VkDeviceSize MemoryBufferPools::computeBufferTotalAvailable() const
 {
+    std::scoped_lock<std::mutex> lock(_mutex);
+
     VkDeviceSize totalAvailableSize = 0;
     for (auto& buffer : bufferPools)
     {
@@ -62,6 +75,8 @@ VkDeviceSize MemoryBufferPools::computeBufferTotalAvailable() const
 
 VkDeviceSize MemoryBufferPools::computeBufferTotalReserved() const
 {
+    std::scoped_lock<std::mutex> lock(_mutex);
+
     VkDeviceSize totalReservedSize = 0;
     for (auto& buffer : bufferPools)
     {
@@ -70,12 +85,372 @@ VkDeviceSize MemoryBufferPools::computeBufferTotalReserved() const
     return totalReservedSize;
 }
 
+template<class T>
+static MemoryPoolStatistics computeStatistics(const std::vector<ref_ptr<T>>& blocks)
+{
+    MemoryPoolStatistics statistics;
+    for (auto& block : blocks)
+    {
+        auto& memorySlots = block->memorySlots();
+        ++statistics.numBlocks;
+        if (block->referenceCount() == 1) ++statistics.numUnusedBlocks;
+        statistics.numAvailableRanges += memorySlots.numAvailableBlocks();
+        statistics.totalSize += memorySlots.totalMemorySize();
+        statistics.reservedSize += memorySlots.totalReservedSize();
+        statistics.availableSize += memorySlots.totalAvailableSize();
+        statistics.maximumAvailableSpace = std::max(statistics.maximumAvailableSpace, memorySlots.maximumAvailableSpace());
+    }
+    return statistics;
+}
+
+// reorder the blocks, most densely used first, so that reservations are made from dense blocks and sparsely used blocks drain and can be released.
+// Done by releaseUnusedMemory() rather than on each reservation, so the order reflects the usage at the last release and newly created blocks are tried last.
+template<class T>
+static void sortDensestFirst(std::vector<ref_ptr<T>>& blocks)
+{
+    auto density = [](const T* block) {
+        auto& memorySlots = block->memorySlots();
+        return memorySlots.totalMemorySize() > 0 ? static_cast<double>(memorySlots.totalReservedSize()) / static_cast<double>(memorySlots.totalMemorySize()) : 1.0;
+    };
+
+    std::stable_sort(blocks.begin(), blocks.end(), [&](const ref_ptr<T>& lhs, const ref_ptr<T>& rhs) { return density(lhs.get()) > density(rhs.get()); });
+}
+
+// release blocks only referenced by the pool, keeping one as a spare, and return the number of bytes released.
+template<class T>
+static VkDeviceSize releaseUnusedBlocks(std::vector<ref_ptr<T>>& blocks, size_t& maxBlocks)
+{
+    VkDeviceSize releasedSize = 0;
+    bool spareRetained = false;
+    for (auto itr = blocks.begin(); itr != blocks.end();)
+    {
+        if ((*itr)->referenceCount() == 1)
+        {
+            if (spareRetained && maxBlocks > 0)
+            {
+                releasedSize += (*itr)->memorySlots().totalMemorySize();
+                itr = blocks.erase(itr);
+                --maxBlocks;
+                continue;
+            }
+            spareRetained = true;
+        }
+        ++itr;
+    }
+    return releasedSize;
+}
+
+MemoryPoolStatistics MemoryBufferPools::computeMemoryStatistics() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return computeStatistics(memoryPools);
+}
+
+MemoryPoolStatistics MemoryBufferPools::computeBufferStatistics() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return computeStatistics(bufferPools);
+}
+
+VkDeviceSize MemoryBufferPools::releaseUnusedMemory(size_t maxBlocks)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // release Buffers first as they hold reservations in the DeviceMemory blocks.
+    releaseUnusedBlocks(bufferPools, maxBlocks);
+    auto releasedSize = releaseUnusedBlocks(memoryPools, maxBlocks);
+
+    sortDensestFirst(bufferPools);
+    sortDensestFirst(memoryPools);
+
+    return releasedSize;
+}
+
+VkDeviceSize MemoryBufferPools::releaseUnusedMemory(Context& context, size_t maxBlocks)
+{
+    auto releasedSize = releaseUnusedMemory(maxBlocks);
+
+    if (bufferPreferences.compactionDensity <= 0.0) return releasedSize;
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // the CopyAndReleaseBuffer batch holding a compaction's copies is deleted by Context::waitForCompletion() once its submission has completed,
+    // at which point the relocated ranges hold the data and the DescriptorSets can be rewritten to use them.
+    bool copying = false;
+    for (auto& compaction : _compactions)
+    {
+        if (compaction.status != Compaction::Copying) continue;
+
+        if (compaction.copies.valid())
+            copying = true;
+        else
+            _rewriteRelocated(context, compaction);
+    }
+
+    // limit the copies in flight to those of one block
+    if (!copying) _startCompaction(context);
+
+    return releasedSize;
+}
+
+void MemoryBufferPools::addRelocatable(DescriptorSet* descriptorSet)
+{
+    if (bufferPreferences.compactionDensity <= 0.0) return;
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    for (auto& descriptor : descriptorSet->descriptors)
+    {
+        if (auto descriptorBuffer = descriptor->cast<DescriptorBuffer>())
+        {
+            for (auto& bufferInfo : descriptorBuffer->bufferInfoList)
+            {
+                if (bufferInfo.buffer && std::find(bufferPools.begin(), bufferPools.end(), bufferInfo.buffer) != bufferPools.end())
+                {
+                    _relocatables.emplace_back(descriptorSet);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void MemoryBufferPools::updateRelocations(uint64_t frameCount)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    for (auto itr = _compactions.begin(); itr != _compactions.end();)
+    {
+        auto& compaction = *itr;
+        if (compaction.status == Compaction::Rewritten)
+        {
+            for (auto& descriptorSet : compaction.descriptorSets)
+            {
+                if (auto previous = descriptorSet->switchToRewrite(device->deviceID)) compaction.previousDescriptorSets.push_back(previous);
+            }
+            compaction.descriptorSets.clear();
+            compaction.switchFrameCount = frameCount;
+            compaction.status = Compaction::Switched;
+        }
+        else if (compaction.status == Compaction::Switched && (frameCount >= (compaction.switchFrameCount + bufferPreferences.compactionRetainFrames) || frameCount < compaction.switchFrameCount))
+        {
+            // frames recorded before the switch have completed so the previous ranges and descriptor sets are no longer used
+            for (auto& relocation : compaction.relocations)
+            {
+                if (relocation.adopted) relocation.source.release();
+            }
+            itr = _compactions.erase(itr);
+            continue;
+        }
+        ++itr;
+    }
+}
+
+bool MemoryBufferPools::relocationsPending() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return !_compactions.empty();
+}
+
+bool MemoryBufferPools::_compacting(const Buffer* buffer) const
+{
+    for (auto& compaction : _compactions)
+    {
+        if (compaction.buffer == buffer) return true;
+    }
+    return false;
+}
+
+void MemoryBufferPools::_rewriteRelocated(Context& context, Compaction& compaction)
+{
+    // the relocations are in source offset order, return the one containing the range
+    auto findRelocation = [&](VkDeviceSize offset, VkDeviceSize range) -> Relocation* {
+        auto itr = std::upper_bound(compaction.relocations.begin(), compaction.relocations.end(), offset, [](VkDeviceSize value, const Relocation& relocation) { return value < relocation.source.offset; });
+        if (itr == compaction.relocations.begin()) return nullptr;
+        --itr;
+        return ((offset + range) <= (itr->source.offset + itr->source.range)) ? &(*itr) : nullptr;
+    };
+
+    // update the BufferInfo of the registered DescriptorSets to the relocated ranges, a DescriptorBuffer shared by several DescriptorSets is updated by the first and each of them rewritten
+    std::set<const DescriptorBuffer*> relocatedDescriptorBuffers;
+    for (auto& observer : _relocatables)
+    {
+        ref_ptr<DescriptorSet> descriptorSet = observer;
+        if (!descriptorSet) continue;
+
+        bool relocated = false;
+        for (auto& descriptor : descriptorSet->descriptors)
+        {
+            auto descriptorBuffer = descriptor->cast<DescriptorBuffer>();
+            if (!descriptorBuffer) continue;
+
+            if (relocatedDescriptorBuffers.count(descriptorBuffer) != 0)
+            {
+                relocated = true;
+                continue;
+            }
+
+            for (auto& bufferInfo : descriptorBuffer->bufferInfoList)
+            {
+                if (bufferInfo.buffer != compaction.buffer) continue;
+
+                if (auto relocation = findRelocation(bufferInfo.offset, bufferInfo.range))
+                {
+                    bufferInfo.buffer = relocation->destination.buffer;
+                    bufferInfo.offset = relocation->destination.offset + (bufferInfo.offset - relocation->source.offset);
+                    relocation->adopted = true;
+
+                    relocatedDescriptorBuffers.insert(descriptorBuffer);
+                    relocated = true;
+                }
+            }
+        }
+
+        if (relocated)
+        {
+            descriptorSet->rewrite(context);
+            compaction.descriptorSets.push_back(descriptorSet);
+        }
+    }
+
+    // ranges no longer referenced have been released by their DescriptorBuffer while being copied, so the ranges reserved for them aren't required
+    for (auto& relocation : compaction.relocations)
+    {
+        if (!relocation.adopted) relocation.destination.release();
+    }
+
+    compaction.status = Compaction::Rewritten;
+}
+
+bool MemoryBufferPools::_startCompaction(Context& context)
+{
+    // drop the registrations of deleted DescriptorSets
+    _relocatables.erase(std::remove_if(_relocatables.begin(), _relocatables.end(), [](const observer_ptr<DescriptorSet>& descriptorSet) { return !descriptorSet.valid(); }), _relocatables.end());
+
+    // ranges of the Buffer blocks referenced by the registered DescriptorSets
+    std::map<const Buffer*, MemorySlots::Ranges> referencedRanges;
+    for (auto& observer : _relocatables)
+    {
+        ref_ptr<DescriptorSet> descriptorSet = observer;
+        if (!descriptorSet) continue;
+
+        for (auto& descriptor : descriptorSet->descriptors)
+        {
+            if (auto descriptorBuffer = descriptor->cast<DescriptorBuffer>())
+            {
+                for (auto& bufferInfo : descriptorBuffer->bufferInfoList)
+                {
+                    if (bufferInfo.buffer) referencedRanges[bufferInfo.buffer.get()].emplace_back(bufferInfo.offset, bufferInfo.offset + bufferInfo.range);
+                }
+            }
+        }
+    }
+
+    // relocated ranges are aligned for any use of the pools' buffers, so the BufferInfo within them remain aligned
+    auto& limits = device->getPhysicalDevice()->getProperties().limits;
+    VkDeviceSize alignment = std::max({VkDeviceSize(4), limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment});
+
+    // a block can be relocated when each of its reserved ranges is covered by the referenced ranges, up to the alignment padding between them,
+    // otherwise parts are used in other ways, such as vertex arrays, that can't be updated.
+    auto relocatable = [&](const Buffer* buffer, const MemorySlots::Ranges& reservedRanges) {
+        auto itr = referencedRanges.find(buffer);
+        if (itr == referencedRanges.end()) return false;
+
+        auto& ranges = itr->second;
+        std::sort(ranges.begin(), ranges.end());
+
+        auto range_itr = ranges.begin();
+        for (auto& [offset, size] : reservedRanges)
+        {
+            VkDeviceSize end = offset + size;
+            VkDeviceSize covered = offset;
+            for (; range_itr != ranges.end() && range_itr->first < end; ++range_itr)
+            {
+                if (range_itr->first < offset || range_itr->second > end || range_itr->first >= (covered + alignment)) return false;
+                covered = std::max(covered, range_itr->second);
+            }
+            if ((covered + alignment) <= end) return false;
+        }
+        return true;
+    };
+
+    auto density = [](const Buffer* buffer) {
+        auto& memorySlots = buffer->memorySlots();
+        return static_cast<double>(memorySlots.totalReservedSize()) / static_cast<double>(memorySlots.totalMemorySize());
+    };
+
+    // the copies read from the compacted block and write to the denser blocks
+    const VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    // the blocks are ordered densest first by releaseUnusedMemory() so try the sparsest first
+    for (auto buffer_itr = bufferPools.rbegin(); buffer_itr != bufferPools.rend(); ++buffer_itr)
+    {
+        auto& buffer = *buffer_itr;
+        if (buffer->referenceCount() == 1 || (buffer->usage & transferUsage) != transferUsage || _compacting(buffer)) continue;
+        if (buffer->memorySlots().totalReservedSize() == 0 || density(buffer) >= bufferPreferences.compactionDensity) continue;
+
+        auto reservedRanges = buffer->memorySlots().reservedRanges();
+        if (!relocatable(buffer, reservedRanges)) continue;
+
+        // reserve a range for each in the denser blocks, blocks below the compaction density are excluded so ranges aren't moved back and forth between sparse blocks
+        Compaction compaction;
+        compaction.buffer = buffer;
+        for (auto& [offset, size] : reservedRanges)
+        {
+            BufferInfo destination;
+            for (auto& candidate : bufferPools)
+            {
+                if (candidate == buffer || candidate->usage != buffer->usage || _compacting(candidate) || density(candidate) < bufferPreferences.compactionDensity) continue;
+
+                auto reservedSlot = candidate->reserve(size, alignment);
+                if (reservedSlot.first)
+                {
+                    destination = BufferInfo(candidate, reservedSlot.second, size);
+                    break;
+                }
+            }
+            if (!destination.buffer) break;
+
+            compaction.relocations.push_back(Relocation{BufferInfo(buffer, offset, size), destination});
+        }
+
+        if (compaction.relocations.size() != reservedRanges.size())
+        {
+            // not enough space in the denser blocks
+            for (auto& relocation : compaction.relocations) relocation.destination.release();
+            continue;
+        }
+
+        // the source ranges remain reserved until updateRelocations(..) releases them once the DescriptorSets have switched to the relocated ranges
+        for (auto& relocation : compaction.relocations)
+        {
+            context.copy(relocation.source, relocation.destination, false);
+        }
+        compaction.copies = context.copyAndReleaseBuffer;
+
+#if REPORT_STATS
+        std::cout << name << " : compacting Buffer " << buffer.get() << ", relocating " << compaction.relocations.size() << " ranges" << std::endl;
+#endif
+
+        _compactions.push_back(std::move(compaction));
+        return true;
+    }
+
+    return false;
+}
+
 BufferInfo MemoryBufferPools::reserveBuffer(VkDeviceSize totalSize, VkDeviceSize alignment, VkBufferUsageFlags bufferUsageFlags, VkSharingMode sharingMode, VkMemoryPropertyFlags memoryProperties)
 {
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // blocks uploaded to are also copied from when compacted
+    if (bufferPreferences.compactionDensity > 0.0 && (bufferUsageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT) != 0) bufferUsageFlags |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
     BufferInfo bufferInfo;
     for (auto& bufferFromPool : bufferPools)
     {
-        if (bufferFromPool->usage == bufferUsageFlags && bufferFromPool->size >= totalSize)
+        // blocks being compacted are drained rather than reserved from
+        if (bufferFromPool->usage == bufferUsageFlags && bufferFromPool->size >= totalSize && !_compacting(bufferFromPool))
         {
             MemorySlots::OptionalOffset reservedBufferSlot = bufferFromPool->reserve(totalSize, alignment);
             if (reservedBufferSlot.first)
@@ -120,7 +495,15 @@ BufferInfo MemoryBufferPools::reserveBuffer(VkDeviceSize totalSize, VkDeviceSize
         deviceSize = minumumBufferSize;
     }
 
-    bufferInfo.buffer = vsg::Buffer::create(device, deviceSize, bufferUsageFlags, sharingMode);
+    auto buffer = vsg::Buffer::create(deviceSize, bufferUsageFlags, sharingMode);
+    if (concurrentQueueFamilyIndices.size() > 1)
+    {
+        buffer->sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer->queueFamilyIndices = concurrentQueueFamilyIndices;
+    }
+    buffer->compile(device);
+
+    bufferInfo.buffer = buffer;
 
     MemorySlots::OptionalOffset reservedBufferSlot = bufferInfo.buffer->reserve(totalSize, alignment);
     bufferInfo.offset = reservedBufferSlot.second;
@@ -128,11 +511,8 @@ BufferInfo MemoryBufferPools::reserveBuffer(VkDeviceSize totalSize, VkDeviceSize
 
     // std::cout<<name<<" : Created new Buffer "<<bufferInfo.buffer.get()<<" totalSize "<<totalSize<<" deviceSize = "<<deviceSize<<std::endl;
 
-    if (!bufferInfo.buffer->full())
-    {
-        // std::cout<<name<<"  inserting new Buffer into Context.bufferPools"<<std::endl;
-        bufferPools.push_back(bufferInfo.buffer);
-    }
+    // keep full buffers in the pool so they can be reused once ranges are released, and released by releaseUnusedMemory() once unused
+    bufferPools.push_back(bufferInfo.buffer);
 
     // std::cout<<name<<" : bufferInfo.offset = "<<bufferInfo.offset<<std::endl;
 
@@ -168,10 +548,7 @@ BufferInfo MemoryBufferPools::reserveBuffer(VkDeviceSize totalSize, VkDeviceSize
         if (deviceMemory)
         {
             reservedMemorySlot = deviceMemory->reserve(deviceSize);
-            if (!deviceMemory->full())
-            {
-                memoryPools.push_back(deviceMemory);
-            }
+            memoryPools.push_back(deviceMemory);
         }
     }
     else
@@ -196,6 +573,8 @@ BufferInfo MemoryBufferPools::reserveBuffer(VkDeviceSize totalSize, VkDeviceSize
 
 MemoryBufferPools::DeviceMemoryOffset MemoryBufferPools::reserveMemory(VkMemoryRequirements memRequirements, VkMemoryPropertyFlags memoryProperties, void* pNextAllocInfo)
 {
+    std::scoped_lock<std::mutex> lock(_mutex);
+
     VkDeviceSize totalSize = memRequirements.size;
 
     ref_ptr<DeviceMemory> deviceMemory;
@@ -228,11 +607,7 @@ MemoryBufferPools::DeviceMemoryOffset MemoryBufferPools::reserveMemory(VkMemoryR
         if (deviceMemory)
         {
             reservedSlot = deviceMemory->reserve(totalSize);
-            if (!deviceMemory->full())
-            {
-                //std::cout<<"  inserting DeviceMemory into memoryPool "<<deviceMemory.get()<<std::endl;
-                memoryPools.push_back(deviceMemory);
-            }
+            memoryPools.push_back(deviceMemory);
         }
     }
     else
@@ -13,6 +13,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/io/Options.h>
 #include <vsg/vk/PhysicalDevice.h>
 
+#include <bitset>
+#include <cstring>
+
 using namespace vsg;
 
 PhysicalDevice::PhysicalDevice(Instance* instance, VkPhysicalDevice device) :
@@ -26,6 +29,13 @@ PhysicalDevice::PhysicalDevice(Instance* instance, VkPhysicalDevice device) :
 
     _queueFamiles.resize(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(_device, &queueFamilyCount, _queueFamiles.data());
+
+    // the Instance is created with VK_API_VERSION_1_0 so the extended queries have to come from VK_KHR_get_physical_device_properties2
+    if (instance->supportsInstanceExtension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+    {
+        _vkGetPhysicalDeviceFeatures2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(*instance, "vkGetPhysicalDeviceFeatures2KHR"));
+        _vkGetPhysicalDeviceMemoryProperties2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(vkGetInstanceProcAddr(*instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+    }
 }
 
 PhysicalDevice::~PhysicalDevice()
@@ -54,6 +64,27 @@ int PhysicalDevice::getQueueFamily(VkQueueFlags queueFlags) const
     return bestFamily;
 }
 
+int PhysicalDevice::getDedicatedQueueFamily(VkQueueFlags queueFlags, VkQueueFlags excludedQueueFlags) const
+{
+    int bestFamily = -1;
+    size_t bestNumFlags = 0;
+
+    for (int i = 0; i < static_cast<int>(_queueFamiles.size()); ++i)
+    {
+        const auto& queueFamily = _queueFamiles[i];
+        if ((queueFamily.queueFlags & queueFlags) != queueFlags || (queueFamily.queueFlags & excludedQueueFlags) != 0) continue;
+
+        size_t numFlags = std::bitset<32>(queueFamily.queueFlags).count();
+        if (bestFamily < 0 || numFlags < bestNumFlags)
+        {
+            bestFamily = i;
+            bestNumFlags = numFlags;
+        }
+    }
+
+    return bestFamily;
+}
+
 std::pair<int, int> PhysicalDevice::getQueueFamily(VkQueueFlags queueFlags, Surface* surface) const
 {
     int queueFamily = -1;
@@ -79,3 +110,34 @@ std::pair<int, int> PhysicalDevice::getQueueFamily(VkQueueFlags queueFlags, Surf
 
     return {queueFamily, presentFamily};
 }
+
+bool PhysicalDevice::getFeatures2(VkPhysicalDeviceFeatures2& features2) const
+{
+    if (!_vkGetPhysicalDeviceFeatures2KHR) return false;
+
+    _vkGetPhysicalDeviceFeatures2KHR(_device, &features2);
+    return true;
+}
+
+bool PhysicalDevice::getMemoryProperties2(VkPhysicalDeviceMemoryProperties2& memoryProperties2) const
+{
+    if (!_vkGetPhysicalDeviceMemoryProperties2KHR) return false;
+
+    _vkGetPhysicalDeviceMemoryProperties2KHR(_device, &memoryProperties2);
+    return true;
+}
+
+bool PhysicalDevice::supportsDeviceExtension(const char* extensionName) const
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(_device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extensionProperties(extensionCount);
+    vkEnumerateDeviceExtensionProperties(_device, nullptr, &extensionCount, extensionProperties.data());
+
+    for (auto& properties : extensionProperties)
+    {
+        if (std::strcmp(properties.extensionName, extensionName) == 0) return true;
+    }
+    return false;
+}
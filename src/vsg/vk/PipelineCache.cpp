@@ -0,0 +1,211 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Exception.h>
+#include <vsg/io/Options.h>
+#include <vsg/vk/PipelineCache.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace vsg;
+
+namespace
+{
+    // header written before the VkPipelineCache data so that files written by a different device or driver version are rejected before being passed to the driver
+    struct PipelineCacheFileHeader
+    {
+        char identifier[8] = {'v', 's', 'g', 'p', 'c', 'a', 'c', 'h'};
+        uint32_t fileVersion = 1;
+        uint32_t vendorID = 0;
+        uint32_t deviceID = 0;
+        uint32_t driverVersion = 0;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
+        uint64_t dataSize = 0;
+        uint64_t dataHash = 0;
+    };
+
+    PipelineCacheFileHeader fileHeader(const VkPhysicalDeviceProperties& properties)
+    {
+        PipelineCacheFileHeader header;
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        header.driverVersion = properties.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        return header;
+    }
+
+    // FNV-1a hash used to detect truncated or corrupted files
+    uint64_t hashData(const std::vector<uint8_t>& data)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (auto value : data)
+        {
+            hash ^= value;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+} // namespace
+
+PipelineCache::PipelineCache(Device* device, const std::vector<uint8_t>& initialData) :
+    _device(device)
+{
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.pNext = nullptr;
+    createInfo.flags = 0;
+
+    if (!initialData.empty() && compatible(device->getPhysicalDevice(), initialData))
+    {
+        createInfo.initialDataSize = initialData.size();
+        createInfo.pInitialData = initialData.data();
+
+        if (vkCreatePipelineCache(*device, &createInfo, _device->getAllocationCallbacks(), &_pipelineCache) == VK_SUCCESS)
+        {
+            _initializedFromData = true;
+            return;
+        }
+
+        // driver rejected the initial data so fallback to an empty cache
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+    }
+
+    if (VkResult result = vkCreatePipelineCache(*device, &createInfo, _device->getAllocationCallbacks(), &_pipelineCache); result != VK_SUCCESS)
+    {
+        throw Exception{"Error: Failed to create PipelineCache.", result};
+    }
+}
+
+PipelineCache::~PipelineCache()
+{
+    if (_pipelineCache)
+    {
+        vkDestroyPipelineCache(*_device, _pipelineCache, _device->getAllocationCallbacks());
+    }
+}
+
+ref_ptr<PipelineCache> PipelineCache::load(Device* device, const Path& filename)
+{
+    std::vector<uint8_t> data;
+
+    std::ifstream fin(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    if (fin)
+    {
+        auto fileSize = static_cast<uint64_t>(fin.tellg());
+        fin.seekg(0, std::ios::beg);
+
+        auto expected = fileHeader(device->getPhysicalDevice()->getProperties());
+
+        PipelineCacheFileHeader header;
+        fin.read(reinterpret_cast<char*>(&header), sizeof(PipelineCacheFileHeader));
+
+        if (fin.good() &&
+            std::memcmp(header.identifier, expected.identifier, sizeof(header.identifier)) == 0 &&
+            header.fileVersion == expected.fileVersion &&
+            header.vendorID == expected.vendorID &&
+            header.deviceID == expected.deviceID &&
+            header.driverVersion == expected.driverVersion &&
+            std::memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) == 0 &&
+            header.dataSize == (fileSize - sizeof(PipelineCacheFileHeader)))
+        {
+            data.resize(header.dataSize);
+            fin.read(reinterpret_cast<char*>(data.data()), data.size());
+
+            if (!fin.good() || hashData(data) != header.dataHash) data.clear();
+        }
+    }
+
+    auto pipelineCache = PipelineCache::create(device, data);
+    pipelineCache->filename = filename;
+    return pipelineCache;
+}
+
+Path PipelineCache::deviceFilename(const Path& filename, const PhysicalDevice* physicalDevice)
+{
+    const auto& properties = physicalDevice->getProperties();
+
+    char deviceID[24];
+    std::snprintf(deviceID, sizeof(deviceID), "_%04x_%04x_", properties.vendorID, properties.deviceID);
+
+    Path name = removeExtension(filename) + deviceID;
+    for (auto value : properties.pipelineCacheUUID)
+    {
+        char hex[3];
+        std::snprintf(hex, sizeof(hex), "%02x", value);
+        name += hex;
+    }
+
+    auto extension = fileExtension(filename);
+    if (!extension.empty()) name += "." + extension;
+
+    return name;
+}
+
+bool PipelineCache::save(const Path& path) const
+{
+    auto data = getData();
+    if (data.empty()) return false;
+
+    auto header = fileHeader(_device->getPhysicalDevice()->getProperties());
+    header.dataSize = data.size();
+    header.dataHash = hashData(data);
+
+    // write to a temporary file and then rename it so that a partially written file is never left behind
+    auto tempFilename = path + ".tmp";
+    {
+        std::ofstream fout(tempFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!fout) return false;
+
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(PipelineCacheFileHeader));
+        fout.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!fout.good()) return false;
+    }
+
+    std::remove(path.c_str());
+    return std::rename(tempFilename.c_str(), path.c_str()) == 0;
+}
+
+std::vector<uint8_t> PipelineCache::getData() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    std::vector<uint8_t> data;
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(*_device, _pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) return data;
+
+    data.resize(dataSize);
+    if (vkGetPipelineCacheData(*_device, _pipelineCache, &dataSize, data.data()) != VK_SUCCESS) return {};
+
+    data.resize(dataSize);
+    return data;
+}
+
+bool PipelineCache::compatible(const PhysicalDevice* physicalDevice, const std::vector<uint8_t>& data)
+{
+    // VkPipelineCacheHeaderVersionOne : headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID
+    const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if (data.size() < headerSize) return false;
+
+    uint32_t values[4];
+    std::memcpy(values, data.data(), sizeof(values));
+
+    const auto& properties = physicalDevice->getProperties();
+    return values[0] >= headerSize &&
+           values[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           values[2] == properties.vendorID &&
+           values[3] == properties.deviceID &&
+           std::memcmp(data.data() + sizeof(values), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,122 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Exception.h>
+#include <vsg/io/Options.h>
+#include <vsg/vk/StagingRing.h>
+
+#include <cstring>
+
+using namespace vsg;
+
+StagingRing::StagingRing(Device* device, VkDeviceSize in_size, const std::vector<uint32_t>& queueFamilyIndices) :
+    _size(in_size)
+{
+    _buffer = Buffer::create(_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    if (queueFamilyIndices.size() > 1)
+    {
+        _buffer->sharingMode = VK_SHARING_MODE_CONCURRENT;
+        _buffer->queueFamilyIndices = queueFamilyIndices;
+    }
+    _buffer->compile(device);
+
+    // Buffer(Device*, ..) allocates and binds dedicated host visible, coherent memory so it can be mapped once for the lifetime of the ring.
+    _deviceMemory = _buffer->getDeviceMemory(device->deviceID);
+
+    void* mappedData = nullptr;
+    if (VkResult result = _deviceMemory->map(_buffer->getMemoryOffset(device->deviceID), _size, 0, &mappedData); result != VK_SUCCESS)
+    {
+        throw Exception{"Error: Failed to map StagingRing memory.", result};
+    }
+    _mappedData = static_cast<uint8_t*>(mappedData);
+}
+
+StagingRing::~StagingRing()
+{
+    if (_mappedData) _deviceMemory->unmap();
+}
+
+BufferInfo StagingRing::reserve(VkDeviceSize size, VkDeviceSize alignment)
+{
+    if (size == 0 || size > _size) return {};
+    if (alignment == 0) alignment = 1;
+
+    uint64_t head = _head.load();
+    uint64_t start;
+    do
+    {
+        VkDeviceSize offset = head % _size;
+        VkDeviceSize alignedOffset = ((offset + alignment - 1) / alignment) * alignment;
+        if (alignedOffset + size <= _size)
+        {
+            start = head - offset + alignedOffset;
+        }
+        else
+        {
+            // not enough space before the end of the buffer, so wrap around to the start
+            start = head - offset + _size;
+        }
+
+        if ((start + size - _tail.load()) > _size) return {};
+
+    } while (!_head.compare_exchange_weak(head, start + size));
+
+    return BufferInfo(_buffer, start % _size, size);
+}
+
+BufferInfo StagingRing::copy(const Data* data, VkDeviceSize alignment)
+{
+    BufferInfo bufferInfo = reserve(data->dataSize(), alignment);
+    if (bufferInfo.buffer)
+    {
+        std::memcpy(dataPointer(bufferInfo.offset), data->dataPointer(), data->dataSize());
+        bufferInfo.data = const_cast<Data*>(data);
+    }
+    return bufferInfo;
+}
+
+uint64_t StagingRing::submit()
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    _submissions.emplace_back(++_submissionCount, _head.load());
+    return _submissionCount;
+}
+
+void StagingRing::retire(uint64_t submission)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    bool retired = false;
+    uint64_t tail = _tail.load();
+    while (!_submissions.empty() && _submissions.front().first <= submission)
+    {
+        tail = _submissions.front().second;
+        _submissions.pop_front();
+        retired = true;
+    }
+
+    if (!retired) return;
+
+    _tail.exchange(tail);
+
+    // when all regions are retired restart at the beginning of the buffer, so that large reservations aren't blocked by the space lost to wrapping around
+    if (_submissions.empty())
+    {
+        uint64_t head = tail;
+        uint64_t restart = ((tail + _size - 1) / _size) * _size;
+        if (restart != tail && _head.compare_exchange_strong(head, restart))
+        {
+            _tail.exchange(restart);
+        }
+    }
+}
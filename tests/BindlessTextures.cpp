@@ -0,0 +1,92 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Array2D.h>
+#include <vsg/state/StateGroup.h>
+#include <vsg/state/BindlessTextures.h>
+#include <vsg/traversals/RecordTraversal.h>
+#include <vsg/vk/Context.h>
+#include <vsg/vk/State.h>
+
+#include "TestDevice.h"
+
+using namespace vsg;
+
+// checks that a subgraph with a BindlessTexture, compiled after the State of the RecordTraversal was sized for the initial scene graph as done for paged tiles,
+// is recorded with the State's stateStacks grown to cover the BindlessTexture's slot. The compile of the BindlessTexture requires a Vulkan device with
+// VK_EXT_descriptor_indexing, software ICDs are sufficient, otherwise only the record traversal is checked.
+
+ref_ptr<StateGroup> createTile(ref_ptr<BindlessTextures> textures)
+{
+    auto image = ubvec4Array2D::create(4, 4, ubvec4(255, 255, 255, 255));
+    image->setFormat(VK_FORMAT_R8G8B8A8_UNORM);
+
+    ImageInfo imageInfo(Sampler::create(), ImageView::create(Image::create(image)), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    auto tile = StateGroup::create();
+    tile->add(BindlessTexture::create(textures, imageInfo));
+    tile->addChild(Group::create());
+    return tile;
+}
+
+int main()
+{
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    // RecordTraversal sized for an initial scene graph that only uses the pipeline, descriptor set and push constant slots, as Viewer::compile() does
+    const uint32_t maxSlot = 2;
+    RecordTraversal recordTraversal(nullptr, maxSlot);
+
+    auto textures = BindlessTextures::create(16);
+    auto tile = createTile(textures);
+
+    auto device = createTestDevice({VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME});
+    if (device && device->supportsDeviceExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        Context context(device);
+        auto queueFamily = device->getPhysicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+        context.graphicsQueue = device->getQueue(queueFamily);
+        context.commandPool = CommandPool::create(device, queueFamily);
+
+        auto bindlessTexture = tile->getStateCommands().front().cast<BindlessTexture>();
+        bindlessTexture->compile(context);
+        context.record();
+        context.waitForCompletion();
+
+        if (bindlessTexture->index() == BindlessTexture::INVALID_INDEX) fail("BindlessTexture not assigned an index when compiled");
+    }
+    else
+    {
+        std::cout << "BindlessTexture compile tests skipped, no Vulkan device with VK_EXT_descriptor_indexing available" << std::endl;
+    }
+
+    // record the tile twice, as a paged tile is recorded every frame
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        tile->accept(recordTraversal);
+
+        auto& stateStacks = recordTraversal.getState()->stateStacks;
+        if (stateStacks.size() <= BindlessTexture::DEFAULT_SLOT)
+        {
+            fail("stateStacks not grown to cover the BindlessTexture slot");
+            break;
+        }
+        if (stateStacks[BindlessTexture::DEFAULT_SLOT].size() != 0) fail("BindlessTexture not popped from its StateStack after the tile was recorded");
+    }
+
+    if (failures == 0) std::cout << "BindlessTextures tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/commands/Draw.h>
+#include <vsg/maths/transform.h>
+#include <vsg/nodes/MatrixTransform.h>
+#include <vsg/nodes/QuadGroup.h>
+#include <vsg/nodes/VertexIndexDraw.h>
+#include <vsg/traversals/ComputeBounds.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace vsg;
+
+// checks that ComputeBounds with a ParallelTraversal computes the same bounds as the serial traversal, and reports the scaling with the number of threads on a synthetic scene
+
+ref_ptr<Node> createScene(size_t numTransforms, size_t numVertices)
+{
+    auto group = Group::create();
+    for (size_t i = 0; i < numTransforms; ++i)
+    {
+        auto vertices = vec3Array::create(numVertices);
+        for (size_t j = 0; j < numVertices; ++j)
+        {
+            vertices->at(j) = vec3(float(j % 7), float(j % 11) - float(i % 13), float(j) * 0.01f);
+        }
+
+        auto vertexIndexDraw = VertexIndexDraw::create();
+        vertexIndexDraw->arrays = DataList{vertices};
+
+        auto transform = MatrixTransform::create(translate(double(i), 0.0, double(i % 17)));
+        transform->addChild(vertexIndexDraw);
+        group->addChild(transform);
+    }
+
+    // share the group beneath a QuadGroup so both parallel code paths are exercised
+    auto quadGroup = QuadGroup::create();
+    for (size_t i = 0; i < 4; ++i)
+    {
+        auto transform = MatrixTransform::create(translate(0.0, 0.0, double(i) * 100.0));
+        transform->addChild(group);
+        quadGroup->setChild(i, transform);
+    }
+    return quadGroup;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numTransforms = (argc > 1) ? std::stoul(argv[1]) : 4000;
+    auto scene = createScene(numTransforms, 300);
+
+    auto computeBounds = ComputeBounds::create();
+    auto start = std::chrono::steady_clock::now();
+    scene->accept(*computeBounds);
+    double serialTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "serial    : bounds " << computeBounds->bounds.min << ", " << computeBounds->bounds.max << ", time " << serialTime << "s" << std::endl;
+
+    int failures = 0;
+    for (size_t numThreads : {1, 2, 4, 8})
+    {
+        auto parallelComputeBounds = ComputeBounds::create();
+        parallelComputeBounds->parallelTraversal = ParallelTraversal::create(OperationThreads::create(numThreads));
+
+        start = std::chrono::steady_clock::now();
+        scene->accept(*parallelComputeBounds);
+        double parallelTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "threads " << numThreads << " : time " << parallelTime << "s, speed up " << (serialTime / parallelTime) << std::endl;
+
+        if (parallelComputeBounds->bounds.min != computeBounds->bounds.min || parallelComputeBounds->bounds.max != computeBounds->bounds.max)
+        {
+            std::cout << "Error: parallel bounds " << parallelComputeBounds->bounds.min << ", " << parallelComputeBounds->bounds.max << " differ from the serial bounds" << std::endl;
+            ++failures;
+        }
+    }
+
+    if (failures == 0) std::cout << "ComputeBounds tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Array.h>
+#include <vsg/state/BufferInfo.h>
+
+#include "TestDevice.h"
+
+#include <cstring>
+
+using namespace vsg;
+
+// checks that Data::dirty(offset, size) records merged dirty ranges that are discarded by dirty() or when too many accumulate,
+// and that BufferInfo::copyDataToBuffer(..) always copies Data that has never been dirty()'d, skips unmodified Data once it has been dirty()'d,
+// copies just the dirty ranges and copies the whole data when the copyState is cleared, and that copyDataListToBuffers(..) copies to Buffers that share a DeviceMemory
+// at non zero memory offsets. The BufferInfo checks require a Vulkan device, software ICDs are sufficient.
+
+// read back the values of a host visible BufferInfo
+std::vector<float> readBuffer(BufferInfo& bufferInfo, uint32_t deviceID)
+{
+    std::vector<float> values(bufferInfo.range / sizeof(float));
+    auto dm = bufferInfo.buffer->getDeviceMemory(deviceID);
+    void* buffer_data;
+    dm->map(bufferInfo.buffer->getMemoryOffset(deviceID) + bufferInfo.offset, bufferInfo.range, 0, &buffer_data);
+    std::memcpy(values.data(), buffer_data, bufferInfo.range);
+    dm->unmap();
+    return values;
+}
+
+int main()
+{
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    // dirty ranges, overlapping and adjacent ranges are merged
+    {
+        auto array = floatArray::create(100);
+        Data::DirtyRanges ranges;
+
+        uint32_t modifiedCount = array->getModifiedCount();
+        array->dirtyValues(10, 2);
+        array->dirtyValues(11, 4);
+        array->dirtyValues(50, 1);
+        if (!array->getDirtyRanges(modifiedCount, ranges) || ranges.size() != 2 || ranges[0].offset != 40 || ranges[0].size != 20 || ranges[1].offset != 200 || ranges[1].size != 4)
+        {
+            fail("dirty ranges not merged, expected byte ranges 40/20 and 200/4");
+        }
+
+        modifiedCount = array->getModifiedCount();
+        array->dirtyValues(90, 1);
+        if (!array->getDirtyRanges(modifiedCount, ranges) || ranges.size() != 1 || ranges[0].offset != 360) fail("dirty ranges include ranges modified before the ModifiedCount was taken");
+
+        array->dirty();
+        if (array->getDirtyRanges(modifiedCount, ranges)) fail("dirty ranges reported after dirty() modified the whole data");
+        if (!array->getDirtyRanges(array->getModifiedCount(), ranges) || !ranges.empty()) fail("dirty ranges reported for an unmodified data");
+
+        modifiedCount = array->getModifiedCount();
+        for (size_t i = 0; i < Data::maxNumDirtyRanges + 6; ++i) array->dirtyValues(i, 1);
+        if (array->getDirtyRanges(modifiedCount, ranges)) fail("dirty ranges reported after the oldest ranges were discarded");
+        if (!array->getDirtyRanges(modifiedCount + 6, ranges) || ranges.size() != 1 || ranges[0].offset != 24 || ranges[0].size != Data::maxNumDirtyRanges * 4)
+        {
+            fail("retained dirty ranges not merged");
+        }
+    }
+
+    auto device = createTestDevice();
+    if (device)
+    {
+        uint32_t deviceID = device->deviceID;
+
+        const uint32_t numValues = 16;
+        auto array = floatArray::create(numValues, 0.0f);
+        auto bufferInfoList = createHostVisibleBuffer(device, DataList{array}, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+        auto& bufferInfo = bufferInfoList.front();
+        auto expected = [&array]() { return std::vector<float>(array->data(), array->data() + array->size()); };
+
+        bufferInfo.copyDataToBuffer(deviceID);
+        if (readBuffer(bufferInfo, deviceID) != expected()) fail("initial copy of data to the buffer failed");
+
+        // data that has never been dirty()'d is copied every time
+        (*array)[3] = 3.0f;
+        bufferInfo.copyDataToBuffer(deviceID);
+        if (readBuffer(bufferInfo, deviceID) != expected()) fail("data that has never been dirty()'d wasn't copied");
+
+        // once dirty()'d, unmodified data is skipped
+        (*array)[4] = 4.0f;
+        array->dirty();
+        bufferInfo.copyDataToBuffer(deviceID);
+        if (readBuffer(bufferInfo, deviceID) != expected()) fail("data modified with dirty() wasn't copied");
+
+        (*array)[5] = 5.0f;
+        bufferInfo.copyDataToBuffer(deviceID);
+        if (readBuffer(bufferInfo, deviceID)[5] != 0.0f) fail("data that has been dirty()'d was copied without being modified since the last copy");
+
+        // just the dirty ranges are copied
+        (*array)[7] = 7.0f;
+        array->dirtyValues(7, 1);
+        bufferInfo.copyDataToBuffer(deviceID);
+        auto values = readBuffer(bufferInfo, deviceID);
+        if (values[7] != 7.0f) fail("dirty range wasn't copied");
+        if (values[5] != 0.0f) fail("values outside of the dirty ranges were copied");
+
+        // clearing the copyState forces a copy of the whole data
+        bufferInfo.copyState.clear();
+        bufferInfo.copyDataToBuffer(deviceID);
+        if (readBuffer(bufferInfo, deviceID) != expected()) fail("whole data not copied after the copyState was cleared");
+
+        // two Buffers bound to the same DeviceMemory, the second at a non zero memory offset, are copied with a single map
+        {
+            auto buffer1 = Buffer::create(device, numValues * sizeof(float), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+            auto buffer2 = Buffer::create(device, numValues * sizeof(float), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+
+            auto requirements = buffer1->getMemoryRequirements(deviceID);
+            VkDeviceSize memoryOffset = ((requirements.size + requirements.alignment - 1) / requirements.alignment) * requirements.alignment;
+            requirements.size = memoryOffset + buffer2->getMemoryRequirements(deviceID).size;
+
+            auto memory = DeviceMemory::create(device, requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            buffer1->bind(memory, 0);
+            buffer2->bind(memory, memoryOffset);
+
+            auto array1 = floatArray::create(numValues, 1.0f);
+            auto array2 = floatArray::create(numValues, 2.0f);
+            BufferInfoList sharedMemoryList{BufferInfo(buffer1, 0, array1->dataSize(), array1), BufferInfo(buffer2, 0, array2->dataSize(), array2)};
+            copyDataListToBuffers(deviceID, sharedMemoryList);
+
+            if (readBuffer(sharedMemoryList[0], deviceID) != std::vector<float>(numValues, 1.0f)) fail("data not copied to the Buffer at the start of a shared DeviceMemory");
+            if (readBuffer(sharedMemoryList[1], deviceID) != std::vector<float>(numValues, 2.0f)) fail("data not copied to the Buffer at a non zero offset of a shared DeviceMemory");
+        }
+    }
+    else
+    {
+        std::cout << "BufferInfo copy tests skipped, no Vulkan device available" << std::endl;
+    }
+
+    if (failures == 0) std::cout << "Data tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Array2D.h>
+#include <vsg/core/Value.h>
+#include <vsg/state/DescriptorBuffer.h>
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/state/DescriptorSet.h>
+#include <vsg/vk/Context.h>
+
+#include "TestDevice.h"
+
+#include <chrono>
+
+using namespace vsg;
+
+// checks that DescriptorSets are written with the layout's descriptor update template when VK_KHR_descriptor_update_template is enabled,
+// that the vkUpdateDescriptorSets path is used otherwise or when the descriptors don't cover the layout, and reports the compile time of a synthetic tile with each path.
+// Requires a Vulkan device, software ICDs are sufficient.
+
+const uint32_t numUniforms = 4;
+const uint32_t numTextures = 4;
+
+ref_ptr<DescriptorSetLayout> createLayout()
+{
+    DescriptorSetLayoutBindings bindings;
+    for (uint32_t i = 0; i < numUniforms; ++i) bindings.push_back(VkDescriptorSetLayoutBinding{i, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr});
+    bindings.push_back(VkDescriptorSetLayoutBinding{numUniforms, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, numTextures, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr});
+    return DescriptorSetLayout::create(bindings);
+}
+
+// descriptor sets for a tile, each with its own uniforms and small textures
+std::vector<ref_ptr<DescriptorSet>> createTile(ref_ptr<DescriptorSetLayout> layout, size_t numDescriptorSets)
+{
+    auto sampler = Sampler::create();
+
+    std::vector<ref_ptr<DescriptorSet>> descriptorSets;
+    for (size_t i = 0; i < numDescriptorSets; ++i)
+    {
+        Descriptors descriptors;
+        for (uint32_t binding = 0; binding < numUniforms; ++binding)
+        {
+            descriptors.push_back(DescriptorBuffer::create(vec4Value::create(vec4(float(i), float(binding), 0.0f, 1.0f)), binding));
+        }
+
+        for (uint32_t element = 0; element < numTextures; ++element)
+        {
+            auto image = ubvec4Array2D::create(4, 4);
+            image->setFormat(VK_FORMAT_R8G8B8A8_UNORM);
+            for (auto& texel : *image) texel = ubvec4(uint8_t(i), uint8_t(element), 0, 255);
+
+            descriptors.push_back(DescriptorImage::create(sampler, image, numUniforms, element));
+        }
+
+        descriptorSets.push_back(DescriptorSet::create(layout, descriptors));
+    }
+    return descriptorSets;
+}
+
+int main()
+{
+    auto templateDevice = createTestDevice({VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME});
+    auto device = createTestDevice();
+    if (!templateDevice || !device)
+    {
+        std::cout << "DescriptorSet tests skipped, no Vulkan device available" << std::endl;
+        return TEST_SKIPPED;
+    }
+
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    const size_t numDescriptorSets = 300;
+
+    for (auto& testDevice : {templateDevice, device})
+    {
+        bool useTemplate = testDevice->supportsDeviceExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+
+        Context context(testDevice);
+        auto layout = createLayout();
+        auto tile = createTile(layout, numDescriptorSets);
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto& descriptorSet : tile) descriptorSet->compile(context);
+        double compileTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (useTemplate ? "descriptor update template" : "vkUpdateDescriptorSets   ") << " : compile " << numDescriptorSets << " descriptor sets, time " << compileTime << "s" << std::endl;
+
+        // rewrite the descriptor sets directly to check which path the layout takes
+        size_t numTemplateUpdates = 0;
+        for (auto& descriptorSet : tile)
+        {
+            if (layout->updateDescriptorSet(context, descriptorSet->vk(context.deviceID), descriptorSet->descriptors)) ++numTemplateUpdates;
+        }
+
+        if (useTemplate && numTemplateUpdates != tile.size()) fail("descriptor sets not written with the descriptor update template when VK_KHR_descriptor_update_template is enabled");
+        if (!useTemplate && numTemplateUpdates != 0) fail("descriptor update template used without VK_KHR_descriptor_update_template enabled");
+
+        // descriptors that leave part of the layout unwritten must fall back to vkUpdateDescriptorSets
+        auto& descriptorSet = tile.front();
+        Descriptors partialDescriptors(descriptorSet->descriptors.begin() + 1, descriptorSet->descriptors.end());
+        if (layout->updateDescriptorSet(context, descriptorSet->vk(context.deviceID), partialDescriptors)) fail("descriptor update template used for descriptors that don't cover the layout");
+    }
+
+    if (!templateDevice->supportsDeviceExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME))
+    {
+        std::cout << "VK_KHR_descriptor_update_template not supported, only the vkUpdateDescriptorSets path was tested" << std::endl;
+    }
+
+    if (failures == 0) std::cout << "DescriptorSet tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
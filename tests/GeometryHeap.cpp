@@ -0,0 +1,186 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/commands/CopyAndReleaseBuffer.h>
+#include <vsg/core/Array.h>
+#include <vsg/nodes/VertexIndexDraw.h>
+#include <vsg/vk/Context.h>
+#include <vsg/vk/GeometryHeap.h>
+
+#include "TestDevice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+
+using namespace vsg;
+
+// checks that with BufferPreferences::useGeometryHeap set VertexIndexDraw share the buffers of GeometryHeap blocks with non overlapping vertex and index ranges,
+// that unsuitable arrays fall back to dedicated buffers, that released ranges are reused, and reports the number of vertex/index buffer binds required with and without the heap.
+// Requires a Vulkan device, software ICDs are sufficient.
+
+// provides access to the GeometryHeap allocation made by VertexIndexDraw::compile(..)
+class TestVertexIndexDraw : public Inherit<VertexIndexDraw, TestVertexIndexDraw>
+{
+public:
+    const GeometryHeap::Allocation& heapAllocation(uint32_t deviceID) const { return _vulkanData[deviceID].heapAllocation; }
+    const BufferInfo& indexBufferInfo(uint32_t deviceID) const { return _vulkanData[deviceID].bufferInfo; }
+};
+
+// box like geometry with positions, normals and 16bit indices, offset so each draw has distinct data
+ref_ptr<TestVertexIndexDraw> createDraw(size_t i, uint32_t numVertices = 24, uint32_t numIndices = 36)
+{
+    auto vertices = vec3Array::create(numVertices);
+    auto normals = vec3Array::create(numVertices);
+    for (uint32_t v = 0; v < numVertices; ++v)
+    {
+        (*vertices)[v] = vec3(float(i), float(v), 0.0f);
+        (*normals)[v] = vec3(0.0f, 0.0f, 1.0f);
+    }
+
+    auto indices = ushortArray::create(numIndices);
+    for (uint32_t n = 0; n < numIndices; ++n) (*indices)[n] = static_cast<uint16_t>(n % numVertices);
+
+    auto draw = TestVertexIndexDraw::create();
+    draw->arrays = DataList{vertices, normals};
+    draw->indices = indices;
+    draw->indexCount = numIndices;
+    draw->instanceCount = 1;
+    return draw;
+}
+
+void assignQueue(Context& context)
+{
+    auto queueFamily = context.device->getPhysicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+    context.graphicsQueue = context.device->getQueue(queueFamily);
+    context.commandPool = CommandPool::create(context.device, queueFamily);
+}
+
+int main()
+{
+    auto device = createTestDevice();
+    if (!device)
+    {
+        std::cout << "GeometryHeap tests skipped, no Vulkan device available" << std::endl;
+        return TEST_SKIPPED;
+    }
+
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    const size_t numDraws = 2000;
+    const uint32_t numVertices = 24;
+    const uint32_t numIndices = 36;
+
+    BufferPreferences heapPreferences;
+    heapPreferences.useGeometryHeap = true;
+    heapPreferences.geometryHeapVertexCapacity = 16 * 1024;
+    heapPreferences.geometryHeapIndexCapacity = 32 * 1024;
+
+    for (bool useGeometryHeap : {true, false})
+    {
+        BufferPreferences bufferPreferences;
+        if (useGeometryHeap) bufferPreferences = heapPreferences;
+
+        Context context(device, bufferPreferences);
+        assignQueue(context);
+
+        std::vector<ref_ptr<TestVertexIndexDraw>> draws;
+        for (size_t i = 0; i < numDraws; ++i) draws.push_back(createDraw(i, numVertices, numIndices));
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto& draw : draws) draw->compile(context);
+        context.record();
+        context.waitForCompletion();
+        double compileTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // consecutive draws need to bind buffers only when they use a different block, or always without the heap
+        size_t numBinds = 0;
+        const Object* previousBlock = nullptr;
+        std::set<const Object*> blocks;
+        for (auto& draw : draws)
+        {
+            auto& allocation = draw->heapAllocation(context.deviceID);
+            if (!allocation.block || allocation.block.get() != previousBlock) ++numBinds;
+            previousBlock = allocation.block.get();
+            if (allocation.block) blocks.insert(allocation.block.get());
+        }
+
+        std::cout << (useGeometryHeap ? "geometry heap    " : "dedicated buffers") << " : compile " << numDraws << " draws, time " << compileTime << "s, vertex/index buffer binds " << numBinds << std::endl;
+
+        if (!useGeometryHeap)
+        {
+            if (!blocks.empty()) fail("GeometryHeap used without BufferPreferences::useGeometryHeap set");
+            continue;
+        }
+
+        // each block holds as many draws as fit its vertex and index capacity
+        size_t drawsPerBlock = std::min(heapPreferences.geometryHeapVertexCapacity / numVertices, heapPreferences.geometryHeapIndexCapacity / numIndices);
+        size_t expectedBlocks = (numDraws + drawsPerBlock - 1) / drawsPerBlock;
+        if (blocks.size() != expectedBlocks) fail("VertexIndexDraw allocated from " + std::to_string(blocks.size()) + " GeometryHeap blocks, expected " + std::to_string(expectedBlocks));
+
+        // the draws within a block must have non overlapping vertex and index ranges
+        std::map<const Object*, std::set<uint32_t>> vertexBases, indexBases;
+        for (auto& draw : draws)
+        {
+            auto& allocation = draw->heapAllocation(context.deviceID);
+            if (!allocation)
+            {
+                fail("VertexIndexDraw not allocated from the GeometryHeap");
+                continue;
+            }
+            if ((allocation.vertexBase % numVertices) != 0 || (allocation.indexBase % numIndices) != 0 || allocation.vertexBase + numVertices > heapPreferences.geometryHeapVertexCapacity || allocation.indexBase + numIndices > heapPreferences.geometryHeapIndexCapacity)
+            {
+                fail("GeometryHeap allocation outside its block or overlapping another");
+            }
+            if (!vertexBases[allocation.block.get()].insert(allocation.vertexBase).second || !indexBases[allocation.block.get()].insert(allocation.indexBase).second)
+            {
+                fail("GeometryHeap allocations overlap");
+            }
+        }
+
+        // arrays that aren't suitable for the heap fall back to dedicated buffers
+        auto largeDraw = createDraw(numDraws, heapPreferences.geometryHeapVertexCapacity + 1, numIndices);
+        largeDraw->compile(context);
+        if (largeDraw->heapAllocation(context.deviceID) || !largeDraw->indexBufferInfo(context.deviceID).buffer) fail("VertexIndexDraw too large for a GeometryHeap block didn't fall back to dedicated buffers");
+
+        auto mismatchedDraw = createDraw(numDraws + 1);
+        mismatchedDraw->arrays.push_back(vec2Array::create(numVertices / 2));
+        mismatchedDraw->compile(context);
+        if (mismatchedDraw->heapAllocation(context.deviceID) || !mismatchedDraw->indexBufferInfo(context.deviceID).buffer) fail("VertexIndexDraw with mismatched array sizes didn't fall back to dedicated buffers");
+
+        context.record();
+        context.waitForCompletion();
+
+        // released ranges are reused rather than allocating further blocks
+        auto firstAllocation = draws.front()->heapAllocation(context.deviceID);
+        draws.front() = {};
+
+        auto replacementDraw = createDraw(numDraws + 2);
+        replacementDraw->compile(context);
+        auto& replacement = replacementDraw->heapAllocation(context.deviceID);
+        if (replacement.block != firstAllocation.block || replacement.vertexBase != firstAllocation.vertexBase || replacement.indexBase != firstAllocation.indexBase)
+        {
+            fail("GeometryHeap didn't reuse the range released by a deleted VertexIndexDraw");
+        }
+
+        context.record();
+        context.waitForCompletion();
+    }
+
+    if (failures == 0) std::cout << "GeometryHeap tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/commands/CopyAndReleaseImage.h>
+#include <vsg/core/Array2D.h>
+#include <vsg/state/DescriptorImage.h>
+#include <vsg/vk/Context.h>
+
+#include "TestDevice.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace vsg;
+
+// checks that the image uploads of DescriptorImage compiled with a Context are batched into a single CopyAndReleaseImage command until the Context is recorded,
+// with and without generated mipmaps, that the next compile starts a new batch, and reports the time to compile and upload a batch of textures.
+// Requires a Vulkan device, software ICDs are sufficient.
+
+ref_ptr<DescriptorImage> createTexture(ref_ptr<Sampler> sampler, uint32_t size, uint8_t value)
+{
+    auto image = ubvec4Array2D::create(size, size);
+    image->setFormat(VK_FORMAT_R8G8B8A8_UNORM);
+    for (auto& texel : *image) texel = ubvec4(value, value, 0, 255);
+
+    return DescriptorImage::create(sampler, image, 0, 0);
+}
+
+size_t numCopyAndReleaseImage(const Context& context)
+{
+    return std::count_if(context.commands.begin(), context.commands.end(), [](const ref_ptr<Command>& command) { return command->cast<CopyAndReleaseImage>() != nullptr; });
+}
+
+int main()
+{
+    auto device = createTestDevice();
+    if (!device)
+    {
+        std::cout << "ImageUpload tests skipped, no Vulkan device available" << std::endl;
+        return TEST_SKIPPED;
+    }
+
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    Context context(device);
+    auto queueFamily = device->getPhysicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+    context.graphicsQueue = device->getQueue(queueFamily);
+    context.commandPool = CommandPool::create(device, queueFamily);
+
+    // textures with mipmaps generated while recording and textures without mipmaps
+    auto mipmapSampler = Sampler::create();
+    auto nearestSampler = Sampler::create();
+    nearestSampler->maxLod = 0.0f;
+
+    const size_t numTextures = 200;
+    std::vector<ref_ptr<DescriptorImage>> textures;
+    for (size_t i = 0; i < numTextures; ++i)
+    {
+        if ((i % 2) == 0)
+            textures.push_back(createTexture(mipmapSampler, 64, uint8_t(i)));
+        else
+            textures.push_back(createTexture(nearestSampler, 16, uint8_t(i)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& texture : textures) texture->compile(context);
+
+    if (!context.copyAndReleaseImage || context.copyAndReleaseImage->size() != numTextures) fail("image uploads not batched into the Context's CopyAndReleaseImage");
+    if (numCopyAndReleaseImage(context) != 1) fail(std::to_string(numCopyAndReleaseImage(context)) + " CopyAndReleaseImage commands recorded, expected 1");
+
+    context.record();
+    context.waitForCompletion();
+    double uploadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "compile and upload " << numTextures << " textures in one batch, time " << uploadTime << "s" << std::endl;
+
+    if (context.copyAndReleaseImage) fail("CopyAndReleaseImage batch retained after Context::record()");
+
+    // the next compile starts a new batch
+    auto texture = createTexture(mipmapSampler, 32, 0);
+    texture->compile(context);
+    if (!context.copyAndReleaseImage || context.copyAndReleaseImage->size() != 1) fail("image upload after Context::record() not added to a new batch");
+    if (numCopyAndReleaseImage(context) != 1) fail("image upload after Context::record() recorded more than one CopyAndReleaseImage command");
+
+    context.record();
+    context.waitForCompletion();
+
+    if (failures == 0) std::cout << "ImageUpload tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+
+#include <vsg/core/Array.h>
+#include <vsg/state/DescriptorBuffer.h>
+#include <vsg/state/DescriptorSet.h>
+#include <vsg/vk/Context.h>
+#include <vsg/vk/MemoryBufferPools.h>
+
+#include "TestDevice.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace vsg;
+
+// checks that MemoryBufferPools::releaseUnusedMemory(context) relocates the ranges of a sparsely used Buffer block, referenced by DescriptorSets, into a denser block,
+// that the DescriptorSets switch to rewritten descriptor sets referencing the new ranges in updateRelocations(..), and that the fragmentation of the pools goes down.
+// Requires a Vulkan device, software ICDs are sufficient.
+
+void assignQueue(Context& context)
+{
+    auto queueFamily = context.device->getPhysicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+    context.graphicsQueue = context.device->getQueue(queueFamily);
+    context.commandPool = CommandPool::create(context.device, queueFamily);
+}
+
+int main()
+{
+    auto device = createTestDevice();
+    if (!device)
+    {
+        std::cout << "MemoryCompaction tests skipped, no Vulkan device available" << std::endl;
+        return TEST_SKIPPED;
+    }
+
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    // blocks of 16 storage buffer ranges of 4KB each
+    const VkDeviceSize blockSize = 64 * 1024;
+    const uint32_t numPerBlock = 16;
+    const uint32_t numDescriptorSets = 2 * numPerBlock;
+
+    BufferPreferences bufferPreferences;
+    bufferPreferences.minimumBufferSize = blockSize;
+    bufferPreferences.minimumBufferDeviceMemorySize = blockSize;
+
+    Context context(device, bufferPreferences);
+    assignQueue(context);
+
+    auto& pools = context.deviceMemoryBufferPools;
+
+    auto layout = DescriptorSetLayout::create(DescriptorSetLayoutBindings{{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}});
+
+    std::vector<ref_ptr<DescriptorSet>> descriptorSets;
+    for (uint32_t i = 0; i < numDescriptorSets; ++i)
+    {
+        auto data = vec4Array::create(256);
+        for (auto& value : *data) value = vec4(float(i), 0.0f, 0.0f, 1.0f);
+
+        auto bufferInfoList = createBufferAndTransferData(context, DataList{data}, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+
+        // the data has been uploaded, so DescriptorBuffer::compile(..) doesn't need to map the device local memory to copy it
+        for (auto& bufferInfo : bufferInfoList) bufferInfo.data = nullptr;
+
+        auto descriptorSet = DescriptorSet::create(layout, Descriptors{DescriptorBuffer::create(bufferInfoList, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)});
+        descriptorSet->compile(context);
+        descriptorSets.push_back(descriptorSet);
+    }
+
+    context.record();
+    context.waitForCompletion();
+
+    auto bufferInfoOf = [](const DescriptorSet* descriptorSet) -> const BufferInfo& { return descriptorSet->descriptors.front()->cast<DescriptorBuffer>()->bufferInfoList.front(); };
+
+    ref_ptr<Buffer> denseBlock = bufferInfoOf(descriptorSets.front()).buffer;
+    ref_ptr<Buffer> sparseBlock = bufferInfoOf(descriptorSets.back()).buffer;
+    if (!denseBlock || !sparseBlock || denseBlock == sparseBlock)
+    {
+        fail("storage buffers not reserved from two Buffer blocks");
+        return 1;
+    }
+
+    // leave 12 ranges in the first block and 3 scattered ranges in the second
+    for (uint32_t i : {1u, 5u, 9u, 13u}) descriptorSets[i] = {};
+    for (uint32_t i = numPerBlock; i < numDescriptorSets; ++i)
+    {
+        if (i != numPerBlock + 2 && i != numPerBlock + 7 && i != numPerBlock + 12) descriptorSets[i] = {};
+    }
+    descriptorSets.erase(std::remove(descriptorSets.begin(), descriptorSets.end(), ref_ptr<DescriptorSet>()), descriptorSets.end());
+
+    std::map<const DescriptorSet*, VkDescriptorSet> previousDescriptorSets;
+    for (auto& descriptorSet : descriptorSets) previousDescriptorSets[descriptorSet.get()] = descriptorSet->vk(context.deviceID);
+
+    auto before = pools->computeBufferStatistics();
+
+    // start the compaction, copying the ranges of the sparse block
+    pools->releaseUnusedMemory(context);
+    if (!pools->relocationsPending()) fail("compaction of the sparsely used Buffer block not started");
+
+    context.record();
+    context.waitForCompletion();
+
+    // the copies have completed so the BufferInfo are updated and the DescriptorSets rewritten
+    pools->releaseUnusedMemory(context);
+    for (auto& descriptorSet : descriptorSets)
+    {
+        if (bufferInfoOf(descriptorSet).buffer != denseBlock) fail("BufferInfo not relocated to the densely used Buffer block");
+        if (descriptorSet->vk(context.deviceID) != previousDescriptorSets[descriptorSet.get()]) fail("DescriptorSet switched before updateRelocations(..)");
+    }
+
+    // the first update switches to the rewritten descriptor sets, the later one releases the previous ranges once the frames using them have completed
+    uint64_t frameCount = 10;
+    pools->updateRelocations(frameCount);
+    size_t numSwitched = 0;
+    for (auto& descriptorSet : descriptorSets)
+    {
+        if (descriptorSet->vk(context.deviceID) != previousDescriptorSets[descriptorSet.get()]) ++numSwitched;
+    }
+    if (numSwitched != 3) fail("DescriptorSets switched = " + std::to_string(numSwitched) + ", expected 3 referencing the relocated ranges");
+
+    pools->updateRelocations(frameCount + bufferPreferences.compactionRetainFrames - 1);
+    if (sparseBlock->memorySlots().totalReservedSize() == 0) fail("relocated ranges released before BufferPreferences::compactionRetainFrames");
+
+    pools->updateRelocations(frameCount + bufferPreferences.compactionRetainFrames);
+    if (pools->relocationsPending()) fail("relocations still pending after BufferPreferences::compactionRetainFrames");
+    if (sparseBlock->memorySlots().totalReservedSize() != 0) fail("relocated ranges not released");
+
+    pools->releaseUnusedMemory();
+
+    auto after = pools->computeBufferStatistics();
+
+    std::cout << "fragmentation before compaction " << before.fragmentation() << ", after " << after.fragmentation() << std::endl;
+    std::cout << "utilization before compaction " << before.utilization() << ", after " << after.utilization() << std::endl;
+
+    if (after.reservedSize != before.reservedSize) fail("reserved size changed by compaction");
+    if (after.fragmentation() >= before.fragmentation()) fail("fragmentation not reduced by compaction");
+
+    if (failures == 0) std::cout << "MemoryCompaction tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
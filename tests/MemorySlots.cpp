@@ -0,0 +1,287 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/vk/DeviceMemory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace vsg;
+
+// randomized stress test of the TLSF MemorySlots, checking every reservation and reservedRanges() against the ranges currently reserved,
+// and fragmentation benchmark against the multimap best fit allocator that MemorySlots previously used.
+
+// best fit allocator that MemorySlots used prior to TLSF, kept as the reference for the fragmentation benchmark
+class ReferenceMemorySlots
+{
+public:
+    explicit ReferenceMemorySlots(VkDeviceSize availableMemorySize)
+    {
+        _availableMemory.emplace(availableMemorySize, 0);
+        _offsetSizes.emplace(0, availableMemorySize);
+    }
+
+    MemorySlots::OptionalOffset reserve(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        for (auto itr = _availableMemory.lower_bound(size); itr != _availableMemory.end(); ++itr)
+        {
+            VkDeviceSize slotSize = itr->first;
+            VkDeviceSize slotStart = itr->second;
+            VkDeviceSize slotEnd = slotStart + slotSize;
+
+            VkDeviceSize alignedStart = ((slotStart + alignment - 1) / alignment) * alignment;
+            VkDeviceSize alignedEnd = alignedStart + size;
+            if (alignedEnd > slotEnd) continue;
+
+            _availableMemory.erase(itr);
+            _offsetSizes.erase(slotStart);
+
+            if (alignedStart > slotStart) insert(slotStart, alignedStart - slotStart);
+            if (alignedEnd < slotEnd) insert(alignedEnd, slotEnd - alignedEnd);
+
+            _reservedOffsetSizes[alignedStart] = size;
+            return {true, alignedStart};
+        }
+        return {false, 0};
+    }
+
+    void release(VkDeviceSize offset, VkDeviceSize /*size*/)
+    {
+        auto reserved_itr = _reservedOffsetSizes.find(offset);
+        if (reserved_itr == _reservedOffsetSizes.end()) return;
+
+        VkDeviceSize start = offset;
+        VkDeviceSize end = offset + reserved_itr->second;
+        _reservedOffsetSizes.erase(reserved_itr);
+
+        // merge with the adjacent available slots
+        auto next_itr = _offsetSizes.lower_bound(start);
+        if (next_itr != _offsetSizes.end() && next_itr->first == end)
+        {
+            end += next_itr->second;
+            erase(next_itr);
+        }
+
+        next_itr = _offsetSizes.lower_bound(start);
+        if (next_itr != _offsetSizes.begin())
+        {
+            auto previous_itr = std::prev(next_itr);
+            if (previous_itr->first + previous_itr->second == start)
+            {
+                start = previous_itr->first;
+                erase(previous_itr);
+            }
+        }
+
+        insert(start, end - start);
+    }
+
+    VkDeviceSize maximumAvailableSpace() const { return _availableMemory.empty() ? 0 : _availableMemory.rbegin()->first; }
+
+    VkDeviceSize totalAvailableSize() const
+    {
+        VkDeviceSize totalSize = 0;
+        for (auto& [offset, size] : _offsetSizes) totalSize += size;
+        return totalSize;
+    }
+
+protected:
+    void insert(VkDeviceSize offset, VkDeviceSize size)
+    {
+        _availableMemory.emplace(size, offset);
+        _offsetSizes.emplace(offset, size);
+    }
+
+    void erase(std::map<VkDeviceSize, VkDeviceSize>::iterator offset_itr)
+    {
+        auto [offset, size] = *offset_itr;
+        auto range = _availableMemory.equal_range(size);
+        for (auto itr = range.first; itr != range.second; ++itr)
+        {
+            if (itr->second == offset)
+            {
+                _availableMemory.erase(itr);
+                break;
+            }
+        }
+        _offsetSizes.erase(offset_itr);
+    }
+
+    std::multimap<VkDeviceSize, VkDeviceSize> _availableMemory;
+    std::map<VkDeviceSize, VkDeviceSize> _offsetSizes;
+    std::map<VkDeviceSize, VkDeviceSize> _reservedOffsetSizes;
+};
+
+struct Results
+{
+    size_t numFailedReserves = 0;
+    VkDeviceSize maximumAvailableSpace = 0;
+    VkDeviceSize totalAvailableSize = 0;
+    double time = 0.0;
+
+    double fragmentation() const { return totalAvailableSize > 0 ? 1.0 - double(maximumAvailableSpace) / double(totalAvailableSize) : 0.0; }
+};
+
+std::ostream& operator<<(std::ostream& output, const Results& results)
+{
+    return output << "failed reserves " << results.numFailedReserves << ", largest available " << results.maximumAvailableSpace << ", fragmentation " << results.fragmentation() << ", time " << results.time << "s";
+}
+
+// run a random sequence of reserves and releases against allocator, calling validate(offset, size, alignment, totalSize) after each successful reserve
+template<class A, class V>
+Results run(A& allocator, VkDeviceSize totalSize, size_t numOperations, uint64_t seed, V validate)
+{
+    Results results;
+    std::mt19937_64 random(seed);
+    std::vector<std::pair<VkDeviceSize, VkDeviceSize>> reserved;
+
+    for (size_t i = 0; i < numOperations; ++i)
+    {
+        // mix of small and large allocations with varying alignments, slightly biased towards reserving so the memory fills up and fragments
+        bool doReserve = reserved.empty() || (random() % 100) < 52;
+        VkDeviceSize size = (random() % 4 == 0) ? (random() % (256 * 1024) + 1) : (random() % 4096 + 1);
+        VkDeviceSize alignment = VkDeviceSize(1) << (random() % 9);
+        size_t index = random();
+
+        auto start = std::chrono::steady_clock::now();
+        if (doReserve)
+        {
+            auto [reservedSlot, offset] = allocator.reserve(size, alignment);
+            results.time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (reservedSlot)
+            {
+                if (!validate(offset, size, alignment, totalSize)) return results;
+                reserved.emplace_back(offset, size);
+            }
+            else
+            {
+                ++results.numFailedReserves;
+            }
+        }
+        else
+        {
+            index %= reserved.size();
+            auto [offset, reservedSize] = reserved[index];
+            reserved[index] = reserved.back();
+            reserved.pop_back();
+
+            start = std::chrono::steady_clock::now();
+            allocator.release(offset, reservedSize);
+            results.time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    results.maximumAvailableSpace = allocator.maximumAvailableSpace();
+    results.totalAvailableSize = allocator.totalAvailableSize();
+    return results;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numOperations = (argc > 1) ? std::stoul(argv[1]) : 200000;
+    const VkDeviceSize totalSize = 64 * 1024 * 1024;
+
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+        return false;
+    };
+
+    // stress test, tracking the reserved ranges independently to check that every reservation is aligned, in bounds and doesn't overlap another
+    MemorySlots memorySlots(totalSize);
+    std::map<VkDeviceSize, VkDeviceSize> reservedRanges;
+    size_t numReserves = 0;
+
+    auto validate = [&](VkDeviceSize offset, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize total) {
+        if ((offset % alignment) != 0) return fail("reservation not aligned");
+        if ((offset + size) > total) return fail("reservation out of bounds");
+
+        auto next_itr = reservedRanges.lower_bound(offset);
+        if (next_itr != reservedRanges.end() && next_itr->first < (offset + size)) return fail("reservation overlaps the following range");
+        if (next_itr != reservedRanges.begin())
+        {
+            auto previous_itr = std::prev(next_itr);
+            if ((previous_itr->first + previous_itr->second) > offset) return fail("reservation overlaps the preceding range");
+        }
+        reservedRanges[offset] = size;
+
+        // the statistics are maintained incrementally so check them against the tracked ranges periodically
+        if ((++numReserves % 10000) == 0)
+        {
+            VkDeviceSize reservedSize = 0;
+            for (auto& range : reservedRanges) reservedSize += range.second;
+            if (reservedSize != memorySlots.totalReservedSize()) return fail("totalReservedSize() doesn't match the reserved ranges");
+            if ((memorySlots.totalReservedSize() + memorySlots.totalAvailableSize()) != total) return fail("reserved and available sizes don't sum to the total size");
+            if (!memorySlots.check()) return fail("MemorySlots::check() failed");
+        }
+        return true;
+    };
+
+    // wrap MemorySlots so that releases are removed from the tracked ranges
+    struct TrackedMemorySlots
+    {
+        MemorySlots& memorySlots;
+        std::map<VkDeviceSize, VkDeviceSize>& reservedRanges;
+
+        MemorySlots::OptionalOffset reserve(VkDeviceSize size, VkDeviceSize alignment) { return memorySlots.reserve(size, alignment); }
+        void release(VkDeviceSize offset, VkDeviceSize size)
+        {
+            reservedRanges.erase(offset);
+            memorySlots.release(offset, size);
+        }
+        VkDeviceSize maximumAvailableSpace() const { return memorySlots.maximumAvailableSpace(); }
+        VkDeviceSize totalAvailableSize() const { return memorySlots.totalAvailableSize(); }
+    } tracked{memorySlots, reservedRanges};
+
+    run(tracked, totalSize, numOperations, 42, validate);
+
+    // reservedRanges() reports the same ranges in offset order, zero sized reservations occupy one byte
+    MemorySlots::Ranges expectedRanges;
+    for (auto& [offset, size] : reservedRanges) expectedRanges.emplace_back(offset, std::max(size, VkDeviceSize(1)));
+    if (memorySlots.reservedRanges() != expectedRanges) fail("reservedRanges() doesn't match the reserved ranges");
+
+    // releasing everything must coalesce the memory back into a single available block
+    for (auto itr = reservedRanges.begin(); itr != reservedRanges.end(); itr = reservedRanges.erase(itr))
+    {
+        memorySlots.release(itr->first, itr->second);
+    }
+    if (!memorySlots.check()) fail("MemorySlots::check() failed after releasing all reservations");
+    if (memorySlots.totalReservedSize() != 0 || memorySlots.maximumAvailableSpace() != totalSize) fail("releasing all reservations didn't coalesce the available memory");
+
+    // fragmentation benchmark, same sequence of operations on MemorySlots and the reference best fit allocator
+    auto noValidation = [](VkDeviceSize, VkDeviceSize, VkDeviceSize, VkDeviceSize) { return true; };
+
+    MemorySlots benchmarkMemorySlots(totalSize);
+    std::cout << "MemorySlots          : " << run(benchmarkMemorySlots, totalSize, numOperations, 42, noValidation) << std::endl;
+
+    ReferenceMemorySlots reference(totalSize);
+    std::cout << "ReferenceMemorySlots : " << run(reference, totalSize, numOperations, 42, noValidation) << std::endl;
+
+    // edge cases
+    MemorySlots empty(0);
+    if (!empty.full() || empty.reserve(1, 1).first) fail("empty MemorySlots reserved memory");
+
+    MemorySlots exact(100);
+    auto [reservedAll, offset] = exact.reserve(100, 1);
+    if (!reservedAll || !exact.full()) fail("reserving all the memory failed");
+    exact.release(offset, 100);
+    if (exact.maximumAvailableSpace() != 100) fail("releasing all the memory failed");
+
+    if (failures == 0) std::cout << "MemorySlots tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
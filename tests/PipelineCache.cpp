@@ -0,0 +1,155 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/state/ComputePipeline.h>
+#include <vsg/vk/Context.h>
+#include <vsg/vk/PipelineCache.h>
+
+#include "TestDevice.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+using namespace vsg;
+
+// checks that a PipelineCache saved to file is reloaded by a compatible device, that truncated, corrupted or foreign files are rejected,
+// and reports the time to compile a set of compute pipelines with an empty cache and with the reloaded cache. Requires a Vulkan device, software ICDs are sufficient.
+
+// minimal compute shader, void main() {} with the specified local size so that each variant is a distinct pipeline
+ShaderModule::SPIRV createComputeShader(uint32_t localSizeX)
+{
+    return ShaderModule::SPIRV{
+        0x07230203, 0x00010000, 0, 5, 0,          // magic, version 1.0, generator, bound, schema
+        0x00020011, 1,                            // OpCapability Shader
+        0x0003000e, 0, 1,                         // OpMemoryModel Logical GLSL450
+        0x0005000f, 5, 3, 0x6e69616d, 0,          // OpEntryPoint GLCompute %3 "main"
+        0x00060010, 3, 17, localSizeX, 1, 1,      // OpExecutionMode %3 LocalSize localSizeX 1 1
+        0x00020013, 1,                            // %1 = OpTypeVoid
+        0x00030021, 2, 1,                         // %2 = OpTypeFunction %1
+        0x00050036, 1, 3, 0, 2,                   // %3 = OpFunction %1 None %2
+        0x000200f8, 4,                            // %4 = OpLabel
+        0x000100fd,                               // OpReturn
+        0x00010038                                // OpFunctionEnd
+    };
+}
+
+double compilePipelines(Device* device, PipelineCache* pipelineCache, uint32_t numPipelines)
+{
+    Context context(device);
+    context.pipelineCache = pipelineCache;
+
+    auto pipelineLayout = PipelineLayout::create(DescriptorSetLayouts{}, PushConstantRanges{});
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 1; i <= numPipelines; ++i)
+    {
+        auto shaderStage = ShaderStage::create(VK_SHADER_STAGE_COMPUTE_BIT, "main", createComputeShader(i));
+        auto pipeline = ComputePipeline::create(pipelineLayout, shaderStage);
+        pipeline->compile(context);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool writeFile(const Path& filename, const std::vector<char>& data)
+{
+    std::ofstream fout(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    fout.write(data.data(), data.size());
+    return fout.good();
+}
+
+std::vector<char> readFile(const Path& filename)
+{
+    std::ifstream fin(filename, std::ios::in | std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+}
+
+int main()
+{
+    auto device = createTestDevice();
+    if (!device)
+    {
+        std::cout << "PipelineCache tests skipped, no Vulkan device available" << std::endl;
+        return TEST_SKIPPED;
+    }
+
+    int failures = 0;
+    auto fail = [&failures](const std::string& message) {
+        std::cout << "Error: " << message << std::endl;
+        ++failures;
+    };
+
+    auto physicalDevice = device->getPhysicalDevice();
+    auto filename = PipelineCache::deviceFilename("test_pipelines.bin", physicalDevice);
+    std::cout << "PipelineCache file " << filename << std::endl;
+
+    char vendorAndDevice[16];
+    std::snprintf(vendorAndDevice, sizeof(vendorAndDevice), "_%04x_%04x_", physicalDevice->getProperties().vendorID, physicalDevice->getProperties().deviceID);
+    if (filename.find(vendorAndDevice) == std::string::npos || fileExtension(filename) != "bin") fail("deviceFilename() doesn't contain the vendor and device IDs");
+
+    // cold compile with an empty cache, getData() is also called concurrently to check the cache can be shared between threads
+    const uint32_t numPipelines = 64;
+    auto coldCache = PipelineCache::create(device);
+    if (coldCache->initializedFromData()) fail("empty PipelineCache reports being initialized from data");
+
+    std::thread reader([&coldCache]() {
+        for (int i = 0; i < 100; ++i) coldCache->getData();
+    });
+    double coldTime = compilePipelines(device, coldCache, numPipelines);
+    reader.join();
+
+    auto coldData = coldCache->getData();
+    if (!PipelineCache::compatible(physicalDevice, coldData)) fail("PipelineCache data isn't compatible with the device that created it");
+    if (!coldCache->save(filename)) fail("PipelineCache::save() failed");
+
+    // warm compile with the cache loaded from file
+    auto warmCache = PipelineCache::load(device, filename);
+    if (!warmCache->initializedFromData()) fail("PipelineCache::load() didn't initialize the cache from the saved file");
+    if (warmCache->filename != filename) fail("PipelineCache::load() didn't record the filename");
+    double warmTime = compilePipelines(device, warmCache, numPipelines);
+
+    std::cout << "compile " << numPipelines << " pipelines, cold cache " << coldTime << "s, warm cache " << warmTime << "s, cache size " << coldData.size() << " bytes" << std::endl;
+
+    // files that must be rejected, falling back to an empty cache
+    auto fileData = readFile(filename);
+    if (fileData.size() <= 16 || coldData.size() <= 16)
+    {
+        fail("no PipelineCache data to test rejection of invalid files");
+        return 1;
+    }
+
+    auto truncated = fileData;
+    truncated.pop_back();
+    writeFile(filename, truncated);
+    if (PipelineCache::load(device, filename)->initializedFromData()) fail("truncated PipelineCache file was accepted");
+
+    auto corrupted = fileData;
+    corrupted.back() ^= 0xff;
+    writeFile(filename, corrupted);
+    if (PipelineCache::load(device, filename)->initializedFromData()) fail("corrupted PipelineCache file was accepted");
+
+    auto foreignDevice = fileData;
+    foreignDevice[12] ^= 0xff; // vendorID in the file header
+    writeFile(filename, foreignDevice);
+    if (PipelineCache::load(device, filename)->initializedFromData()) fail("PipelineCache file from another device was accepted");
+
+    std::remove(filename.c_str());
+    if (PipelineCache::load(device, filename)->initializedFromData()) fail("PipelineCache reports being initialized from a missing file");
+
+    auto foreignData = coldData;
+    foreignData[8] ^= 0xff; // vendorID in the VkPipelineCacheHeaderVersionOne
+    if (PipelineCache::compatible(physicalDevice, foreignData)) fail("PipelineCache data from another device reported as compatible");
+
+    if (failures == 0) std::cout << "PipelineCache tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
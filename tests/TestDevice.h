@@ -0,0 +1,56 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Exception.h>
+#include <vsg/vk/Device.h>
+#include <vsg/vk/Extensions.h>
+
+#include <iostream>
+
+namespace vsg
+{
+    /// return code of tests that were skipped, see SKIP_RETURN_CODE in tests/CMakeLists.txt
+    constexpr int TEST_SKIPPED = 77;
+
+    /// create a headless Device with a graphics queue, with those of the requested deviceExtensions that are supported enabled.
+    /// Return null if there is no Vulkan physical device, such as on build machines without a GPU or software ICD.
+    inline ref_ptr<Device> createTestDevice(const Names& deviceExtensions = {})
+    {
+        try
+        {
+            Names instanceExtensions;
+            if (isExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
+            auto instance = Instance::create(instanceExtensions, Names{});
+
+            auto [physicalDevice, queueFamily] = instance->getPhysicalDeviceAndQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+            if (!physicalDevice || queueFamily < 0) return {};
+
+            Names supportedExtensions;
+            for (auto extensionName : deviceExtensions)
+            {
+                if (physicalDevice->supportsDeviceExtension(extensionName)) supportedExtensions.push_back(extensionName);
+            }
+
+            QueueSettings queueSettings{QueueSetting{queueFamily, {1.0}}};
+            return Device::create(physicalDevice, queueSettings, Names{}, supportedExtensions);
+        }
+        catch (const Exception& exception)
+        {
+            std::cout << exception.message << std::endl;
+            return {};
+        }
+    }
+
+} // namespace vsg
@@ -0,0 +1,257 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2020 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/commands/Draw.h>
+#include <vsg/maths/transform.h>
+#include <vsg/nodes/CullNode.h>
+#include <vsg/nodes/LOD.h>
+#include <vsg/nodes/MatrixTransform.h>
+#include <vsg/nodes/QuadGroup.h>
+#include <vsg/traversals/TraversalStack.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace vsg;
+
+// checks that a visitor driven by a TraversalStack visits the same nodes, in the same order and at the same depth, as the recursive traversal,
+// that a scene graph far deeper than the call stack allows can be traversed iteratively, and reports the relative cost on deep and wide scene graphs
+
+// records each node visited along with its depth, the depth is restored on the way back up via TraversalStack::Record::restoreMarker when driven iteratively
+class VisitRecorder : public Inherit<ConstVisitor, VisitRecorder>
+{
+public:
+    TraversalStack* traversalStack = nullptr;
+
+    std::vector<std::pair<const Node*, uint32_t>> visits;
+    uint32_t depth = 0;
+    uint32_t maximumDepth = 0;
+
+    static constexpr uint32_t RESTORE_DEPTH = 1;
+
+    void apply(const Node& node) override
+    {
+        visit(node);
+        node.traverse(*this);
+    }
+
+    void apply(const Group& group) override
+    {
+        visit(group);
+        traverse(group, group.getChildren().data(), group.getNumChildren());
+    }
+
+    void apply(const QuadGroup& group) override
+    {
+        visit(group);
+        traverse(group, group.getChildren(), 4);
+    }
+
+    void apply(const LOD& lod) override
+    {
+        visit(lod);
+        traverse(lod, &(lod.getChildren()[0].node), lod.getChildren().size(), sizeof(LOD::Child));
+    }
+
+    void apply(const CullNode& cullNode) override
+    {
+        visit(cullNode);
+        traverse(cullNode, &cullNode.getChildRef(), 1);
+    }
+
+    void restore(const Node&, uint32_t restoreMarker)
+    {
+        if (restoreMarker == RESTORE_DEPTH) --depth;
+    }
+
+protected:
+    void visit(const Node& node)
+    {
+        visits.emplace_back(&node, depth);
+        if (depth > maximumDepth) maximumDepth = depth;
+    }
+
+    void traverse(const Node& node, const ref_ptr<Node>* children, size_t numChildren, size_t stride = sizeof(ref_ptr<Node>))
+    {
+        ++depth;
+        if (traversalStack)
+        {
+            traversalStack->push(node, children, numChildren, stride, RESTORE_DEPTH);
+            return;
+        }
+
+        node.traverse(*this);
+        restore(node, RESTORE_DEPTH);
+    }
+};
+
+ref_ptr<Node> createLeaf()
+{
+    return Draw::create(3, 1, 0, 0);
+}
+
+// chain of mixed node types, levels deep, with a leaf hanging off most levels
+ref_ptr<Node> createDeepScene(size_t levels)
+{
+    auto node = createLeaf();
+    for (size_t i = 0; i < levels; ++i)
+    {
+        // exclude some of the leaves from traversals with a traversalMask of 0x1 to check that node masks are respected
+        auto leaf = [i]() {
+            auto draw = createLeaf();
+            if ((i % 3) == 0) draw->mask = 0x2;
+            return draw;
+        };
+
+        switch (i % 5)
+        {
+        case 0: {
+            auto transform = MatrixTransform::create(translate(1.0, 0.0, 0.0));
+            transform->addChild(node);
+            transform->addChild(leaf());
+            node = transform;
+            break;
+        }
+        case 1: {
+            auto group = Group::create();
+            group->addChild(leaf());
+            group->addChild(node);
+            node = group;
+            break;
+        }
+        case 2: {
+            node = CullNode::create(dsphere(0.0, 0.0, 0.0, 1000.0), node);
+            break;
+        }
+        case 3: {
+            auto lod = LOD::create();
+            lod->addChild(LOD::Child{0.5, node});
+            lod->addChild(LOD::Child{0.0, leaf()});
+            node = lod;
+            break;
+        }
+        case 4: {
+            auto quadGroup = QuadGroup::create();
+            quadGroup->setChild(0, leaf());
+            quadGroup->setChild(1, node);
+            quadGroup->setChild(2, leaf());
+            quadGroup->setChild(3, leaf());
+            node = quadGroup;
+            break;
+        }
+        }
+    }
+    return node;
+}
+
+ref_ptr<Node> createWideScene(size_t levels, size_t numChildren)
+{
+    if (levels == 0) return createLeaf();
+
+    auto group = (levels % 2) ? ref_ptr<Group>(MatrixTransform::create(translate(1.0, 0.0, 0.0))) : Group::create();
+    for (size_t i = 0; i < numChildren; ++i) group->addChild(createWideScene(levels - 1, numChildren));
+    return group;
+}
+
+// chain of Groups used for the scene graph too deep to traverse recursively
+ref_ptr<Group> createVeryDeepScene(size_t levels)
+{
+    auto root = Group::create();
+    auto group = root;
+    for (size_t i = 0; i < levels; ++i)
+    {
+        auto child = (i % 2) ? ref_ptr<Group>(MatrixTransform::create()) : Group::create();
+        group->addChild(child);
+        group = child;
+    }
+    group->addChild(createLeaf());
+    return root;
+}
+
+// detach the chain of Groups one level at a time so its destruction doesn't recurse
+void releaseVeryDeepScene(ref_ptr<Group> group)
+{
+    while (group && !group->getChildren().empty())
+    {
+        auto child = group->getChildren().front().cast<Group>();
+        group->getChildren().clear();
+        group = child;
+    }
+}
+
+ref_ptr<VisitRecorder> visit(const Node& root, Mask traversalMask, bool iterative, double& time)
+{
+    auto recorder = VisitRecorder::create();
+    recorder->traversalMask = traversalMask;
+
+    auto start = std::chrono::steady_clock::now();
+    if (iterative)
+    {
+        auto traversalStack = TraversalStack::create();
+        traversalStack->traverse(root, *recorder);
+        if (traversalStack->size() != 0) std::cout << "Error: TraversalStack not empty after traversal" << std::endl;
+        if (recorder->traversalStack) std::cout << "Error: visitor traversalStack not reset after traversal" << std::endl;
+    }
+    else
+    {
+        root.accept(*recorder);
+    }
+    time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return recorder;
+}
+
+int main()
+{
+    int failures = 0;
+
+    struct Scene
+    {
+        const char* name;
+        ref_ptr<Node> root;
+        Mask traversalMask;
+    };
+
+    for (auto& scene : {Scene{"deep", createDeepScene(2000), MASK_ALL}, Scene{"deep masked", createDeepScene(2000), 0x1}, Scene{"wide", createWideScene(7, 6), MASK_ALL}})
+    {
+        double recursiveTime = 0.0, iterativeTime = 0.0;
+        auto recursive = visit(*scene.root, scene.traversalMask, false, recursiveTime);
+        auto iterative = visit(*scene.root, scene.traversalMask, true, iterativeTime);
+
+        std::cout << scene.name << " : nodes visited " << recursive->visits.size() << ", maximum depth " << recursive->maximumDepth << ", recursive time " << recursiveTime << "s, iterative time " << iterativeTime << "s" << std::endl;
+
+        if (recursive->visits != iterative->visits || iterative->depth != 0)
+        {
+            std::cout << "Error: " << scene.name << " iterative traversal visited " << iterative->visits.size() << " nodes, which differ from the recursive traversal" << std::endl;
+            ++failures;
+        }
+    }
+
+    // far deeper than a thread's call stack supports recursively
+    const size_t veryDeepLevels = 1000000;
+    auto veryDeepScene = createVeryDeepScene(veryDeepLevels);
+
+    double time = 0.0;
+    auto veryDeep = visit(*veryDeepScene, MASK_ALL, true, time);
+    std::cout << "very deep : nodes visited " << veryDeep->visits.size() << ", maximum depth " << veryDeep->maximumDepth << ", iterative time " << time << "s" << std::endl;
+
+    if (veryDeep->visits.size() != veryDeepLevels + 2 || veryDeep->maximumDepth != veryDeepLevels + 1 || veryDeep->depth != 0)
+    {
+        std::cout << "Error: very deep iterative traversal visited " << veryDeep->visits.size() << " nodes" << std::endl;
+        ++failures;
+    }
+
+    releaseVeryDeepScene(veryDeepScene);
+
+    if (failures == 0) std::cout << "TraversalStack tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}